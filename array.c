@@ -0,0 +1,317 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#include "array.h"
+#include "phash.h"
+
+#define ASSOC_MIN_CAPACITY 16 // lugares del índice al empezar (siempre una potencia de 2)
+
+struct array_item
+{
+    char *value; // NULL: el índice no tiene valor
+    bool owned;  // false: vive en uno de los bloques del arreglo
+};
+
+struct indexed_array_s
+{
+    struct array_item *items;
+    size_t end;       // uno más que el mayor índice usado
+    size_t allocated; // lugares reservados en items
+    size_t count;     // índices con valor
+    GPtrArray *blocks; // bloques de valores adoptados (de indexed_adopt)
+};
+
+struct assoc_entry
+{
+    char *key; // NULL: la entrada se borró
+    char *value;
+    uint32_t hash;
+};
+
+struct assoc_array_s
+{
+    struct assoc_entry *entries; // en orden de inserción
+    size_t used;                 // entradas usadas (con las borradas)
+    size_t allocated;
+    size_t count;    // entradas vivas
+    uint32_t *index; // posición + 1 de cada entrada; 0 es un lugar libre
+    size_t capacity; // lugares del índice, potencia de 2
+};
+
+indexed_array indexed_new(void)
+{
+    indexed_array array = calloc(1, sizeof(struct indexed_array_s));
+    assert(array != NULL);
+    array->blocks = g_ptr_array_new_with_free_func(free);
+    return array;
+}
+
+static void item_clear(struct array_item *item)
+{
+    if (item->owned)
+    {
+        free(item->value);
+    }
+    item->value = NULL;
+    item->owned = false;
+}
+
+void indexed_destroy(indexed_array array)
+{
+    assert(array != NULL);
+    for (size_t i = 0; i < array->end; i++)
+    {
+        item_clear(&array->items[i]);
+    }
+    free(array->items);
+    g_ptr_array_free(array->blocks, TRUE);
+    free(array);
+}
+
+size_t indexed_count(indexed_array array)
+{
+    assert(array != NULL);
+    return array->count;
+}
+
+size_t indexed_end(indexed_array array)
+{
+    assert(array != NULL);
+    return array->end;
+}
+
+const char *indexed_get(indexed_array array, size_t index)
+{
+    assert(array != NULL);
+    return (index < array->end) ? array->items[index].value : NULL;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de asegurar lugar para `end' índices
+  -- los lugares nuevos quedan sin valor; la reserva se duplica para que agregar al final
+                              cueste tiempo constante amortizado --
+------------------------------------------------------------------------------------------------
+*/
+static void indexed_reserve(indexed_array array, size_t end)
+{
+    if (end > array->allocated)
+    {
+        size_t allocated = (array->allocated > 0) ? array->allocated : 16;
+        while (allocated < end)
+        {
+            assert(allocated <= SIZE_MAX / 2 / sizeof(struct array_item)); // allocated * 2 * sizeof no desborda
+            allocated *= 2;
+        }
+        array->items = realloc(array->items, allocated * sizeof(struct array_item));
+        assert(array->items != NULL);
+        memset(array->items + array->allocated, 0, (allocated - array->allocated) * sizeof(struct array_item));
+        array->allocated = allocated;
+    }
+    if (end > array->end)
+    {
+        array->end = end;
+    }
+}
+
+void indexed_set(indexed_array array, size_t index, const char *value)
+{
+    assert(array != NULL && value != NULL && (index < INDEXED_MAX_INDEX || index < array->end));
+    indexed_reserve(array, index + 1);
+    struct array_item *item = &array->items[index];
+    array->count += (item->value == NULL);
+    item_clear(item);
+    item->value = strdup(value);
+    item->owned = true;
+}
+
+void indexed_unset(indexed_array array, size_t index)
+{
+    assert(array != NULL);
+    if (index < array->end && array->items[index].value != NULL)
+    {
+        item_clear(&array->items[index]);
+        array->count--;
+        while (array->end > 0 && array->items[array->end - 1].value == NULL)
+        {
+            array->end--;
+        }
+    }
+}
+
+void indexed_adopt(indexed_array array, char *block, char *const *values, size_t count)
+{
+    assert(array != NULL && block != NULL && values != NULL);
+    g_ptr_array_add(array->blocks, block);
+    size_t start = array->end;
+    indexed_reserve(array, start + count);
+    for (size_t i = 0; i < count; i++)
+    {
+        array->items[start + i].value = values[i];
+    }
+    array->count += count;
+}
+
+assoc_array assoc_new(void)
+{
+    assoc_array array = calloc(1, sizeof(struct assoc_array_s));
+    assert(array != NULL);
+    array->capacity = ASSOC_MIN_CAPACITY;
+    array->index = calloc(array->capacity, sizeof(uint32_t));
+    assert(array->index != NULL);
+    return array;
+}
+
+void assoc_destroy(assoc_array array)
+{
+    assert(array != NULL);
+    for (size_t i = 0; i < array->used; i++)
+    {
+        free(array->entries[i].key);
+        free(array->entries[i].value);
+    }
+    free(array->entries);
+    free(array->index);
+    free(array);
+}
+
+size_t assoc_count(assoc_array array)
+{
+    assert(array != NULL);
+    return array->count;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de buscar el lugar del índice que le corresponde a `key'
+  -- devuelve el lugar que apunta a la entrada de `key', o el lugar libre donde iría; las
+                 entradas borradas se saltean sin cortar la búsqueda --
+------------------------------------------------------------------------------------------------
+*/
+static uint32_t *assoc_find(assoc_array array, const char *key, uint32_t hash)
+{
+    size_t mask = array->capacity - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask)
+    {
+        uint32_t position = array->index[i];
+        if (position == 0)
+        {
+            return &array->index[i];
+        }
+        struct assoc_entry *entry = &array->entries[position - 1];
+        if (entry->key != NULL && entry->hash == hash && strcmp(entry->key, key) == 0)
+        {
+            return &array->index[i];
+        }
+    }
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de compactar las entradas y rearmar el índice
+  -- las entradas borradas se descartan sin cambiar el orden de las demás --
+------------------------------------------------------------------------------------------------
+*/
+static void assoc_rebuild(assoc_array array)
+{
+    size_t live = 0;
+    for (size_t i = 0; i < array->used; i++)
+    {
+        if (array->entries[i].key != NULL)
+        {
+            array->entries[live++] = array->entries[i];
+        }
+    }
+    array->used = live;
+    while (4 * (live + 1) > 2 * array->capacity)
+    {
+        array->capacity *= 2;
+    }
+    free(array->index);
+    array->index = calloc(array->capacity, sizeof(uint32_t));
+    assert(array->index != NULL);
+    size_t mask = array->capacity - 1;
+    for (size_t i = 0; i < live; i++)
+    {
+        size_t j = array->entries[i].hash & mask;
+        while (array->index[j] != 0)
+        {
+            j = (j + 1) & mask;
+        }
+        array->index[j] = i + 1;
+    }
+}
+
+const char *assoc_get(assoc_array array, const char *key)
+{
+    assert(array != NULL && key != NULL);
+    uint32_t position = *assoc_find(array, key, phash(key, 0));
+    return (position != 0) ? array->entries[position - 1].value : NULL;
+}
+
+void assoc_set(assoc_array array, const char *key, const char *value)
+{
+    assert(array != NULL && key != NULL && value != NULL);
+    uint32_t hash = phash(key, 0);
+    uint32_t *place = assoc_find(array, key, hash);
+    if (*place != 0)
+    {
+        struct assoc_entry *entry = &array->entries[*place - 1];
+        free(entry->value);
+        entry->value = strdup(value);
+        return;
+    }
+    // el índice se mantiene con al menos un cuarto libre (las entradas borradas lo ocupan)
+    if (4 * (array->used + 1) > 3 * array->capacity)
+    {
+        assoc_rebuild(array);
+        place = assoc_find(array, key, hash);
+    }
+    if (array->used == array->allocated)
+    {
+        array->allocated = (array->allocated > 0) ? 2 * array->allocated : 16;
+        array->entries = realloc(array->entries, array->allocated * sizeof(struct assoc_entry));
+        assert(array->entries != NULL);
+    }
+    struct assoc_entry *entry = &array->entries[array->used++];
+    entry->key = strdup(key);
+    entry->value = strdup(value);
+    entry->hash = hash;
+    *place = array->used;
+    array->count++;
+}
+
+void assoc_unset(assoc_array array, const char *key)
+{
+    assert(array != NULL && key != NULL);
+    uint32_t position = *assoc_find(array, key, phash(key, 0));
+    if (position != 0)
+    {
+        // la entrada queda marcada: el índice la sigue apuntando hasta el próximo rearmado
+        struct assoc_entry *entry = &array->entries[position - 1];
+        free(entry->key);
+        free(entry->value);
+        entry->key = entry->value = NULL;
+        array->count--;
+    }
+}
+
+bool assoc_next(assoc_array array, size_t *position, const char **key, const char **value)
+{
+    assert(array != NULL && position != NULL && key != NULL && value != NULL);
+    while (*position < array->used && array->entries[*position].key == NULL)
+    {
+        (*position)++;
+    }
+    if (*position >= array->used)
+    {
+        return false;
+    }
+    *key = array->entries[*position].key;
+    *value = array->entries[*position].value;
+    (*position)++;
+    return true;
+}
@@ -0,0 +1,120 @@
+/* Arreglos de las variables del shell.
+ * Un arreglo indexado es un vector contiguo de valores. Los índices sin
+ * valor quedan en NULL. Los valores pueden vivir en bloques compartidos,
+ * como los que arma mapfile: una sola reserva por bloque de líneas.
+ * Un arreglo asociativo es una tabla hash de direccionamiento abierto sobre
+ * un vector de entradas. Se recorre en el orden en que se agregaron las
+ * claves.
+ */
+
+#ifndef ARRAY_H
+#define ARRAY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define INDEXED_MAX_INDEX (1u << 24) // Un índice nuevo tiene que ser menor (el vector es denso)
+
+typedef struct indexed_array_s *indexed_array;
+typedef struct assoc_array_s *assoc_array;
+
+indexed_array indexed_new(void);
+/*
+ * Crea un arreglo indexado vacío.
+ */
+
+void indexed_destroy(indexed_array array);
+/*
+ * Libera el arreglo, sus valores y sus bloques.
+ * Requires: array != NULL
+ */
+
+size_t indexed_count(indexed_array array);
+/*
+ * Cantidad de índices que tienen valor.
+ * Requires: array != NULL
+ */
+
+size_t indexed_end(indexed_array array);
+/*
+ * Uno más que el mayor índice con valor (0 si está vacío).
+ * Requires: array != NULL
+ */
+
+const char *indexed_get(indexed_array array, size_t index);
+/*
+ * Valor del índice `index', o NULL si no tiene.
+ *   Returns: cadena del arreglo (vale hasta que cambie ese índice).
+ * Requires: array != NULL
+ */
+
+void indexed_set(indexed_array array, size_t index, const char *value);
+/*
+ * Le da el valor `value' (se copia) al índice `index'. Reserva lugar para
+ * todos los índices hasta `index'.
+ * Requires: array != NULL && value != NULL &&
+ *           (index < INDEXED_MAX_INDEX || index < indexed_end(array))
+ */
+
+void indexed_unset(indexed_array array, size_t index);
+/*
+ * Borra el valor del índice `index' (los demás no se mueven).
+ * Requires: array != NULL
+ */
+
+void indexed_adopt(indexed_array array, char *block, char *const *values, size_t count);
+/*
+ * Agrega al final los `count' valores de `values', que apuntan dentro de
+ * `block'. El arreglo se queda con `block' (memoria de malloc) y no copia
+ * los valores.
+ * Requires: array != NULL && block != NULL && values != NULL
+ */
+
+assoc_array assoc_new(void);
+/*
+ * Crea un arreglo asociativo vacío.
+ */
+
+void assoc_destroy(assoc_array array);
+/*
+ * Libera el arreglo con sus claves y valores.
+ * Requires: array != NULL
+ */
+
+size_t assoc_count(assoc_array array);
+/*
+ * Cantidad de claves.
+ * Requires: array != NULL
+ */
+
+const char *assoc_get(assoc_array array, const char *key);
+/*
+ * Valor de `key', o NULL si no está.
+ * Requires: array != NULL && key != NULL
+ */
+
+void assoc_set(assoc_array array, const char *key, const char *value);
+/*
+ * Le da el valor `value' a `key' (se copian los dos). Una clave nueva va al
+ * final del orden de recorrido.
+ * Requires: array != NULL && key != NULL && value != NULL
+ */
+
+void assoc_unset(assoc_array array, const char *key);
+/*
+ * Borra `key' si estaba.
+ * Requires: array != NULL && key != NULL
+ */
+
+bool assoc_next(assoc_array array, size_t *position, const char **key, const char **value);
+/*
+ * Recorre las claves en el orden en que se agregaron:
+ *
+ * size_t position = 0; const char *key, *value;
+ * while (assoc_next(array, &position, &key, &value)) { ... }
+ *
+ *   Returns: false cuando no quedan claves.
+ * Requires: array != NULL && position != NULL && key != NULL && value != NULL
+ */
+
+#endif /* ARRAY_H */
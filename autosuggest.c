@@ -0,0 +1,197 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#include "autosuggest.h"
+#include "history.h"
+
+/* Nodo del trie radix. La etiqueta de la arista que llega al nodo no se copia:
+ * apunta a la entrada del historial que la creó, que nunca se mueve ni cambia.
+ */
+struct trie_node
+{
+    const char *edge;              // etiqueta de la arista entrante
+    size_t edge_len;               // largo de la etiqueta
+    unsigned int best;             // entrada más reciente que pasa por este nodo
+    struct trie_node *first_child; // hijos, en una lista simplemente enlazada
+    struct trie_node *next;        // siguiente hermano
+};
+
+/* Posición dentro del trie después de consumir un prefijo: el nodo y cuántos
+ * caracteres de su arista se consumieron. node == NULL indica que ninguna
+ * entrada empieza con ese prefijo.
+ */
+struct trie_state
+{
+    struct trie_node *node;
+    size_t offset;
+};
+
+static struct trie_node *root = NULL;
+static unsigned int synced = 0;   // cantidad de entradas del historial ya insertadas
+static GArray *states = NULL;     // states[k]: posición luego de consumir k caracteres
+
+static struct trie_node *node_new(const char *edge, size_t edge_len, unsigned int best)
+{
+    struct trie_node *node = malloc(sizeof(struct trie_node));
+    assert(node != NULL);
+    node->edge = edge;
+    node->edge_len = edge_len;
+    node->best = best;
+    node->first_child = NULL;
+    node->next = NULL;
+    return node;
+}
+
+static void node_free(struct trie_node *node)
+{
+    while (node != NULL)
+    {
+        struct trie_node *next = node->next;
+        node_free(node->first_child);
+        free(node);
+        node = next;
+    }
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de buscar el hijo de `node' cuya arista empieza con `c'
+  -- devuelve el enlace que apunta a él, para poder reemplazarlo al partir una arista --
+------------------------------------------------------------------------------------------------
+*/
+static struct trie_node **child_link(struct trie_node *node, char c)
+{
+    struct trie_node **link = &node->first_child;
+    while (*link != NULL && (*link)->edge[0] != c)
+    {
+        link = &(*link)->next;
+    }
+    return link;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de insertar la entrada `id' del historial en el trie
+       -- como `id' es siempre la más reciente, se la marca en todo el camino --
+------------------------------------------------------------------------------------------------
+*/
+static void trie_insert(const char *entry, unsigned int id)
+{
+    struct trie_node *node = root;
+    node->best = id;
+    while (*entry != '\0')
+    {
+        struct trie_node **link = child_link(node, *entry);
+        struct trie_node *child = *link;
+        if (child == NULL)
+        {
+            child = node_new(entry, strlen(entry), id);
+            child->next = node->first_child;
+            node->first_child = child;
+            return;
+        }
+        size_t common = 1;
+        while (common < child->edge_len && entry[common] == child->edge[common])
+        {
+            common++;
+        }
+        if (common < child->edge_len)
+        {
+            // la entrada se separa a mitad de la arista: la partimos en dos
+            struct trie_node *middle = node_new(child->edge, common, child->best);
+            middle->next = child->next;
+            middle->first_child = child;
+            child->next = NULL;
+            child->edge += common;
+            child->edge_len -= common;
+            *link = middle;
+            child = middle;
+        }
+        child->best = id;
+        node = child;
+        entry += common;
+    }
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de avanzar un carácter desde una posición del trie
+------------------------------------------------------------------------------------------------
+*/
+static struct trie_state trie_step(struct trie_state state, char c)
+{
+    struct trie_state next = {NULL, 0};
+    if (state.node == NULL)
+    {
+        return next;
+    }
+    if (state.offset < state.node->edge_len)
+    {
+        if (state.node->edge[state.offset] == c)
+        {
+            next.node = state.node;
+            next.offset = state.offset + 1;
+        }
+    }
+    else
+    {
+        next.node = *child_link(state.node, c);
+        next.offset = 1;
+    }
+    return next;
+}
+
+void autosuggest_reset(void)
+{
+    if (root == NULL)
+    {
+        root = node_new("", 0, 0);
+        states = g_array_new(FALSE, FALSE, sizeof(struct trie_state));
+    }
+    for (; synced < history_length(); synced++)
+    {
+        trie_insert(history_get(synced), synced);
+    }
+    struct trie_state start = {root, 0};
+    g_array_set_size(states, 0);
+    g_array_append_val(states, start);
+}
+
+const char *autosuggest_update(const char *line, size_t len, size_t edit_pos)
+{
+    assert(line != NULL || len == 0);
+    if (root == NULL)
+    {
+        autosuggest_reset();
+    }
+    // los estados de los prefijos anteriores a la edición siguen siendo válidos
+    size_t valid = MIN(edit_pos, (size_t)states->len - 1);
+    g_array_set_size(states, valid + 1);
+    for (size_t k = valid; k < len; k++)
+    {
+        struct trie_state next = trie_step(g_array_index(states, struct trie_state, k), line[k]);
+        g_array_append_val(states, next);
+    }
+
+    struct trie_state current = g_array_index(states, struct trie_state, len);
+    if (len == 0 || current.node == NULL || root->best >= history_length())
+    {
+        return NULL;
+    }
+    const char *entry = history_get(current.node->best);
+    return (entry[len] != '\0') ? entry + len : NULL;
+}
+
+void autosuggest_destroy(void)
+{
+    if (root != NULL)
+    {
+        node_free(root);
+        g_array_free(states, TRUE);
+        root = NULL;
+        states = NULL;
+        synced = 0;
+    }
+}
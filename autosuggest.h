@@ -0,0 +1,40 @@
+/* Sugerencias en línea a partir del historial (al estilo fish).
+ * Se mantiene un trie radix sobre las entradas del historial donde cada nodo
+ * recuerda la entrada más reciente que pasa por él. Mientras se escribe, el
+ * estado avanza un carácter por vez desde el nodo anterior en vez de volver a
+ * buscar desde la raíz.
+ */
+
+#ifndef AUTOSUGGEST_H
+#define AUTOSUGGEST_H
+
+#include <stddef.h>
+
+void autosuggest_reset(void);
+/*
+ * Prepara el módulo para una nueva línea: vuelve el estado a la raíz e
+ * incorpora al trie las entradas del historial agregadas desde la última vez.
+ * El trie se construye recién en la primera llamada, así el arranque del shell
+ * no paga su costo.
+ */
+
+const char *autosuggest_update(const char *line, size_t len, size_t edit_pos);
+/*
+ * Actualiza el estado con el contenido actual de la línea y devuelve la
+ * sugerencia correspondiente.
+ *   line: contenido de la línea (no necesita terminar en '\0').
+ *   len: largo de la línea.
+ *   edit_pos: posición del primer carácter que cambió desde la llamada
+ *     anterior; los prefijos más cortos se reutilizan sin recorrerlos.
+ *   Returns: el resto de la entrada más reciente que empieza con la línea,
+ *     o NULL si no hay ninguna. La cadena es propiedad del historial.
+ * Requires: line != NULL || len == 0
+ */
+
+void autosuggest_destroy(void);
+/*
+ * Libera el trie. Debe llamarse antes de history_destroy(), ya que las
+ * etiquetas del trie apuntan a las cadenas del historial.
+ */
+
+#endif /* AUTOSUGGEST_H */
@@ -0,0 +1,280 @@
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <glib.h>
+
+#include "batch.h"
+#include "parsing.h"
+#include "vars.h"
+
+#define STATUS_FAILED 123   // alguna tanda terminó con un estado de 1 a 125
+#define STATUS_SIGNALED 125 // a alguna tanda la mató una señal
+#define STATUS_NOEXEC 126   // el comando no se pudo ejecutar
+#define STATUS_NOTFOUND 127 // el comando no existe
+
+extern char **environ;
+
+// Lo que ocupa una cadena en la pila del proceso nuevo: sus bytes, el '\0' y su puntero
+static size_t string_size(const char *string)
+{
+    return strlen(string) + 1 + sizeof(char *);
+}
+
+// Lo que ocupa un arreglo de cadenas terminado en NULL (el NULL también)
+static size_t strings_size(char *const *strings)
+{
+    size_t size = sizeof(char *);
+    for (; *strings != NULL; strings++)
+    {
+        size += string_size(*strings);
+    }
+    return size;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de calcular cuánto lugar hay para los argumentos de un comando
+  -- ARG_MAX menos lo que ocupa el entorno y un margen --
+------------------------------------------------------------------------------------------------
+*/
+static size_t argument_space(void)
+{
+    long arg_max = sysconf(_SC_ARG_MAX);
+    size_t limit = (arg_max > 0) ? (size_t)arg_max : 128 * 1024;
+    size_t used = strings_size(vars_environment()) + BATCH_MARGIN;
+    return (limit > used) ? limit - used : 0;
+}
+
+bool batch_fits(char *const *argv)
+{
+    assert(argv != NULL);
+    for (char *const *arg = argv; *arg != NULL; arg++)
+    {
+        if (strlen(*arg) >= BATCH_STRING_MAX)
+        {
+            return false;
+        }
+    }
+    return strings_size(argv) <= argument_space();
+}
+
+// Lee el número de -P o -k
+static bool parse_count(const char *text, long *value)
+{
+    char *rest = NULL;
+    errno = 0;
+    *value = strtol(text, &rest, 10);
+    return errno == 0 && rest != text && *rest == '\0' && *value >= 0 && *value <= INT_MAX;
+}
+
+// Traduce cómo terminó una tanda al estado de xargs
+static int batch_status(int wstatus)
+{
+    if (WIFSIGNALED(wstatus))
+    {
+        return STATUS_SIGNALED;
+    }
+    int code = WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : EXIT_FAILURE;
+    return (code == STATUS_NOEXEC || code == STATUS_NOTFOUND || code == 0) ? code : STATUS_FAILED;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de crear el proceso de una tanda
+------------------------------------------------------------------------------------------------
+*/
+static pid_t launch(char **argv, char **envp)
+{
+    fflush(stdout); // lo que el shell tenía en el buffer no se duplica en el hijo
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        environ = envp;
+        execvp(argv[0], argv);
+        // _exit: el hijo no tiene que vaciar los buffers de stdio que heredó del shell
+        if (errno == ENOENT)
+        {
+            fprintf(stderr, "%s : command not found\n", argv[0]);
+            _exit(STATUS_NOTFOUND);
+        }
+        fprintf(stderr, "%s: %s\n", argv[0], strerror(errno));
+        _exit(STATUS_NOEXEC);
+    }
+    if (pid < 0)
+    {
+        perror("batch: fork");
+    }
+    return pid;
+}
+
+// Espera la tanda más vieja que sigue corriendo y junta su estado con `status' (gana el más alto)
+static int wait_oldest(GArray *running, int status)
+{
+    int wstatus = 0;
+    pid_t pid = g_array_index(running, pid_t, 0);
+    g_array_remove_index(running, 0);
+    waitpid(pid, &wstatus, 0);
+    int result = batch_status(wstatus);
+    return MAX(status, result);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de leer las opciones de batch
+  -- deja en `command' la primera palabra que no es una opción; devuelve false (y avisa) si
+                             alguna no sirve o no hay comando --
+------------------------------------------------------------------------------------------------
+*/
+static bool parse_options(word_stream words, long *jobs, long *keep, char **command)
+{
+    *jobs = 1;
+    *keep = -1;
+    char *word = word_stream_next(words);
+    while (word != NULL && (strcmp(word, "-P") == 0 || strcmp(word, "-k") == 0))
+    {
+        bool parallel = (word[1] == 'P');
+        free(word);
+        word = word_stream_next(words);
+        if (word == NULL || !parse_count(word, parallel ? jobs : keep))
+        {
+            fprintf(stderr, "batch: %s: invalid number\n", parallel ? "-P" : "-k");
+            free(word);
+            return false;
+        }
+        free(word);
+        word = word_stream_next(words);
+    }
+    if (word == NULL)
+    {
+        fprintf(stderr, "batch: usage: batch [-P jobs] [-k keep] command [arg...]\n");
+        return false;
+    }
+    if (*jobs == 0)
+    {
+        long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        *jobs = (processors > 0) ? processors : 1;
+    }
+    *command = word;
+    return true;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de juntar en `fixed' las palabras que van en todas las tandas
+  -- el comando y sus opciones, o los `keep' primeros argumentos; devuelve la primera
+                             palabra que no es fija (o NULL) --
+------------------------------------------------------------------------------------------------
+*/
+static char *fixed_words(word_stream words, char *command, long keep, GPtrArray *fixed)
+{
+    g_ptr_array_add(fixed, command);
+    char *word = word_stream_next(words);
+    bool options = true; // sin -k: hasta la primera que no empieza con '-', o un "--" inclusive
+    while (word != NULL && ((keep >= 0) ? (long)fixed->len <= keep : options && word[0] == '-'))
+    {
+        options = (strcmp(word, "--") != 0);
+        g_ptr_array_add(fixed, word);
+        word = word_stream_next(words);
+    }
+    return word;
+}
+
+// Un argumento que no entra en una tanda ni solo con las palabras fijas
+static bool too_long(const char *word, size_t fixed_size, size_t space)
+{
+    return strlen(word) >= BATCH_STRING_MAX || fixed_size + string_size(word) > space;
+}
+
+int batch_run(scommand args)
+{
+    assert(args != NULL);
+    word_stream words = word_stream_new(args);
+    long jobs = 1, keep = -1;
+    char *command = NULL;
+    if (!parse_options(words, &jobs, &keep, &command))
+    {
+        word_stream_destroy(words);
+        return EXIT_FAILURE;
+    }
+    GPtrArray *fixed = g_ptr_array_new_with_free_func(free);
+    char *word = fixed_words(words, command, keep, fixed);
+    size_t space = argument_space(), fixed_size = sizeof(char *);
+    for (unsigned int i = 0; i < fixed->len; i++)
+    {
+        fixed_size += string_size(g_ptr_array_index(fixed, i));
+    }
+    for (unsigned int i = 0; i < fixed->len; i++)
+    {
+        const char *each = g_ptr_array_index(fixed, i);
+        if (strlen(each) >= BATCH_STRING_MAX || fixed_size > space)
+        {
+            fprintf(stderr, "batch: %.40s...: argument too long\n", each);
+            free(word);
+            word_stream_destroy(words);
+            g_ptr_array_free(fixed, TRUE);
+            return STATUS_NOEXEC;
+        }
+    }
+
+    // cada tanda se llena con lo que va dando el generador: en memoria hay a lo sumo una tanda
+    char **envp = vars_environment();
+    GPtrArray *batch = g_ptr_array_new();
+    GArray *running = g_array_new(FALSE, FALSE, sizeof(pid_t));
+    int status = EXIT_SUCCESS;
+    bool first = true; // sin argumentos el comando se ejecuta una vez, con los fijos
+    while (first || word != NULL)
+    {
+        first = false;
+        if (word != NULL && too_long(word, fixed_size, space))
+        {
+            // no tiene arreglo: las tandas que ya salieron siguen, pero no se arman más
+            fprintf(stderr, "batch: %.40s...: argument too long\n", word);
+            status = MAX(status, STATUS_NOEXEC);
+            break;
+        }
+        g_ptr_array_set_size(batch, 0);
+        for (unsigned int i = 0; i < fixed->len; i++)
+        {
+            g_ptr_array_add(batch, g_ptr_array_index(fixed, i));
+        }
+        for (size_t size = fixed_size; word != NULL && !too_long(word, fixed_size, space) &&
+                                       size + string_size(word) <= space;
+             word = word_stream_next(words))
+        {
+            size += string_size(word);
+            g_ptr_array_add(batch, word);
+        }
+        g_ptr_array_add(batch, NULL);
+        if ((long)running->len == jobs)
+        {
+            status = wait_oldest(running, status);
+        }
+        pid_t pid = launch((char **)batch->pdata, envp);
+        // el hijo ya tiene su copia: los argumentos propios de la tanda se liberan
+        for (unsigned int i = fixed->len; i + 1 < batch->len; i++)
+        {
+            free(g_ptr_array_index(batch, i));
+        }
+        if (pid < 0)
+        {
+            status = MAX(status, STATUS_NOEXEC);
+            break;
+        }
+        g_array_append_val(running, pid);
+    }
+    while (running->len > 0)
+    {
+        status = wait_oldest(running, status);
+    }
+    free(word);
+    g_array_free(running, TRUE);
+    g_ptr_array_free(batch, TRUE);
+    g_ptr_array_free(fixed, TRUE);
+    word_stream_destroy(words);
+    return status;
+}
@@ -0,0 +1,47 @@
+/* Límite de ARG_MAX y comando interno batch.
+ * execve() falla con E2BIG si los argumentos y el entorno de un comando no
+ * entran en ARG_MAX. El ejecutor lo revisa antes de crear procesos
+ * (batch_fits) y avisa en lugar de intentarlo. Con batch se pide, para un
+ * comando, que sus argumentos se repartan en tandas que entren, como hace
+ * xargs:
+ *   batch [-P jobs] [-k keep] command [arg...]
+ * Cada tanda repite el comando y sus primeros argumentos (los `keep'
+ * primeros con -k; si no, las opciones del principio: las palabras que
+ * empiezan con '-', hasta un "--" inclusive) y sigue con todos los demás
+ * argumentos que entren. Las tandas se ejecutan de a una, o de a `jobs' a
+ * la vez con -P (-P 0: una por procesador).
+ * Los argumentos de batch no se expanden antes de ejecutarlo: cada tanda se
+ * llena con lo que va dando un word_stream (parsing.h), así que
+ * batch touch f{1..100000000} ocupa en memoria una sola tanda.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdbool.h>
+
+#include "command.h"
+
+#define BATCH_MARGIN 2048            // bytes que se dejan libres del límite (como xargs)
+#define BATCH_STRING_MAX (32 * 4096) // largo máximo de una sola cadena en Linux (MAX_ARG_STRLEN)
+
+bool batch_fits(char *const *argv);
+/*
+ * Indica si execve() aceptaría `argv' (terminado en NULL) junto con el
+ * entorno de los comandos (vars_environment).
+ * Requires: argv != NULL
+ */
+
+int batch_run(scommand args);
+/*
+ * Ejecuta batch. Los argumentos (sin el "batch"), todavía sin expandir, se
+ * consumen de `args' a medida que se arman las tandas. Un argumento que no
+ * entra solo en una tanda corta ahí: las tandas anteriores ya se ejecutaron.
+ *   Returns: el estado de salida de todas las tandas, como en xargs: 0 si
+ *     todas terminaron bien; 123 si alguna falló; 125 si a alguna la mató
+ *     una señal; 126 si el comando no se pudo ejecutar (o un argumento no
+ *     entra solo en una tanda); 127 si no existe. Gana el más alto.
+ * Requires: args != NULL
+ */
+
+#endif /* BATCH_H */
@@ -0,0 +1,134 @@
+/* Medición de la latencia del completado.
+ * Arma un $PATH con un directorio de muchos ejecutables y un directorio con
+ * muchísimas entradas, y mide cuánto tarda un Tab con el cache frío (el hilo
+ * de fondo todavía no leyó nada) y con el cache caliente.
+ *
+ * Uso: ./bench_completion [ejecutables] [entradas]
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "completion.h"
+
+#define DEFAULT_EXECUTABLES 10000
+#define DEFAULT_ENTRIES 1000000
+#define WARM_ROUNDS 1000
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void fill_directory(const char *dir, const char *prefix, unsigned int count, mode_t mode)
+{
+    char name[64];
+    int dirfd = open(dir, O_RDONLY | O_DIRECTORY);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        snprintf(name, sizeof(name), "%s%u", prefix, i);
+        int fd = openat(dirfd, name, O_CREAT | O_WRONLY, mode);
+        if (fd < 0)
+        {
+            perror(name);
+            exit(EXIT_FAILURE);
+        }
+        close(fd);
+    }
+    close(dirfd);
+}
+
+static void empty_directory(const char *dir, const char *prefix, unsigned int count)
+{
+    char name[64];
+    int dirfd = open(dir, O_RDONLY | O_DIRECTORY);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        snprintf(name, sizeof(name), "%s%u", prefix, i);
+        unlinkat(dirfd, name, 0);
+    }
+    close(dirfd);
+    rmdir(dir);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de medir un mismo completado en frío y en caliente
+  -- en frío se repite el Tab hasta que el hilo de fondo termina de leer los directorios --
+------------------------------------------------------------------------------------------------
+*/
+static void measure(const char *label, const char *line)
+{
+    size_t cursor = strlen(line);
+    double start = now_ms();
+    completion *result = completion_complete(line, cursor);
+    double first = now_ms() - start;
+    unsigned int tabs = 1;
+    while (result->partial)
+    {
+        completion_destroy(result);
+        result = completion_complete(line, cursor);
+        tabs++;
+    }
+    double complete = now_ms() - start;
+    unsigned int count = result->count;
+    completion_destroy(result);
+
+    start = now_ms();
+    for (unsigned int i = 0; i < WARM_ROUNDS; i++)
+    {
+        completion_destroy(completion_complete(line, cursor));
+    }
+    double warm = (now_ms() - start) / WARM_ROUNDS;
+
+    printf("%-28s %8u coincidencias | primer Tab %8.3f ms | completo tras %u Tab %9.3f ms | cache caliente %7.3f ms\n",
+           label, count, first, tabs, complete, warm);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int executables = (argc > 1) ? (unsigned int)atoi(argv[1]) : DEFAULT_EXECUTABLES;
+    unsigned int entries = (argc > 2) ? (unsigned int)atoi(argv[2]) : DEFAULT_ENTRIES;
+
+    char root[] = "/tmp/bench_completion.XXXXXX";
+    if (mkdtemp(root) == NULL)
+    {
+        perror("mkdtemp");
+        return EXIT_FAILURE;
+    }
+    char *bin = malloc(strlen(root) + 8);
+    char *big = malloc(strlen(root) + 8);
+    sprintf(bin, "%s/bin", root);
+    sprintf(big, "%s/big", root);
+    mkdir(bin, 0755);
+    mkdir(big, 0755);
+
+    printf("Creando %u ejecutables y %u entradas en %s...\n", executables, entries, root);
+    fill_directory(bin, "cmd", executables, 0755);
+    fill_directory(big, "file", entries, 0644);
+    setenv("PATH", bin, 1);
+    if (chdir(big) != 0)
+    {
+        perror("chdir");
+        return EXIT_FAILURE;
+    }
+
+    measure("comando (cmd12)", "cmd12");
+    measure("comando (todos)", "c");
+    measure("archivo (file12345)", "ls file12345");
+    measure("archivo (todos)", "ls f");
+
+    empty_directory(bin, "cmd", executables);
+    empty_directory(big, "file", entries);
+    rmdir(root);
+    free(bin);
+    free(big);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,145 @@
+/* Medición de la distancia de edición usada por las sugerencias.
+ * Compara, sobre un diccionario de palabras al azar, la versión anterior
+ * (programación dinámica con una matriz completa) contra distance_of_edition()
+ * y distance_of_edition_batch(), y verifica que den lo mismo.
+ *
+ * Uso: ./bench_distance [palabras] [consultas]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "syntax.h"
+
+#define DEFAULT_WORDS 100000
+#define DEFAULT_QUERIES 20
+#define MAX_WORD_LENGTH 16
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de calcular la distancia como lo hacía syntax.c antes
+             -- matriz (len_s1+1) x (len_s2+1) llena fila por fila --
+------------------------------------------------------------------------------------------------
+*/
+static unsigned int reference_distance(const char *s1, const char *s2)
+{
+    size_t len_s1 = strlen(s1);
+    size_t len_s2 = strlen(s2);
+    unsigned int matrix[len_s1 + 1][len_s2 + 1];
+    for (size_t i = 0; i <= len_s1; i++)
+    {
+        matrix[i][0] = i;
+    }
+    for (size_t j = 0; j <= len_s2; j++)
+    {
+        matrix[0][j] = j;
+    }
+    for (size_t i = 1; i <= len_s1; i++)
+    {
+        for (size_t j = 1; j <= len_s2; j++)
+        {
+            unsigned int cost = (s1[i - 1] == s2[j - 1]) ? 0 : 1;
+            unsigned int best = matrix[i - 1][j - 1] + cost;
+            if (matrix[i - 1][j] + 1 < best)
+            {
+                best = matrix[i - 1][j] + 1;
+            }
+            if (matrix[i][j - 1] + 1 < best)
+            {
+                best = matrix[i][j - 1] + 1;
+            }
+            matrix[i][j] = best;
+        }
+    }
+    return matrix[len_s1][len_s2];
+}
+
+static char *random_word(unsigned int max_length)
+{
+    unsigned int length = 1 + rand() % max_length;
+    char *word = malloc(length + 1);
+    for (unsigned int i = 0; i < length; i++)
+    {
+        word[i] = "abcdefghijklmnopqrstuvwxyz-_0123"[rand() % 32];
+    }
+    word[length] = '\0';
+    return word;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int count = (argc > 1) ? (unsigned int)atoi(argv[1]) : DEFAULT_WORDS;
+    unsigned int queries = (argc > 2) ? (unsigned int)atoi(argv[2]) : DEFAULT_QUERIES;
+    srand(42);
+    char **words = malloc(count * sizeof(char *));
+    for (unsigned int i = 0; i < count; i++)
+    {
+        words[i] = random_word(MAX_WORD_LENGTH);
+    }
+    unsigned int *expected = malloc(count * sizeof(unsigned int));
+    unsigned int *got = malloc(count * sizeof(unsigned int));
+    double reference = 0, scalar = 0, batch = 0;
+    unsigned int errors = 0;
+
+    printf("%u consultas contra %u palabras\n", queries, count);
+    for (unsigned int q = 0; q < queries; q++)
+    {
+        char *query = random_word(MAX_WORD_LENGTH);
+        double start = now_ms();
+        for (unsigned int i = 0; i < count; i++)
+        {
+            expected[i] = reference_distance(query, words[i]);
+        }
+        reference += now_ms() - start;
+
+        start = now_ms();
+        for (unsigned int i = 0; i < count; i++)
+        {
+            got[i] = distance_of_edition(query, words[i]);
+        }
+        scalar += now_ms() - start;
+        errors += memcmp(got, expected, count * sizeof(unsigned int)) != 0;
+
+        start = now_ms();
+        distance_of_edition_batch(query, (const char *const *)words, count, got);
+        batch += now_ms() - start;
+        errors += memcmp(got, expected, count * sizeof(unsigned int)) != 0;
+        free(query);
+    }
+
+    // patrones de más de 64 caracteres: se usa la variante por bloques
+    char long_query[200];
+    for (unsigned int i = 0; i + 1 < sizeof(long_query); i++)
+    {
+        long_query[i] = "abcdefgh"[rand() % 8];
+    }
+    long_query[sizeof(long_query) - 1] = '\0';
+    for (unsigned int i = 0; i < count && i < 1000; i++)
+    {
+        errors += distance_of_edition(long_query, words[i]) != reference_distance(long_query, words[i]);
+        errors += distance_of_edition(words[i], long_query) != reference_distance(long_query, words[i]);
+    }
+
+    printf("matriz completa (anterior)  %9.3f ms por consulta\n", reference / queries);
+    printf("distance_of_edition         %9.3f ms por consulta (x%.1f)\n", scalar / queries, reference / scalar);
+    printf("distance_of_edition_batch   %9.3f ms por consulta (x%.1f)\n", batch / queries, reference / batch);
+    printf("%s\n", errors == 0 ? "resultados idénticos" : "ERROR: los resultados no coinciden");
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        free(words[i]);
+    }
+    free(words);
+    free(expected);
+    free(got);
+    return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
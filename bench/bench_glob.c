@@ -0,0 +1,161 @@
+/* Medición del ** recursivo (treewalk) contra find.
+ * Crea un árbol temporal de directorios anidados con unos 50 archivos cada
+ * uno (uno de cada cinco es un .log) y busca los .log de todo el árbol:
+ * con treewalk_find usando 1, 2, 4... hilos, con pathname_expand del patrón
+ * (** y después *.log) como lo expande el shell, y con find (solo, y
+ * ordenado con sort, que es lo que da el **). Si bash está instalado,
+ * también con su globstar. Antes de medir se recorre una vez el árbol, para
+ * que todos partan con los directorios en memoria.
+ *
+ * Uso: ./bench_glob [archivos] [árbol ya existente]
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <glib.h>
+
+#include "pathname.h"
+#include "treewalk.h"
+
+#define DEFAULT_FILES 200000
+#define FILES_PER_DIR 50
+#define DIRS_PER_DIR 8
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static bool log_filter(const char *name, bool is_dir, void *data)
+{
+    size_t length = strlen(name);
+    return !is_dir && name[0] != '.' && length > 4 && strcmp(name + length - 4, ".log") == 0;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de crear el árbol de prueba
+  -- los directorios se agregan a lo ancho, DIRS_PER_DIR por directorio, hasta que alcanzan
+                                    para `files' archivos --
+------------------------------------------------------------------------------------------------
+*/
+static void create_tree(const char *root, unsigned long files)
+{
+    GPtrArray *dirs = g_ptr_array_new_with_free_func(g_free);
+    g_ptr_array_add(dirs, g_strdup(root));
+    unsigned long needed = MAX(1ul, files / FILES_PER_DIR);
+    for (guint i = 0; dirs->len < needed; i++)
+    {
+        for (unsigned int d = 0; d < DIRS_PER_DIR && dirs->len < needed; d++)
+        {
+            char *dir = g_strdup_printf("%s/d%u", (char *)g_ptr_array_index(dirs, i), d);
+            if (mkdir(dir, 0700) != 0)
+            {
+                perror(dir);
+                exit(EXIT_FAILURE);
+            }
+            g_ptr_array_add(dirs, dir);
+        }
+    }
+    for (unsigned long f = 0; f < files; f++)
+    {
+        char *path = g_strdup_printf("%s/f%lu.%s", (char *)g_ptr_array_index(dirs, f % dirs->len), f,
+                                     (f % 5 == 0) ? "log" : "txt");
+        int fd = open(path, O_CREAT | O_WRONLY | O_CLOEXEC, 0600);
+        if (fd < 0)
+        {
+            perror(path);
+            exit(EXIT_FAILURE);
+        }
+        close(fd);
+        g_free(path);
+    }
+    g_ptr_array_free(dirs, TRUE);
+}
+
+static void run_command(const char *name, const char *command)
+{
+    double start = now_ms();
+    int status = system(command);
+    printf("%-24s %9.1f ms%s\n", name, now_ms() - start, (status == 0) ? "" : "  (falló)");
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long files = (argc > 1) ? strtoul(argv[1], NULL, 10) : DEFAULT_FILES;
+    if (files == 0)
+    {
+        fprintf(stderr, "uso: %s [archivos] [árbol ya existente]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    char temp[] = "/tmp/bench_glob_XXXXXX";
+    const char *root = (argc > 2) ? argv[2] : temp;
+    if (argc <= 2)
+    {
+        if (mkdtemp(temp) == NULL)
+        {
+            perror("mkdtemp");
+            return EXIT_FAILURE;
+        }
+        printf("creando %lu archivos en %s...\n", files, root);
+        create_tree(root, files);
+    }
+
+    GPtrArray *warm = treewalk_find(root, log_filter, NULL, 0);
+    printf("%u archivos .log\n", warm->len);
+    g_ptr_array_free(warm, TRUE);
+
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned int most = MIN((unsigned int)MAX(processors, 1l), TREEWALK_MAX_THREADS);
+    for (unsigned int threads = 1;; threads = MIN(threads * 2, most))
+    {
+        double start = now_ms();
+        GPtrArray *found = treewalk_find(root, log_filter, NULL, threads);
+        printf("treewalk, %2u hilo%s      %9.1f ms\n", threads, (threads == 1) ? " " : "s", now_ms() - start);
+        g_ptr_array_free(found, TRUE);
+        if (threads == most)
+        {
+            break;
+        }
+    }
+
+    char *pattern = g_strdup_printf("%s/**/*.log", root);
+    GPtrArray *words = g_ptr_array_new_with_free_func(free);
+    double start = now_ms();
+    pathname_expand(pattern, words);
+    printf("%-24s %9.1f ms\n", "pathname_expand", now_ms() - start);
+    g_ptr_array_free(words, TRUE);
+
+    char *command = g_strdup_printf("find %s -name '*.log' >/dev/null", root);
+    run_command("find", command);
+    g_free(command);
+    command = g_strdup_printf("find %s -name '*.log' | sort >/dev/null", root);
+    run_command("find | sort", command);
+    g_free(command);
+    if (system("command -v bash >/dev/null 2>&1") == 0)
+    {
+        command = g_strdup_printf("bash -O globstar -c 'x=(%s)'", pattern);
+        run_command("bash globstar", command);
+        g_free(command);
+    }
+    g_free(pattern);
+
+    if (argc <= 2)
+    {
+        command = g_strdup_printf("rm -rf %s", root);
+        if (system(command) != 0)
+        {
+            fprintf(stderr, "no se pudo borrar %s\n", root);
+        }
+        g_free(command);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,161 @@
+/* Medición del comando interno ps contra el ps de procps.
+ * Crea muchos procesos dormidos para agrandar la tabla y mide, con la salida
+ * a /dev/null, la lectura de /proc sola, ps completo (con y sin árbol) y
+ * "ps -eo ..." de procps con las mismas columnas.
+ *
+ * Uso: ./bench_ps [procesos] [rondas]
+ */
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <glib.h>
+
+#include "proc.h"
+#include "ps.h"
+
+#define DEFAULT_PROCESSES 2000
+#define DEFAULT_ROUNDS 10
+#define PROCPS_COMMAND "ps -eo pid,ppid,user,stat,rss,time,nlwp,args > /dev/null"
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void run_ps(const char *options)
+{
+    scommand args = scommand_new();
+    char **words = g_strsplit(options, " ", -1);
+    for (unsigned int i = 0; words[i] != NULL; i++)
+    {
+        if (words[i][0] != '\0')
+        {
+            scommand_push_back(args, strdup(words[i]));
+        }
+    }
+    g_strfreev(words);
+    ps_run(args);
+    scommand_destroy(args);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de medir ps con ciertas opciones
+               -- la salida va a /dev/null para medir solo lo que hace ps --
+------------------------------------------------------------------------------------------------
+*/
+static double measure_builtin(const char *options, unsigned int rounds)
+{
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDOUT_FILENO);
+    close(null);
+    double start = now_ms();
+    for (unsigned int i = 0; i < rounds; i++)
+    {
+        run_ps(options);
+        fflush(stdout);
+    }
+    double elapsed = (now_ms() - start) / rounds;
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    return elapsed;
+}
+
+static double measure_scan(unsigned int flags, unsigned int threads, unsigned int rounds)
+{
+    double start = now_ms();
+    for (unsigned int i = 0; i < rounds; i++)
+    {
+        proc_table_destroy(proc_scan_threads(flags, threads));
+    }
+    return (now_ms() - start) / rounds;
+}
+
+// Lo que cuesta cada muestra de `ps -w': la tabla se vuelve a leer en el mismo lugar
+static double measure_refresh(unsigned int flags, unsigned int rounds)
+{
+    proc_table table = proc_scan(flags);
+    double start = now_ms();
+    for (unsigned int i = 0; i < rounds; i++)
+    {
+        proc_refresh(table, flags);
+    }
+    double elapsed = (now_ms() - start) / rounds;
+    proc_table_destroy(table);
+    return elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int processes = (argc > 1) ? (unsigned int)atoi(argv[1]) : DEFAULT_PROCESSES;
+    unsigned int rounds = (argc > 2) ? (unsigned int)atoi(argv[2]) : DEFAULT_ROUNDS;
+    pid_t *children = malloc(processes * sizeof(pid_t));
+    unsigned int created = 0;
+    for (; created < processes; created++)
+    {
+        children[created] = fork();
+        if (children[created] == 0)
+        {
+            pause();
+            _exit(EXIT_SUCCESS);
+        }
+        if (children[created] < 0)
+        {
+            perror("fork");
+            break;
+        }
+    }
+    proc_table table = proc_scan(0);
+    printf("%u procesos creados, %u en la tabla\n", created, table != NULL ? proc_table_length(table) : 0);
+    if (table != NULL)
+    {
+        proc_table_destroy(table);
+    }
+
+    printf("lectura de /proc (stat)               %8.3f ms\n", measure_scan(0, 0, rounds));
+    printf("lectura de /proc (stat+cmdline+dueño) %8.3f ms\n", measure_scan(PROC_CMDLINE | PROC_OWNER, 0, rounds));
+    for (unsigned int threads = 1; threads <= PROC_MAX_THREADS; threads *= 2)
+    {
+        printf("lectura de /proc con %u hilo(s)        %8.3f ms\n", threads,
+               measure_scan(PROC_CMDLINE, threads, rounds));
+    }
+    double refresh = measure_refresh(0, rounds);
+    printf("relectura con proc_refresh (stat)     %8.3f ms (%.2f%% de un núcleo a 1 Hz)\n", refresh,
+           refresh / 10);
+    printf("ps -w, tres muestras seguidas         %8.3f ms\n", measure_builtin("-w 0.001 -n 3", rounds));
+    printf("ps                                    %8.3f ms\n", measure_builtin("", rounds));
+    printf("ps --sort -rss                        %8.3f ms\n", measure_builtin("--sort -rss", rounds));
+    printf("ps --forest                           %8.3f ms\n", measure_builtin("--forest", rounds));
+    double start = now_ms();
+    int status = 0;
+    for (unsigned int i = 0; i < rounds && status == 0; i++)
+    {
+        status = system(PROCPS_COMMAND);
+    }
+    if (status == 0)
+    {
+        printf("procps: %s %8.3f ms\n", PROCPS_COMMAND, (now_ms() - start) / rounds);
+    }
+    else
+    {
+        printf("procps: no se pudo ejecutar %s\n", PROCPS_COMMAND);
+    }
+
+    for (unsigned int i = 0; i < created; i++)
+    {
+        kill(children[i], SIGKILL);
+        waitpid(children[i], NULL, 0);
+    }
+    free(children);
+    return EXIT_SUCCESS;
+}
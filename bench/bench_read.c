@@ -0,0 +1,151 @@
+/* Medición del comando interno read sobre un archivo grande.
+ * Crea un archivo temporal de líneas de largo variable y mide un ciclo de
+ * lecturas de línea en línea: read_line de a bloques (con lseek de vuelta),
+ * read_line de a un byte (sobre un prefijo, porque es muy lento) y read
+ * completo (con el reparto en variables). Como referencia mide getline de
+ * stdio, que lee de a bloques pero sin devolver lo leído de más.
+ *
+ * Uso: ./bench_read [MB] [MB de a un byte]
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <glib.h>
+
+#include "read.h"
+#include "vars.h"
+
+#define DEFAULT_MEGABYTES 1024
+#define DEFAULT_BYTES_MEGABYTES 16
+#define MEGABYTE (1024.0 * 1024.0)
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de crear el archivo de prueba
+  -- líneas de 1 a 160 caracteres (unos 80 en promedio), en palabras separadas por espacios --
+------------------------------------------------------------------------------------------------
+*/
+static int create_file(char *path, size_t size)
+{
+    int fd = mkstemp(path);
+    if (fd < 0)
+    {
+        perror("mkstemp");
+        exit(EXIT_FAILURE);
+    }
+    GString *block = g_string_new(NULL);
+    srand(42);
+    for (size_t written = 0; written < size;)
+    {
+        g_string_truncate(block, 0);
+        while (block->len < 1024 * 1024)
+        {
+            size_t length = 1 + rand() % 160;
+            for (size_t i = 0; i < length; i++)
+            {
+                g_string_append_c(block, (i % 8 == 7) ? ' ' : (char)('a' + rand() % 26));
+            }
+            g_string_append_c(block, '\n');
+        }
+        if (write(fd, block->str, block->len) != (ssize_t)block->len)
+        {
+            perror("write");
+            exit(EXIT_FAILURE);
+        }
+        written += block->len;
+    }
+    g_string_free(block, TRUE);
+    return fd;
+}
+
+static void report(const char *name, double elapsed, size_t bytes, size_t lines)
+{
+    printf("%-34s %10.1f ms %9.1f MB/s %11.0f líneas/s\n", name, elapsed, bytes / MEGABYTE / (elapsed / 1e3),
+           lines / (elapsed / 1e3));
+}
+
+// Lee `limit' bytes (o todo el archivo) de línea en línea con read_line
+static void measure_lines(const char *name, int fd, int strategy, size_t limit)
+{
+    GString *line = g_string_new(NULL);
+    size_t bytes = 0, lines = 0;
+    lseek(fd, 0, SEEK_SET);
+    double start = now_ms();
+    while (read_line(fd, line, strategy) && (limit == 0 || bytes < limit))
+    {
+        bytes += line->len + 1;
+        lines++;
+    }
+    report(name, now_ms() - start, bytes, lines);
+    g_string_free(line, TRUE);
+}
+
+// El ciclo "while read -u fd a b" completo, con el reparto en dos variables
+static void measure_builtin(int fd, size_t size)
+{
+    char descriptor[16];
+    snprintf(descriptor, sizeof(descriptor), "%d", fd);
+    size_t lines = 0;
+    bool found = true;
+    lseek(fd, 0, SEEK_SET);
+    double start = now_ms();
+    while (found)
+    {
+        scommand args = scommand_new();
+        scommand_push_back(args, strdup("-u"));
+        scommand_push_back(args, strdup(descriptor));
+        scommand_push_back(args, strdup("first"));
+        scommand_push_back(args, strdup("rest"));
+        found = read_run(args);
+        scommand_destroy(args);
+        lines += found;
+    }
+    report("read -u fd first rest", now_ms() - start, size, lines);
+}
+
+static void measure_getline(int fd, size_t size)
+{
+    lseek(fd, 0, SEEK_SET);
+    FILE *file = fdopen(dup(fd), "r");
+    char *line = NULL;
+    size_t allocated = 0, lines = 0;
+    double start = now_ms();
+    while (getline(&line, &allocated, file) >= 0)
+    {
+        lines++;
+    }
+    report("getline de stdio (referencia)", now_ms() - start, size, lines);
+    free(line);
+    fclose(file);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t megabytes = (argc > 1) ? (size_t)atoi(argv[1]) : DEFAULT_MEGABYTES;
+    size_t bytes_megabytes = (argc > 2) ? (size_t)atoi(argv[2]) : DEFAULT_BYTES_MEGABYTES;
+    char path[] = "/tmp/bench_read_XXXXXX";
+    int fd = create_file(path, megabytes * 1024 * 1024);
+    size_t size = lseek(fd, 0, SEEK_END);
+    printf("archivo de %.0f MB\n", size / MEGABYTE);
+
+    measure_lines("read_line de a bloques", fd, READ_AUTO, 0);
+    measure_lines("read_line de a un byte (prefijo)", fd, READ_BYTES, bytes_megabytes * 1024 * 1024);
+    measure_builtin(fd, size);
+    measure_getline(fd, size);
+
+    vars_destroy();
+    close(fd);
+    unlink(path);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,98 @@
+/* Medición de un ciclo de un millón de vueltas en mybash, bash y dash.
+ * Crea un archivo con un número por línea y un script por shell que recorre
+ * esos números con un for y asigna cada uno a una variable. mybash carga el
+ * archivo con mapfile (no tiene sustitución de comandos) y asigna con set;
+ * bash usa mapfile y x=$i; dash no tiene arreglos y recorre $(cat). Cada
+ * script se ejecuta como `shell script', con la salida a /dev/null; un shell
+ * que no está instalado se saltea.
+ *
+ * Uso: ./bench_script [vueltas] [mybash]
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <glib.h>
+
+#define DEFAULT_ITERATIONS 1000000
+#define DEFAULT_SHELL "../mybash"
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static char *create_temp(const char *contents)
+{
+    char *path = g_strdup("/tmp/bench_script_XXXXXX");
+    int fd = mkstemp(path);
+    FILE *file = (fd >= 0) ? fdopen(fd, "w") : NULL;
+    if (file == NULL)
+    {
+        perror("mkstemp");
+        exit(EXIT_FAILURE);
+    }
+    fputs(contents, file);
+    fclose(file);
+    return path;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de ejecutar un script con un shell y medir cuánto tarda
+  -- el archivo de números queda abierto en el descriptor 3, de donde lo leen los scripts --
+------------------------------------------------------------------------------------------------
+*/
+static void run(const char *name, const char *shell, const char *body, const char *numbers, unsigned long iterations)
+{
+    char *check = g_strdup_printf("command -v %s >/dev/null 2>&1", shell);
+    bool installed = system(check) == 0;
+    g_free(check);
+    if (!installed)
+    {
+        printf("%-8s no está instalado\n", name);
+        return;
+    }
+    char *script = create_temp(body);
+    char *command = g_strdup_printf("%s %s 3<%s >/dev/null 2>&1", shell, script, numbers);
+    double start = now_ms();
+    int status = system(command);
+    double elapsed = now_ms() - start;
+    printf("%-8s %9.1f ms  %7.0f ns/vuelta%s\n", name, elapsed, elapsed * 1e6 / iterations,
+           (status == 0) ? "" : "  (falló)");
+    unlink(script);
+    g_free(command);
+    g_free(script);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long iterations = (argc > 1) ? strtoul(argv[1], NULL, 10) : DEFAULT_ITERATIONS;
+    const char *mybash = (argc > 2) ? argv[2] : DEFAULT_SHELL;
+    if (iterations == 0)
+    {
+        fprintf(stderr, "uso: %s [vueltas] [mybash]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    GString *lines = g_string_new(NULL);
+    for (unsigned long i = 1; i <= iterations; i++)
+    {
+        g_string_append_printf(lines, "%lu\n", i);
+    }
+    char *numbers = create_temp(lines->str);
+    g_string_free(lines, TRUE);
+
+    printf("for de %lu vueltas\n", iterations);
+    run("mybash", mybash, "mapfile -t -u 3 a\nfor i in ${a[@]} ; do set x=$i ; done\n", numbers, iterations);
+    run("bash", "bash", "mapfile -t -u 3 a\nfor i in \"${a[@]}\"; do x=$i; done\n", numbers, iterations);
+    run("dash", "dash", "for i in $(cat <&3); do x=$i; done\n", numbers, iterations);
+
+    unlink(numbers);
+    g_free(numbers);
+    return EXIT_SUCCESS;
+}
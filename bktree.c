@@ -0,0 +1,145 @@
+#include <assert.h>
+#include <limits.h> // permite usar UINT_MAX
+#include <stdbool.h>
+#include <glib.h>
+
+#include "bktree.h"
+#include "syntax.h"
+
+#define NO_NODE UINT_MAX // Índice que indica la ausencia de un nodo
+
+/* Nodo del BK-tree. Cada hijo cuelga de su padre con la distancia de edición
+ * entre ambas palabras; por la desigualdad triangular, al buscar palabras a
+ * distancia <= r de la consulta solo hace falta bajar por los hijos cuya
+ * distancia al padre difiere en <= r de la distancia consulta-padre.
+ */
+struct bk_node
+{
+    const char *word;          // palabra del diccionario
+    unsigned int distance;     // distancia a la palabra del padre
+    unsigned int first_child;  // hijos, en una lista enlazada por índices
+    unsigned int next_sibling; // siguiente hermano
+};
+
+GArray *bktree_new(void)
+{
+    return g_array_new(FALSE, FALSE, sizeof(struct bk_node));
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de insertar una palabra en el BK-tree
+     -- baja por el hijo que está a la misma distancia, o se cuelga como hijo nuevo --
+------------------------------------------------------------------------------------------------
+*/
+void bktree_insert(GArray *nodes, const char *word)
+{
+    assert(nodes != NULL && word != NULL);
+    struct bk_node new_node = {word, 0, NO_NODE, NO_NODE};
+    if (nodes->len == 0)
+    {
+        g_array_append_val(nodes, new_node);
+        return;
+    }
+    unsigned int current = 0;
+    while (true)
+    {
+        struct bk_node *node = &g_array_index(nodes, struct bk_node, current);
+        unsigned int dist = distance_of_edition(word, node->word);
+        if (dist == 0)
+        {
+            return; // palabra repetida
+        }
+        unsigned int child = node->first_child;
+        while (child != NO_NODE && g_array_index(nodes, struct bk_node, child).distance != dist)
+        {
+            child = g_array_index(nodes, struct bk_node, child).next_sibling;
+        }
+        if (child == NO_NODE)
+        {
+            new_node.distance = dist;
+            new_node.next_sibling = node->first_child;
+            node->first_child = nodes->len;
+            g_array_append_val(nodes, new_node); // puede mover el arreglo: `node' ya no se usa
+            return;
+        }
+        current = child;
+    }
+}
+
+/* Entrada de la pila de bktree_nearest(): un nodo y su distancia ya calculada */
+struct pending_node
+{
+    unsigned int node;
+    unsigned int distance;
+};
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de buscar la palabra más cercana a `command' a distancia <= bound
+       -- se recorre con una pila; cada mejora encoge el rango de hijos a visitar.
+          Los hijos que entran en el rango se miden todos juntos al apilarlos --
+------------------------------------------------------------------------------------------------
+*/
+const char *bktree_nearest(GArray *nodes, const char *command, unsigned int bound, unsigned int *distance)
+{
+    assert(nodes != NULL && command != NULL && distance != NULL);
+    const char *best = NULL;
+    unsigned int best_node = NO_NODE;
+    unsigned int best_distance = bound + 1;
+    if (nodes->len == 0)
+    {
+        *distance = best_distance;
+        return NULL;
+    }
+    GArray *stack = g_array_new(FALSE, FALSE, sizeof(struct pending_node));
+    GArray *children = g_array_new(FALSE, FALSE, sizeof(unsigned int));
+    GPtrArray *candidates = g_ptr_array_new();
+    GArray *distances = g_array_new(FALSE, FALSE, sizeof(unsigned int));
+    struct pending_node root = {0, distance_of_edition(command, g_array_index(nodes, struct bk_node, 0).word)};
+    g_array_append_val(stack, root);
+    while (stack->len > 0)
+    {
+        struct pending_node current = g_array_index(stack, struct pending_node, stack->len - 1);
+        g_array_set_size(stack, stack->len - 1);
+        const struct bk_node *node = &g_array_index(nodes, struct bk_node, current.node);
+        unsigned int dist = current.distance;
+        // a igual distancia gana la palabra que se insertó antes; más allá de
+        // bound no se toma ninguna, aunque empate con bound + 1
+        if (dist <= bound && (dist < best_distance || (dist == best_distance && current.node < best_node)))
+        {
+            best_distance = dist;
+            best_node = current.node;
+            best = node->word;
+        }
+        // radio de búsqueda: solo interesan palabras a distancia <= best_distance
+        unsigned int radius = MIN(best_distance, bound);
+        g_array_set_size(children, 0);
+        g_ptr_array_set_size(candidates, 0);
+        for (unsigned int child = node->first_child; child != NO_NODE;
+             child = g_array_index(nodes, struct bk_node, child).next_sibling)
+        {
+            const struct bk_node *child_node = &g_array_index(nodes, struct bk_node, child);
+            if (child_node->distance + radius >= dist && child_node->distance <= dist + radius)
+            {
+                g_array_append_val(children, child);
+                g_ptr_array_add(candidates, (gpointer)child_node->word);
+            }
+        }
+        g_array_set_size(distances, children->len);
+        distance_of_edition_batch(command, (const char *const *)candidates->pdata, children->len,
+                                  (unsigned int *)distances->data);
+        for (unsigned int i = 0; i < children->len; i++)
+        {
+            struct pending_node pending = {g_array_index(children, unsigned int, i),
+                                           g_array_index(distances, unsigned int, i)};
+            g_array_append_val(stack, pending);
+        }
+    }
+    g_array_free(distances, TRUE);
+    g_ptr_array_free(candidates, TRUE);
+    g_array_free(children, TRUE);
+    g_array_free(stack, TRUE);
+    *distance = best_distance;
+    return best;
+}
@@ -0,0 +1,34 @@
+/* BK-tree de palabras, ordenado por distancia de edición.
+ * Los nodos viven en un GArray y se enlazan por índices: el árbol se arma una
+ * vez y después solo se consulta, así que no hace falta liberar nodos sueltos.
+ * Las palabras no se copian; tienen que vivir tanto como el árbol.
+ */
+
+#ifndef BKTREE_H
+#define BKTREE_H
+
+#include <glib.h>
+
+GArray *bktree_new(void);
+/*
+ * Crea un BK-tree vacío.
+ *   Returns: árbol nuevo, que el llamador libera con g_array_free(tree, TRUE).
+ */
+
+void bktree_insert(GArray *nodes, const char *word);
+/*
+ * Agrega `word' al árbol; si ya estaba, no hace nada.
+ * Requires: nodes != NULL && word != NULL
+ */
+
+const char *bktree_nearest(GArray *nodes, const char *command, unsigned int bound, unsigned int *distance);
+/*
+ * Busca la palabra del árbol más cercana a `command', a distancia <= bound.
+ * A igual distancia gana la que se insertó antes.
+ *   distance: se guarda la distancia de la palabra encontrada, o bound + 1
+ *     si no se encontró ninguna.
+ *   Returns: la palabra encontrada, o NULL.
+ * Requires: nodes != NULL && command != NULL && distance != NULL
+ */
+
+#endif
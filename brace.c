@@ -0,0 +1,432 @@
+#include <assert.h>
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#include "brace.h"
+
+enum part_kind
+{
+    PART_TEXT,  // texto fijo
+    PART_RANGE, // {first..last..step}
+    PART_LIST   // {a,b,c}
+};
+
+struct sequence;
+
+// Un pedazo de una palabra, con su valor actual
+struct part
+{
+    enum part_kind kind;
+    char *text;         // PART_TEXT
+    long first;         // PART_RANGE: extremos, y el paso con el signo de la dirección
+    long last;
+    long step;
+    long current;
+    int width;          // PART_RANGE: ancho con ceros a la izquierda (0: sin ceros)
+    bool letters;       // PART_RANGE: los valores son letras
+    GPtrArray *choices; // PART_LIST: una struct sequence por alternativa
+    guint choice;
+};
+
+// Una palabra (o una alternativa de una lista): sus pedazos, uno detrás del otro
+struct sequence
+{
+    GArray *parts; // struct part
+};
+
+struct brace_s
+{
+    struct sequence *root;
+    bool started;
+    GString *buffer;
+};
+
+static struct sequence *parse_sequence(const char *word, size_t start, size_t end);
+
+static void sequence_free(gpointer data)
+{
+    struct sequence *seq = data;
+    for (guint i = 0; i < seq->parts->len; i++)
+    {
+        struct part *part = &g_array_index(seq->parts, struct part, i);
+        free(part->text);
+        if (part->choices != NULL)
+        {
+            g_ptr_array_free(part->choices, TRUE);
+        }
+    }
+    g_array_free(seq->parts, TRUE);
+    free(seq);
+}
+
+// Devuelve la posición que sigue a las comillas que empiezan en `i'
+static size_t skip_quoted(const char *word, size_t i, size_t end)
+{
+    char quote = word[i++];
+    while (i < end && word[i] != quote)
+    {
+        i += (quote == '"' && word[i] == '\\' && i + 1 < end) ? 2 : 1;
+    }
+    return (i < end) ? i + 1 : end;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de buscar la llave que cierra a la que está en `open'
+  -- saltea comillas, '\' y llaves anidadas; anota en `commas' las ',' que no están anidadas.
+                       Devuelve `end' si no se cierra --
+------------------------------------------------------------------------------------------------
+*/
+static size_t find_close(const char *word, size_t open, size_t end, GArray *commas)
+{
+    unsigned int depth = 0;
+    for (size_t i = open; i < end;)
+    {
+        char c = word[i];
+        if (c == '\\')
+        {
+            i += 2;
+            continue;
+        }
+        if (c == '\'' || c == '"')
+        {
+            i = skip_quoted(word, i, end);
+            continue;
+        }
+        if (c == '{')
+        {
+            depth++;
+        }
+        else if (c == '}' && --depth == 0)
+        {
+            return i;
+        }
+        else if (c == ',' && depth == 1 && commas != NULL)
+        {
+            g_array_append_val(commas, i);
+        }
+        i++;
+    }
+    return end;
+}
+
+// Lee un extremo o el paso de un rango: un número entero que ocupa justo `length' caracteres
+static bool parse_number(const char *text, size_t length, long *value)
+{
+    char buffer[32];
+    if (length == 0 || length >= sizeof(buffer))
+    {
+        return false;
+    }
+    memcpy(buffer, text, length);
+    buffer[length] = '\0';
+    char *rest = NULL;
+    errno = 0;
+    *value = strtol(buffer, &rest, 10);
+    size_t sign = (buffer[0] == '-' || buffer[0] == '+');
+    return errno == 0 && *rest == '\0' && isdigit((unsigned char)buffer[sign]) && *value != LONG_MIN;
+}
+
+// Indica si un extremo pide ceros a la izquierda (01, -01)
+static bool padded(const char *text, size_t length)
+{
+    size_t sign = (text[0] == '-' || text[0] == '+');
+    return length > sign + 1 && text[sign] == '0';
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de reconocer un rango: x..y o x..y..paso
+  -- x e y son dos números o dos letras; el paso puede tener cualquier signo: la dirección
+                              la dan los extremos --
+------------------------------------------------------------------------------------------------
+*/
+static bool parse_range(const char *text, size_t length, struct part *part)
+{
+    const char *dots = g_strstr_len(text, length, "..");
+    if (dots == NULL)
+    {
+        return false;
+    }
+    const char *second = dots + 2, *end = text + length;
+    const char *more = g_strstr_len(second, end - second, "..");
+    const char *second_end = (more != NULL) ? more : end;
+    long step = 1;
+    if (more != NULL && !parse_number(more + 2, end - more - 2, &step))
+    {
+        return false;
+    }
+    size_t first_length = dots - text, second_length = second_end - second;
+    memset(part, 0, sizeof(*part));
+    part->kind = PART_RANGE;
+    if (first_length == 1 && second_length == 1 && isalpha((unsigned char)text[0]) && isalpha((unsigned char)second[0]))
+    {
+        part->letters = true;
+        part->first = (unsigned char)text[0];
+        part->last = (unsigned char)second[0];
+    }
+    else if (parse_number(text, first_length, &part->first) && parse_number(second, second_length, &part->last))
+    {
+        if (padded(text, first_length) || padded(second, second_length))
+        {
+            part->width = (int)MAX(first_length, second_length);
+        }
+    }
+    else
+    {
+        return false;
+    }
+    step = (step < 0) ? -step : step;
+    step = (step == 0) ? 1 : step;
+    part->step = (part->first <= part->last) ? step : -step;
+    part->current = part->first;
+    return true;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de reconocer la llave entre `open' y `close'
+  -- una lista (con alguna ',') o un rango; si no es ninguno, la llave es texto --
+------------------------------------------------------------------------------------------------
+*/
+static bool parse_brace(const char *word, size_t open, size_t close, GArray *commas, struct part *part)
+{
+    if (commas->len == 0)
+    {
+        return parse_range(word + open + 1, close - open - 1, part);
+    }
+    memset(part, 0, sizeof(*part));
+    part->kind = PART_LIST;
+    part->choices = g_ptr_array_new_with_free_func(sequence_free);
+    size_t start = open + 1;
+    for (guint i = 0; i <= commas->len; i++)
+    {
+        size_t stop = (i < commas->len) ? g_array_index(commas, size_t, i) : close;
+        g_ptr_array_add(part->choices, parse_sequence(word, start, stop));
+        start = stop + 1;
+    }
+    return true;
+}
+
+// Agrega como pedazo el texto juntado (una secuencia vacía también tiene uno: "")
+static void flush_text(struct sequence *seq, GString *text, bool always)
+{
+    if (text->len > 0 || always)
+    {
+        struct part part = {0};
+        part.kind = PART_TEXT;
+        part.text = strdup(text->str);
+        g_array_append_val(seq->parts, part);
+        g_string_truncate(text, 0);
+    }
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de partir en pedazos lo que hay entre `start' y `end'
+  -- el texto que hay entre dos llaves que se expanden queda en un solo pedazo --
+------------------------------------------------------------------------------------------------
+*/
+static struct sequence *parse_sequence(const char *word, size_t start, size_t end)
+{
+    struct sequence *seq = malloc(sizeof(struct sequence));
+    assert(seq != NULL);
+    seq->parts = g_array_new(FALSE, FALSE, sizeof(struct part));
+    GString *text = g_string_new(NULL);
+    GArray *commas = g_array_new(FALSE, FALSE, sizeof(size_t));
+    size_t i = start;
+    while (i < end)
+    {
+        char c = word[i];
+        size_t next = i + 1;
+        if (c == '\\')
+        {
+            next = MIN(i + 2, end);
+        }
+        else if (c == '\'' || c == '"')
+        {
+            next = skip_quoted(word, i, end);
+        }
+        else if (c == '$' && i + 1 < end && word[i + 1] == '{')
+        {
+            // ${NOMBRE} es una variable, no una llave
+            next = MIN(find_close(word, i + 1, end, NULL) + 1, end);
+        }
+        else if (c == '{')
+        {
+            struct part part;
+            g_array_set_size(commas, 0);
+            size_t close = find_close(word, i, end, commas);
+            if (close < end && parse_brace(word, i, close, commas, &part))
+            {
+                flush_text(seq, text, false);
+                g_array_append_val(seq->parts, part);
+                i = close + 1;
+                continue;
+            }
+        }
+        g_string_append_len(text, word + i, next - i);
+        i = next;
+    }
+    flush_text(seq, text, seq->parts->len == 0);
+    g_string_free(text, TRUE);
+    g_array_free(commas, TRUE);
+    return seq;
+}
+
+static void sequence_reset(struct sequence *seq);
+
+static void part_reset(struct part *part)
+{
+    if (part->kind == PART_RANGE)
+    {
+        part->current = part->first;
+    }
+    else if (part->kind == PART_LIST)
+    {
+        part->choice = 0;
+        sequence_reset(g_ptr_array_index(part->choices, 0));
+    }
+}
+
+static void sequence_reset(struct sequence *seq)
+{
+    for (guint i = 0; i < seq->parts->len; i++)
+    {
+        part_reset(&g_array_index(seq->parts, struct part, i));
+    }
+}
+
+static bool sequence_advance(struct sequence *seq);
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de pasar un pedazo a su próximo valor
+  -- si ya dio el último vuelve al primero y devuelve false, como un dígito de un odómetro --
+------------------------------------------------------------------------------------------------
+*/
+static bool part_advance(struct part *part)
+{
+    if (part->kind == PART_RANGE)
+    {
+        // lo que falta hasta el final, sin desbordar aunque los extremos estén lejos
+        unsigned long left = (part->step > 0) ? (unsigned long)part->last - (unsigned long)part->current
+                                              : (unsigned long)part->current - (unsigned long)part->last;
+        unsigned long step = (part->step > 0) ? (unsigned long)part->step : (unsigned long)-part->step;
+        if (left >= step)
+        {
+            part->current += part->step;
+            return true;
+        }
+    }
+    else if (part->kind == PART_LIST)
+    {
+        if (sequence_advance(g_ptr_array_index(part->choices, part->choice)))
+        {
+            return true;
+        }
+        if (++part->choice < part->choices->len)
+        {
+            sequence_reset(g_ptr_array_index(part->choices, part->choice));
+            return true;
+        }
+    }
+    part_reset(part);
+    return false;
+}
+
+static bool sequence_advance(struct sequence *seq)
+{
+    for (guint i = seq->parts->len; i > 0; i--)
+    {
+        if (part_advance(&g_array_index(seq->parts, struct part, i - 1)))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void sequence_append(struct sequence *seq, GString *out)
+{
+    for (guint i = 0; i < seq->parts->len; i++)
+    {
+        struct part *part = &g_array_index(seq->parts, struct part, i);
+        if (part->kind == PART_TEXT)
+        {
+            g_string_append(out, part->text);
+        }
+        else if (part->kind == PART_LIST)
+        {
+            sequence_append(g_ptr_array_index(part->choices, part->choice), out);
+        }
+        else if (part->letters)
+        {
+            g_string_append_c(out, (char)part->current);
+        }
+        else
+        {
+            g_string_append_printf(out, "%0*ld", part->width, part->current);
+        }
+    }
+}
+
+bool brace_has_expression(const char *word)
+{
+    assert(word != NULL);
+    if (strchr(word, '{') == NULL)
+    {
+        return false;
+    }
+    struct sequence *seq = parse_sequence(word, 0, strlen(word));
+    bool result = seq->parts->len > 1 || g_array_index(seq->parts, struct part, 0).kind != PART_TEXT;
+    sequence_free(seq);
+    return result;
+}
+
+brace brace_new(const char *word)
+{
+    assert(word != NULL);
+    brace result = malloc(sizeof(struct brace_s));
+    assert(result != NULL);
+    result->root = parse_sequence(word, 0, strlen(word));
+    result->started = false;
+    result->buffer = g_string_new(NULL);
+    return result;
+}
+
+brace brace_destroy(brace self)
+{
+    assert(self != NULL);
+    if (self->root != NULL)
+    {
+        sequence_free(self->root);
+    }
+    g_string_free(self->buffer, TRUE);
+    free(self);
+    return NULL;
+}
+
+char *brace_next(brace self)
+{
+    assert(self != NULL);
+    if (self->root == NULL)
+    {
+        return NULL;
+    }
+    if (self->started && !sequence_advance(self->root))
+    {
+        // se dio toda la vuelta
+        sequence_free(self->root);
+        self->root = NULL;
+        return NULL;
+    }
+    self->started = true;
+    g_string_truncate(self->buffer, 0);
+    sequence_append(self->root, self->buffer);
+    return strdup(self->buffer->str);
+}
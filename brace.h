@@ -0,0 +1,49 @@
+/* Expansión de llaves: a{b,c}d, {1..10}, {01..100..3}, {a..z}.
+ * Una palabra se recorre con un generador que da una expansión por vez, sin
+ * armar la lista entera: {1..10000000} ocupa lo mismo que {1..2}. Varias
+ * llaves en una palabra se combinan (la primera es la que cambia más lento)
+ * y pueden anidarse ({a,{b,c}}).
+ *
+ * Como en bash, la expansión de llaves va antes que la de variables: las
+ * palabras que da el generador todavía tienen sus '$' y sus comillas. Lo que
+ * está entre comillas, después de una '\' o en un ${...} no se expande, y
+ * una llave que no forma una lista (con alguna ',') ni un rango queda como
+ * está.
+ */
+
+#ifndef BRACE_H
+#define BRACE_H
+
+#include <stdbool.h>
+
+typedef struct brace_s *brace;
+
+bool brace_has_expression(const char *word);
+/*
+ * Indica si `word' tiene alguna llave que se expande.
+ * Requires: word != NULL
+ */
+
+brace brace_new(const char *word);
+/*
+ * Nuevo generador de las expansiones de `word' (se copia). Una palabra sin
+ * llaves que se expandan da una sola: ella misma.
+ * Requires: word != NULL
+ * Ensures: result != NULL
+ */
+
+brace brace_destroy(brace self);
+/*
+ * Destruye el generador.
+ * Requires: self != NULL
+ * Ensures: result == NULL
+ */
+
+char *brace_next(brace self);
+/*
+ * Devuelve la próxima expansión.
+ *   Returns: cadena a liberar con free(), o NULL si ya no quedan.
+ * Requires: self != NULL
+ */
+
+#endif /* BRACE_H */
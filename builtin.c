@@ -4,12 +4,22 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <errno.h>
-#include <dirent.h>
 #include <time.h>
+#include <glib.h>
 
 #include "tests/syscall_mock.h"
 #include "command.h"
 #include "builtin.h"
+#include "history.h"
+#include "ps.h"
+#include "kill.h"
+#include "print.h"
+#include "vars.h"
+#include "mapfile.h"
+#include "read.h"
+#include "batch.h"
+#include "phash.h"
+#include "builtin_hash.h" // generado por tools/gentables a partir de internal_commands
 
 #define RESET   "\033[0m"
 #define RED     "\033[31m"
@@ -24,7 +34,9 @@
 
 typedef void (*CommandFunc)(scommand cmd);
 
-// Guardaremos los comandos internos en un struct para hacer que agregar comandos nuevos sea mas simple
+// Guardaremos los comandos internos en un struct para hacer que agregar comandos nuevos sea mas simple.
+// Cada entrada de internal_commands va en una sola línea: el Makefile lee los nombres de ahí para
+// generar el hash perfecto de builtin_hash.h
 typedef struct
 {
     // nombre del comando, de la forma que deberá ser ingresado por consola
@@ -33,6 +45,9 @@ typedef struct
     CommandFunc func;
 } Command;
 
+// Estado de salida del comando interno que está corriendo: cada uno lo pone en EXIT_FAILURE si falla
+static int status = EXIT_SUCCESS;
+
 
 /*
 ------------------------------------------------------------
@@ -46,7 +61,13 @@ static void cmd_cd(scommand cmd)
     // caso de que a cd no se le indicó un directorio, nos lleva a Home
     if (scommand_length(cmd) == 0)
     {
-        char *home = getenv("HOME");
+        const char *home = vars_get("HOME");
+        if (home == NULL)
+        {
+            fprintf(stderr, "cd: HOME not set\n");
+            status = EXIT_FAILURE;
+            return;
+        }
         chdir(home);
     }
     // a cd sí se le indicó un directorio
@@ -58,6 +79,7 @@ static void cmd_cd(scommand cmd)
         if (res != 0)
         {
             perror("Directory change failed\n");
+            status = EXIT_FAILURE;
         }
         else if (res == -1)
         {
@@ -100,7 +122,19 @@ static void cmd_help(scommand cmd)
     printf(YELLOW "- exit        " RESET BLUE "- closes myBash\n" RESET);
     printf(YELLOW "- pwd         " RESET BLUE "- shows you your current directory\n" RESET);
     printf(YELLOW "- ps          " RESET BLUE "- allows you to view information about the current running processes on your system\n" RESET);
-    printf(YELLOW "- echo        " RESET BLUE "- outputs the strings that are passed to it as arguments\n" RESET);
+    printf(YELLOW "              " RESET BLUE "  (-o columns, --sort [-]keys, -u users, -C names, --forest, -w seconds)\n" RESET);
+    printf(YELLOW "- kill        " RESET BLUE "- sends a signal (TERM by default) to pids or jobs (%%N); kill -l lists signals\n" RESET);
+    printf(YELLOW "- pkill       " RESET BLUE "- sends a signal to the processes whose name matches a pattern (-f: whole command line)\n" RESET);
+    printf(YELLOW "- echo        " RESET BLUE "- outputs the strings that are passed to it as arguments (-n: no newline, -e: escapes)\n" RESET);
+    printf(YELLOW "- printf      " RESET BLUE "- formats and prints its arguments (printf format [arguments])\n" RESET);
+    printf(YELLOW "- export      " RESET BLUE "- exports variables to the commands you run (export NAME[=value], -n to stop)\n" RESET);
+    printf(YELLOW "- unset       " RESET BLUE "- removes variables\n" RESET);
+    printf(YELLOW "- set         " RESET BLUE "- lists every variable, or defines shell-only ones (set NAME=value, set NAME[i]=value)\n" RESET);
+    printf(YELLOW "- declare     " RESET BLUE "- declares arrays (-a indexed, -A associative): ${a[i]}, ${a[@]}, ${#a[@]}\n" RESET);
+    printf(YELLOW "- mapfile     " RESET BLUE "- loads the lines of the input into an array (-t strip newlines, -n count, -u fd)\n" RESET);
+    printf(YELLOW "- read        " RESET BLUE "- reads one line into variables, split on $IFS (-r raw, -u fd, -p prompt)\n" RESET);
+    printf(YELLOW "- batch       " RESET BLUE "- runs a command in batches that fit ARG_MAX, like xargs (-P parallel jobs, -k fixed args)\n" RESET);
+    printf(YELLOW "- history     " RESET BLUE "- lists previous commands, -s <pattern> finds the latest one containing it\n" RESET);
     printf(YELLOW "- kirby       " RESET BLUE "- use at your own risk\n" RESET);
     printf(YELLOW "- cowsay      " RESET BLUE "- makes Lola say whatever you want!\n" RESET);
 }
@@ -205,59 +239,355 @@ static void cmd_cowsay(scommand cmd)
 /*
 ---------------------------------------------------------------
   *   Función encargada de imprimir lo ingresado (EXTRA)
+     -- arma toda la línea y la escribe con un writev --
 ---------------------------------------------------------------
 */
 static void cmd_echo(scommand cmd)
 {
     scommand_pop_front(cmd);
-    while (!scommand_is_empty(cmd))
+    status = echo_run(cmd);
+}
+
+/*
+------------------------------------------------------------------
+*    Función encargada de escribir con formato (EXTRA)
+  -- los formatos se compilan una vez y se guardan (print.c) --
+------------------------------------------------------------------
+*/
+static void cmd_printf(scommand cmd)
+{
+    scommand_pop_front(cmd);
+    status = printf_run(cmd);
+}
+
+/*
+------------------------------------------------------------------
+* Función encargada de mostrar los procesos en ejecución (EXTRA)
+     -- la lectura de /proc y las opciones están en ps.c --
+------------------------------------------------------------------
+*/
+static void cmd_ps(scommand cmd)
+{
+    scommand_pop_front(cmd);
+    status = ps_run(cmd);
+}
+
+/*
+------------------------------------------------------------------
+*    Función encargada de mandar señales a procesos (EXTRA)
+  -- acepta pids y trabajos (%N); todo está en kill.c --
+------------------------------------------------------------------
+*/
+static void cmd_kill(scommand cmd)
+{
+    scommand_pop_front(cmd);
+    status = kill_run(cmd);
+}
+
+/*
+------------------------------------------------------------------
+*    Función encargada de mandar señales a procesos por nombre (EXTRA)
+       -- los procesos se eligen con la lectura de /proc de ps --
+------------------------------------------------------------------
+*/
+static void cmd_pkill(scommand cmd)
+{
+    scommand_pop_front(cmd);
+    status = pkill_run(cmd);
+}
+
+/*
+------------------------------------------------------------------
+*    Función encargada de mostrar una variable como NOMBRE=valor
+     -- el valor sale de forma que se pueda volver a ingresar --
+------------------------------------------------------------------
+*/
+static void print_variable(const char *prefix, const char *name)
+{
+    char *value = vars_format(name);
+    if (value == NULL)
+    {
+        printf("%s%s\n", prefix, name);
+        return;
+    }
+    printf("%s%s=%s\n", prefix, name, value);
+    g_free(value);
+}
+
+/*
+------------------------------------------------------------------
+*    Función encargada de separar una asignación NOMBRE[i]=valor
+  -- corta `arg' en su lugar; `subscript' queda en NULL si no
+               tiene [i]. Devuelve false si no hay '=' --
+------------------------------------------------------------------
+*/
+static bool split_assignment(char *arg, char **subscript, char **value)
+{
+    char *equals = strchr(arg, '=');
+    if (equals == NULL)
+    {
+        return false;
+    }
+    *equals = '\0';
+    *value = equals + 1;
+    *subscript = strchr(arg, '[');
+    if (*subscript != NULL && equals[-1] == ']')
+    {
+        **subscript = '\0';
+        equals[-1] = '\0';
+        (*subscript)++;
+    }
+    return true;
+}
+
+/*
+------------------------------------------------------------------
+*    Función encargada de mostrar las variables que tienen `flags'
+------------------------------------------------------------------
+*/
+static void print_variables(const char *prefix, unsigned int flags)
+{
+    const char **names = vars_names(flags);
+    for (unsigned int i = 0; names[i] != NULL; i++)
+    {
+        print_variable(prefix, names[i]);
+    }
+    g_free(names);
+}
+
+/*
+------------------------------------------------------------------
+*    Función encargada de exportar variables (EXTRA)
+  -- export NOMBRE[=valor]...; con -n deja de exportarlas y sin
+            argumentos muestra las exportadas --
+------------------------------------------------------------------
+*/
+static void cmd_export(scommand cmd)
+{
+    scommand_pop_front(cmd);
+    bool exported = true;
+    if (!scommand_is_empty(cmd) && strcmp(scommand_front(cmd), "-n") == 0)
     {
-        printf("%s ", scommand_front(cmd));
+        exported = false;
         scommand_pop_front(cmd);
     }
-    printf("\n");
+    if (scommand_is_empty(cmd))
+    {
+        print_variables("declare -x ", VAR_EXPORTED);
+        return;
+    }
+    for (; !scommand_is_empty(cmd); scommand_pop_front(cmd))
+    {
+        char *arg = scommand_front(cmd);
+        char *equals = strchr(arg, '=');
+        if (!vars_valid_name(arg, (equals != NULL) ? (size_t)(equals - arg) : strlen(arg)))
+        {
+            fprintf(stderr, "export: `%s': not a valid identifier\n", arg);
+            status = EXIT_FAILURE;
+            continue;
+        }
+        if (equals != NULL)
+        {
+            *equals = '\0';
+            vars_set(arg, equals + 1);
+        }
+        vars_export(arg, exported);
+    }
 }
+
 /*
 ------------------------------------------------------------------
-* Función encargada de mostrar los procesos en ejecución (EXTRA)
+*    Función encargada de borrar variables (EXTRA)
 ------------------------------------------------------------------
 */
-static void cmd_ps(scommand cmd)
+static void cmd_unset(scommand cmd)
 {
-    DIR *proc_dir;                     // Directorio de /proc
-    struct dirent *entry;              // Entrada de directorio
-    char path[PATH_MAX], cmdline[256]; // Buffer para el path y el comando
-    FILE *fp;                          // File pointer
-    /* Abrir el directorio /proc */
-    proc_dir = opendir("/proc");
-    if (!proc_dir)
+    for (scommand_pop_front(cmd); !scommand_is_empty(cmd); scommand_pop_front(cmd))
     {
-        perror("opendir");
+        char *name = scommand_front(cmd);
+        char *subscript = strchr(name, '[');
+        if (subscript != NULL && g_str_has_suffix(subscript, "]"))
+        {
+            // unset a[i] borra solo ese elemento
+            *subscript++ = '\0';
+            subscript[strlen(subscript) - 1] = '\0';
+        }
+        if (vars_valid_name(name, strlen(name)) && subscript != NULL)
+        {
+            vars_unset_element(name, subscript);
+        }
+        else if (vars_valid_name(name, strlen(name)))
+        {
+            vars_unset(name);
+        }
+        else
+        {
+            fprintf(stderr, "unset: `%s': not a valid identifier\n", name);
+            status = EXIT_FAILURE;
+        }
+    }
+}
+
+/*
+------------------------------------------------------------------
+*    Función encargada de mostrar o definir variables (EXTRA)
+  -- sin argumentos muestra todas; set NOMBRE=valor... define
+          variables locales (no llegan a los comandos) --
+------------------------------------------------------------------
+*/
+static void cmd_set(scommand cmd)
+{
+    scommand_pop_front(cmd);
+    if (scommand_is_empty(cmd))
+    {
+        print_variables("", VAR_LOCAL);
+        return;
+    }
+    for (; !scommand_is_empty(cmd); scommand_pop_front(cmd))
+    {
+        char *arg = scommand_front(cmd), *subscript, *value;
+        if (!split_assignment(arg, &subscript, &value))
+        {
+            fprintf(stderr, "set: usage: set [name[index]=value ...]\n");
+            status = EXIT_FAILURE;
+            return;
+        }
+        if (!vars_set_element(arg, subscript, value))
+        {
+            fprintf(stderr, "set: `%s': not a valid identifier or index\n", arg);
+            status = EXIT_FAILURE;
+        }
+    }
+}
+
+/*
+------------------------------------------------------------------
+*    Función encargada de declarar arreglos (EXTRA)
+  -- declare -a NOMBRE... (indexados) o -A NOMBRE... (asociativos);
+           sin opciones muestra las variables, como set --
+------------------------------------------------------------------
+*/
+static void cmd_declare(scommand cmd)
+{
+    scommand_pop_front(cmd);
+    if (scommand_is_empty(cmd))
+    {
+        print_variables("", VAR_LOCAL);
+        return;
+    }
+    const char *option = scommand_front(cmd);
+    if (strcmp(option, "-a") != 0 && strcmp(option, "-A") != 0)
+    {
+        fprintf(stderr, "declare: usage: declare [-a | -A] name...\n");
+        status = EXIT_FAILURE;
         return;
     }
-    printf("\033[0;31mPID\tCOMMAND\033[0m\n");
-    printf("===\t=======\n");
-    /* Leer el directorio /proc */
-    while ((entry = readdir(proc_dir)) != NULL)
+    unsigned int kind = (option[1] == 'a') ? VAR_INDEXED : VAR_ASSOC;
+    for (scommand_pop_front(cmd); !scommand_is_empty(cmd); scommand_pop_front(cmd))
     {
-        /* Si el nombre del directorio es un número, es un proceso */
-        if (entry->d_type == DT_DIR && strspn(entry->d_name, "0123456789") == strlen(entry->d_name))
+        if (!vars_declare(scommand_front(cmd), kind))
         {
-            snprintf(path, sizeof(path), "/proc/%s/cmdline", entry->d_name);
-            /* Leer el comando del proceso */
-            fp = fopen(path, "r");
-            if (fp)
-            {
-                if (fgets(cmdline, sizeof(cmdline), fp) != NULL)
-                {
-                    printf("%s\t%s\n", entry->d_name, cmdline[0] ? cmdline : "[kernel process]"); // Imprimir el PID y el comando
-                }
-                fclose(fp); // Cerrar el archivo
-            }
+            fprintf(stderr, "declare: %s: cannot declare (invalid name, or already the other kind of array)\n",
+                    scommand_front(cmd));
+            status = EXIT_FAILURE;
         }
     }
+}
+
+/*
+------------------------------------------------------------------
+*    Función encargada de cargar las líneas de un archivo en un
+*    arreglo (EXTRA)
+   -- lee de a bloques grandes; todo está en mapfile.c --
+------------------------------------------------------------------
+*/
+static void cmd_mapfile(scommand cmd)
+{
+    scommand_pop_front(cmd);
+    status = mapfile_run(cmd);
+}
+
+/*
+------------------------------------------------------------------
+*    Función encargada de leer una línea y repartirla entre
+*    variables (EXTRA)
+   -- en archivos lee de a bloques y devuelve lo leído de más;
+                      todo está en read.c --
+------------------------------------------------------------------
+*/
+static void cmd_read(scommand cmd)
+{
+    scommand_pop_front(cmd);
+    // al final del archivo falla, así "while read" termina
+    status = read_run(cmd) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
 
-    closedir(proc_dir);
+/*
+------------------------------------------------------------------
+*    Función encargada de ejecutar un comando en tandas que
+*    entren en ARG_MAX (EXTRA)
+   -- como xargs; los argumentos llegan sin expandir y batch
+          los expande a medida que arma las tandas --
+------------------------------------------------------------------
+*/
+static void cmd_batch(scommand cmd)
+{
+    scommand_pop_front(cmd);
+    status = batch_run(cmd);
+}
+
+/*
+------------------------------------------------------------------
+*    Función encargada de mostrar el historial de comandos (EXTRA)
+  -- con -s <patrón> muestra la entrada más reciente que lo contiene --
+------------------------------------------------------------------
+*/
+static void cmd_history(scommand cmd)
+{
+    scommand_pop_front(cmd);
+    if (scommand_is_empty(cmd))
+    {
+        for (unsigned int i = 0; i < history_length(); i++)
+        {
+            printf("%5u  %s\n", i + 1, history_get(i));
+        }
+        return;
+    }
+    if (strcmp(scommand_front(cmd), "-s") != 0)
+    {
+        fprintf(stderr, "history: usage: history [-s pattern]\n");
+        status = EXIT_FAILURE;
+        return;
+    }
+    scommand_pop_front(cmd);
+    if (scommand_is_empty(cmd))
+    {
+        fprintf(stderr, "history: -s: pattern required\n");
+        status = EXIT_FAILURE;
+        return;
+    }
+    // el parser separa el patrón en palabras, lo volvemos a unir con espacios
+    char pattern[PATH_MAX] = "";
+    while (!scommand_is_empty(cmd))
+    {
+        strncat(pattern, scommand_front(cmd), sizeof(pattern) - strlen(pattern) - 2);
+        scommand_pop_front(cmd);
+        if (!scommand_is_empty(cmd))
+        {
+            strcat(pattern, " ");
+        }
+    }
+    // la entrada más reciente es esta misma invocación, no la tenemos en cuenta
+    unsigned int index, before = history_length() > 0 ? history_length() - 1 : 0;
+    if (history_search_before(pattern, before, &index))
+    {
+        printf("%5u  %s\n", index + 1, history_get(index));
+    }
+    else
+    {
+        fprintf(stderr, "history: no match for: %s\n", pattern);
+        status = EXIT_FAILURE;
+    }
 }
 
 static const Command internal_commands[] = {
@@ -268,25 +598,47 @@ static const Command internal_commands[] = {
     {"cowsay", cmd_cowsay},
     {"pwd", cmd_pwd},
     {"echo", cmd_echo},
+    {"printf", cmd_printf},
     {"ps", cmd_ps},
+    {"history", cmd_history},
+    {"kill", cmd_kill},
+    {"pkill", cmd_pkill},
+    {"export", cmd_export},
+    {"unset", cmd_unset},
+    {"set", cmd_set},
+    {"declare", cmd_declare},
+    {"mapfile", cmd_mapfile},
+    {"read", cmd_read},
+    {"batch", cmd_batch},
     {NULL, NULL}};
 
+_Static_assert(sizeof(internal_commands) / sizeof(internal_commands[0]) - 1 == BUILTIN_COUNT,
+               "builtin_hash.h no coincide con internal_commands");
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de buscar un comando interno por nombre
+  -- el hash perfecto lleva cada nombre interno a una posición distinta, así que basta con
+             un hash y una comparación para saber si `name' es uno de ellos --
+------------------------------------------------------------------------------------------------
+*/
+static const Command *find_builtin(const char *name)
+{
+    unsigned char slot = builtin_slots[phash_slot(name, BUILTIN_HASH_SEED, BUILTIN_HASH_BITS)];
+    if (slot == 0 || strcmp(name, internal_commands[slot - 1].name) != 0)
+    {
+        return NULL;
+    }
+    return &internal_commands[slot - 1];
+}
+
 bool builtin_is_internal(scommand cmd)
 {
     if (scommand_is_empty(cmd))
     {
         return false;
     }
-    char *command = scommand_front(cmd);
-    // buscamos si el comando ingresado está dentro de nuestro arreglo de comandos internos
-    for (int i = 0; internal_commands[i].name != NULL; i++)
-    {
-        if (strcmp(command, internal_commands[i].name) == 0)
-        {
-            return true;
-        }
-    }
-    return false;
+    return find_builtin(scommand_front(cmd)) != NULL;
 }
 
 bool builtin_alone(pipeline p)
@@ -298,19 +650,24 @@ bool builtin_alone(pipeline p)
     return (pipeline_length(p) == 1) && builtin_is_internal(pipeline_front(p));
 }
 
-void builtin_run(scommand cmd)
+const char *builtin_name(unsigned int i)
+{
+    return (i < BUILTIN_COUNT) ? internal_commands[i].name : NULL;
+}
+
+int builtin_run(scommand cmd)
 {
     assert(builtin_is_internal(cmd));
     char *command = scommand_front(cmd);
     // ejecutamos la función del comando ingresado, en caso de que esté dentro de nuestro arreglo de comandos internos
-    for (int i = 0; internal_commands[i].name != NULL; i++)
+    const Command *builtin = find_builtin(command);
+    if (builtin != NULL)
     {
-        if (strcmp(command, internal_commands[i].name) == 0)
-        {
-            internal_commands[i].func(cmd);
-            return;
-        }
+        status = EXIT_SUCCESS;
+        builtin->func(cmd);
+        return status;
     }
     // caso en el que ingresamos un comando que no existe
     fprintf(stderr, "Command not found: %s\n", command);
+    return BUILTIN_NOT_FOUND;
 }
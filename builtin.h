@@ -29,9 +29,22 @@ bool builtin_alone(pipeline p);
  *
  */
 
-void builtin_run(scommand cmd);
+const char *builtin_name(unsigned int i);
+/*
+ * Devuelve el nombre del comando interno número `i', o NULL si `i' es mayor
+ * o igual a la cantidad de comandos internos. Sirve para recorrerlos:
+ *
+ * for (unsigned int i = 0; builtin_name(i) != NULL; i++) { ... }
+ *
+ */
+
+#define BUILTIN_NOT_FOUND 127 // estado de salida de un comando que no existe (como en bash)
+#define BUILTIN_CANNOT_EXECUTE 126 // estado de salida de un comando que existe pero no se puede ejecutar
+
+int builtin_run(scommand cmd);
 /*
  * Ejecuta un comando interno
+ * Devuelve su estado de salida: EXIT_SUCCESS, o EXIT_FAILURE si falló
  *
  * REQUIRES: {builtin_is_internal(cmd)}
  *
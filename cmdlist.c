@@ -0,0 +1,75 @@
+#include <assert.h>
+#include <stdlib.h>
+
+#include "cmdlist.h"
+
+struct cmdlist_item
+{
+    pipeline pipe;
+    cmdlist_connector connector;
+};
+
+struct cmdlist_s
+{
+    struct cmdlist_item *items;
+    unsigned int length;
+    unsigned int allocated;
+};
+
+cmdlist cmdlist_new(void)
+{
+    cmdlist result = calloc(1, sizeof(struct cmdlist_s));
+    assert(result != NULL && cmdlist_is_empty(result));
+    return result;
+}
+
+cmdlist cmdlist_destroy(cmdlist self)
+{
+    assert(self != NULL);
+    for (unsigned int i = 0; i < self->length; i++)
+    {
+        pipeline_destroy(self->items[i].pipe);
+    }
+    free(self->items);
+    free(self);
+    return NULL;
+}
+
+void cmdlist_push_back(cmdlist self, pipeline pipe, cmdlist_connector connector)
+{
+    assert(self != NULL && pipe != NULL);
+    if (self->length == self->allocated)
+    {
+        self->allocated = (self->allocated > 0) ? 2 * self->allocated : 4;
+        self->items = realloc(self->items, self->allocated * sizeof(struct cmdlist_item));
+        assert(self->items != NULL);
+    }
+    // el primero no tiene anterior: se ejecuta siempre
+    self->items[self->length].pipe = pipe;
+    self->items[self->length].connector = (self->length > 0) ? connector : CMDLIST_ALWAYS;
+    self->length++;
+}
+
+bool cmdlist_is_empty(const cmdlist self)
+{
+    assert(self != NULL);
+    return self->length == 0;
+}
+
+unsigned int cmdlist_length(const cmdlist self)
+{
+    assert(self != NULL);
+    return self->length;
+}
+
+pipeline cmdlist_nth(const cmdlist self, unsigned int n)
+{
+    assert(self != NULL && n < self->length);
+    return self->items[n].pipe;
+}
+
+cmdlist_connector cmdlist_connector_nth(const cmdlist self, unsigned int n)
+{
+    assert(self != NULL && n < self->length);
+    return self->items[n].connector;
+}
@@ -0,0 +1,73 @@
+/* Listas de comandos: a && b || c ; d & e
+ * Secuencia de pipelines donde cada uno indica cómo se une con el anterior.
+ * && y || tienen la misma precedencia y se evalúan de izquierda a derecha,
+ * así que la lista plana ya es el árbol: cada pipeline se ejecuta o no según
+ * el estado de salida del último que se ejecutó.
+ *
+ * Una vez que un pipeline entra en la lista, la memoria pasa a ser propiedad
+ * del TAD (igual que los comandos simples de un pipeline).
+ */
+
+#ifndef CMDLIST_H
+#define CMDLIST_H
+
+#include <stdbool.h>
+
+#include "command.h"
+
+typedef enum
+{
+    CMDLIST_ALWAYS, // primer pipeline, o después de ';' o '&'
+    CMDLIST_AND,    // después de &&: solo si el anterior terminó bien (estado 0)
+    CMDLIST_OR      // después de ||: solo si el anterior falló
+} cmdlist_connector;
+
+typedef struct cmdlist_s *cmdlist;
+
+cmdlist cmdlist_new(void);
+/*
+ * Nueva lista, sin pipelines.
+ * Ensures: result != NULL && cmdlist_is_empty(result)
+ */
+
+cmdlist cmdlist_destroy(cmdlist self);
+/*
+ * Destruye `self' y todos sus pipelines.
+ * Requires: self != NULL
+ * Ensures: result == NULL
+ */
+
+void cmdlist_push_back(cmdlist self, pipeline pipe, cmdlist_connector connector);
+/*
+ * Agrega por detrás un pipeline, unido al anterior por `connector'.
+ *   pipe: el TAD se apropia del pipeline.
+ * Requires: self != NULL && pipe != NULL
+ * Ensures: !cmdlist_is_empty(self)
+ */
+
+bool cmdlist_is_empty(const cmdlist self);
+/*
+ * Requires: self != NULL
+ */
+
+unsigned int cmdlist_length(const cmdlist self);
+/*
+ * Cantidad de pipelines de la lista.
+ * Requires: self != NULL
+ */
+
+pipeline cmdlist_nth(const cmdlist self, unsigned int n);
+/*
+ * Devuelve el pipeline número `n' (el primero es el 0); sigue siendo
+ * propiedad del TAD.
+ * Requires: self != NULL && n < cmdlist_length(self)
+ */
+
+cmdlist_connector cmdlist_connector_nth(const cmdlist self, unsigned int n);
+/*
+ * Cómo se une el pipeline número `n' con el anterior (el 0 siempre es
+ * CMDLIST_ALWAYS).
+ * Requires: self != NULL && n < cmdlist_length(self)
+ */
+
+#endif /* CMDLIST_H */
@@ -9,6 +9,8 @@
 
 struct scommand_s {
     GSList* args;
+    GSList* last; // último nodo de args, para agregar por detrás sin recorrer la lista
+    unsigned int length;
     char* in_redir;
     char* out_redir;
 };
@@ -19,6 +21,8 @@ scommand scommand_new(void){
     scommand new_cmd = malloc (sizeof(struct scommand_s));
     assert(new_cmd != NULL);
     new_cmd->args = NULL;
+    new_cmd->last = NULL;
+    new_cmd->length = 0u;
     new_cmd->in_redir = NULL;
     new_cmd->out_redir = NULL;
     
@@ -49,7 +53,15 @@ scommand scommand_destroy(scommand self) {
 void scommand_push_back(scommand self, char * argument){
     
     assert(self!=NULL && argument!=NULL);
-    self->args = g_slist_append(self->args, argument); // Esta funcion agrega un elemento al final de la lista
+    // con g_slist_append cada palabra recorría toda la lista: un comando con 100.000 argumentos era cuadrático
+    GSList *node = g_slist_prepend(NULL, argument);
+    if (self->last == NULL) {
+        self->args = node;
+    } else {
+        self->last->next = node;
+    }
+    self->last = node;
+    self->length++;
     
 
 }
@@ -58,12 +70,22 @@ void scommand_pop_front(scommand self){
 
     assert(self!=NULL && !scommand_is_empty(self));
     
-    char* head = g_slist_nth_data(self->args, 0u); // Esta funcion devuelve el dato en la posicion 0 (front)
-    self->args = g_slist_remove(self->args, head); // Esta funcion elimina el dato en la posicion a la que apunta head
-    free(head); // Olvide liberar la memoria del dato eliminado, causante de los memory leaks en scommand
+    free(scommand_steal_front(self)); // Olvide liberar la memoria del dato eliminado, causante de los memory leaks en scommand
     
 }
 
+char *scommand_steal_front(scommand self){
+
+    assert(self!=NULL && !scommand_is_empty(self));
+
+    GSList *head = self->args;
+    char *front = head->data;
+    self->args = g_slist_delete_link(self->args, head); // se saca el nodo sin liberar la cadena
+    self->last = (self->args == NULL) ? NULL : self->last;
+    self->length--;
+    return front;
+}
+
 void scommand_set_redir_in(scommand self, char * filename){
     assert(self!=NULL);
     
@@ -85,8 +107,7 @@ bool scommand_is_empty(const scommand self){
 
 unsigned int scommand_length(const scommand self){
     assert(self!=NULL);
-    return (g_slist_length(self->args)); // Esta funcion devuelve el largo de la lista
-    //Notar que esta g_slist_length devuelve un guint, que es exactamente un unsigned int
+    return self->length; // se lleva la cuenta al agregar y sacar, así no hay que recorrer la lista
 }
 
 char * scommand_front(const scommand self){
@@ -96,6 +117,18 @@ char * scommand_front(const scommand self){
     return g_slist_nth_data(self->args, 0u);
 }
 
+char **scommand_argv(const scommand self){
+    assert(self!=NULL);
+
+    char **argv = calloc(self->length + 1, sizeof(char *));
+    assert(argv != NULL);
+    unsigned int i = 0;
+    for (GSList *node = self->args; node != NULL; node = node->next) {
+        argv[i++] = node->data;
+    }
+    return argv;
+}
+
 char * scommand_get_redir_in(const scommand self){
     assert(self!=NULL);
     return self->in_redir;
@@ -110,14 +143,10 @@ char *scommand_to_string(const scommand self) {
     assert(self != NULL);
     GString *gstr = g_string_new(NULL); // Crea un nuevo string vacío
     
-    // Tamaño de la lista a recorrer
-    unsigned int n = g_slist_length(self->args);
-    
-    for (unsigned int i = 0; i < n; i++) {
-        // dato en la pos i
-        char *data = (char *)g_slist_nth_data(self->args, i);
-        gstr = g_string_append(gstr, data);
-        if (i < n - 1) {
+    // se recorren los nodos de a uno (pedir el i-ésimo en cada vuelta era cuadrático)
+    for (GSList *node = self->args; node != NULL; node = node->next) {
+        gstr = g_string_append(gstr, node->data);
+        if (node->next != NULL) {
             gstr = g_string_append_c(gstr, ' ');
         }
     }
@@ -203,6 +232,11 @@ scommand pipeline_front(const pipeline self){
     return g_slist_nth_data(self->cmds, 0u);
 }
 
+scommand pipeline_nth(const pipeline self, unsigned int n){
+    assert(self != NULL && n < pipeline_length(self));
+    return g_slist_nth_data(self->cmds, n);
+}
+
 bool pipeline_get_wait(const pipeline self){
     assert(self != NULL);
     return self->fg;
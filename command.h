@@ -67,6 +67,16 @@ void scommand_pop_front(scommand self);
  * Requires: self!=NULL && !scommand_is_empty(self)
  */
 
+char * scommand_steal_front(scommand self);
+/*
+ * Quita la cadena de adelante de la secuencia de cadenas, sin liberarla.
+ *   self: comando simple al cual sacarle la cadena del frente.
+ *   Returns: la cadena del frente, que pasa a ser del llamador (liberar
+ *     con free()).
+ * Requires: self!=NULL && !scommand_is_empty(self)
+ * Ensures: result!=NULL
+ */
+
 void scommand_set_redir_in(scommand self, char * filename);
 void scommand_set_redir_out(scommand self, char * filename);
 /*
@@ -108,6 +118,17 @@ char * scommand_front(const scommand self);
  * Ensures: result!=NULL
  */
 
+char **scommand_argv(const scommand self);
+/*
+ * Devuelve las cadenas del comando simple en un arreglo terminado en NULL,
+ *   como lo pide execvp().
+ *   self: comando simple del cual tomar las cadenas.
+ *   Returns: arreglo a liberar con free(). Las cadenas siguen siendo
+ *     propiedad del TAD (igual que con scommand_front).
+ * Requires: self!=NULL
+ * Ensures: result!=NULL && result[scommand_length(self)]==NULL
+ */
+
 char * scommand_get_redir_in(const scommand self);
 char * scommand_get_redir_out(const scommand self);
 /*
@@ -227,6 +248,17 @@ scommand pipeline_front(const pipeline self);
  * Ensures: result!=NULL
  */
 
+scommand pipeline_nth(const pipeline self, unsigned int n);
+/*
+ * Devuelve el comando simple número `n' de la secuencia (el del frente es
+ * el 0), sin quitarlo.
+ *   self: pipeline a consultar.
+ *   n: posición del comando simple.
+ *   Returns: comando simple en la posición n. Sigue siendo propiedad del TAD.
+ * Requires: self!=NULL && n < pipeline_length(self)
+ * Ensures: result!=NULL
+ */
+
 bool pipeline_get_wait(const pipeline self);
 /*
  * Consulta si el pipeline tiene que esperar o no.
@@ -0,0 +1,434 @@
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <glib.h>
+
+#include "completion.h"
+#include "dircache.h"
+#include "builtin.h"
+
+#define WORD_BREAKS " \t|<>&;" // Caracteres que separan palabras
+#define COMMAND_BREAKS "|&;"   // Caracteres luego de los cuales empieza un comando
+
+// Directorio que el hilo de fondo tiene que leer
+struct scan_job
+{
+    char *key;        // identificador del pedido (tipo de listado + ruta)
+    bool executables; // ¿listar solo ejecutables?
+    dir_index index;  // a quién entregarle el listado, o NULL si solo hay que leerlo
+};
+
+static pthread_mutex_t jobs_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t jobs_ready = PTHREAD_COND_INITIALIZER; // hay pedidos para el hilo de fondo
+static pthread_cond_t jobs_done = PTHREAD_COND_INITIALIZER;  // terminó algún pedido
+static GQueue *jobs = NULL;                                  // pedidos sin atender
+static GHashTable *pending = NULL;                           // claves de pedidos en cola o en curso
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función que ejecuta el hilo de fondo: lee los directorios pedidos y los deja en dircache
+------------------------------------------------------------------------------------------------
+*/
+static void *scan_worker(void *arg)
+{
+    pthread_mutex_lock(&jobs_lock);
+    while (true)
+    {
+        while (g_queue_is_empty(jobs))
+        {
+            pthread_cond_wait(&jobs_ready, &jobs_lock);
+        }
+        struct scan_job *job = g_queue_pop_head(jobs);
+        pthread_mutex_unlock(&jobs_lock);
+
+        if (job->index != NULL)
+        {
+            // el listado pasa a ser de index(); solo se lee si no está en cache
+            job->index(job->key + 1, dircache_get(job->key + 1, job->executables, true));
+        }
+        else
+        {
+            dir_listing listing = dircache_scan(job->key + 1, job->executables);
+            if (listing != NULL)
+            {
+                dircache_release(listing);
+            }
+        }
+
+        pthread_mutex_lock(&jobs_lock);
+        g_hash_table_remove(pending, job->key);
+        pthread_cond_broadcast(&jobs_done);
+        free(job->key);
+        free(job);
+    }
+    return NULL;
+}
+
+static char *job_key(const char *path, bool executables, dir_index index)
+{
+    return g_strdup_printf("%c%s", (index != NULL) ? 'i' : executables ? 'x' : 'f', path);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de pedirle al hilo de fondo que lea un directorio
+            -- el hilo se crea con el primer pedido; los pedidos repetidos se ignoran --
+------------------------------------------------------------------------------------------------
+*/
+static void request_scan(const char *path, bool executables, dir_index index)
+{
+    char *key = job_key(path, executables, index);
+    pthread_mutex_lock(&jobs_lock);
+    if (jobs == NULL)
+    {
+        jobs = g_queue_new();
+        pending = g_hash_table_new(g_str_hash, g_str_equal);
+        pthread_t worker;
+        if (pthread_create(&worker, NULL, scan_worker, NULL) == 0)
+        {
+            pthread_detach(worker);
+        }
+    }
+    if (g_hash_table_contains(pending, key))
+    {
+        free(key);
+    }
+    else
+    {
+        struct scan_job *job = malloc(sizeof(struct scan_job));
+        assert(job != NULL);
+        job->key = key;
+        job->executables = executables;
+        job->index = index;
+        g_hash_table_add(pending, key);
+        g_queue_push_tail(jobs, job);
+        pthread_cond_signal(&jobs_ready);
+    }
+    pthread_mutex_unlock(&jobs_lock);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de esperar, como mucho hasta `deadline', un directorio pedido
+       -- devuelve NULL si no existe o si no llegó a leerse (en ese caso marca partial) --
+------------------------------------------------------------------------------------------------
+*/
+static dir_listing wait_listing(const char *path, bool executables,
+                                const struct timespec *deadline, bool *partial)
+{
+    char *key = job_key(path, executables, NULL);
+    pthread_mutex_lock(&jobs_lock);
+    while (g_hash_table_contains(pending, key) &&
+           pthread_cond_timedwait(&jobs_done, &jobs_lock, deadline) != ETIMEDOUT)
+    {
+    }
+    bool still_pending = g_hash_table_contains(pending, key);
+    pthread_mutex_unlock(&jobs_lock);
+    free(key);
+    if (still_pending)
+    {
+        *partial = true;
+        return NULL;
+    }
+    return dircache_get(path, executables, false);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de obtener varios listados sin bloquear más de COMPLETION_TIMEOUT_MS
+  -- primero se piden todos los que faltan, así el hilo de fondo los lee mientras esperamos --
+------------------------------------------------------------------------------------------------
+*/
+static GPtrArray *fetch_listings(char **paths, bool executables, bool *partial)
+{
+    GPtrArray *listings = g_ptr_array_new();
+    for (unsigned int i = 0; paths[i] != NULL; i++)
+    {
+        dir_listing listing = dircache_get(paths[i], executables, false);
+        if (listing == NULL)
+        {
+            request_scan(paths[i], executables, NULL);
+        }
+        g_ptr_array_add(listings, listing);
+    }
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += COMPLETION_TIMEOUT_MS * 1000000L;
+    deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+    deadline.tv_nsec %= 1000000000L;
+    for (unsigned int i = 0; paths[i] != NULL; i++)
+    {
+        if (g_ptr_array_index(listings, i) == NULL)
+        {
+            g_ptr_array_index(listings, i) = wait_listing(paths[i], executables, &deadline, partial);
+        }
+    }
+    return listings;
+}
+
+static void release_listings(GPtrArray *listings)
+{
+    for (unsigned int i = 0; i < listings->len; i++)
+    {
+        if (g_ptr_array_index(listings, i) != NULL)
+        {
+            dircache_release(g_ptr_array_index(listings, i));
+        }
+    }
+    g_ptr_array_free(listings, TRUE);
+}
+
+void completion_prefetch(void)
+{
+    char **dirs = dircache_path();
+    for (unsigned int i = 0; dirs[i] != NULL; i++)
+    {
+        request_scan(dirs[i], true, NULL);
+    }
+    g_strfreev(dirs);
+}
+
+void completion_index_path(const char *path, dir_index index)
+{
+    assert(path != NULL && index != NULL);
+    request_scan(path, true, index);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de acortar `common' al prefijo que comparte con `name'
+------------------------------------------------------------------------------------------------
+*/
+static void common_prefix(GString *common, bool *first, const char *name)
+{
+    if (*first)
+    {
+        g_string_assign(common, name);
+        *first = false;
+        return;
+    }
+    size_t len = 0;
+    while (len < common->len && common->str[len] == name[len])
+    {
+        len++;
+    }
+    g_string_truncate(common, len);
+}
+
+static gint compare_names(gconstpointer a, gconstpointer b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de completar nombres de comandos (internos y de $PATH)
+------------------------------------------------------------------------------------------------
+*/
+static void complete_command(completion *result, const char *word)
+{
+    GHashTable *seen = g_hash_table_new(g_str_hash, g_str_equal);
+    for (unsigned int i = 0; builtin_name(i) != NULL; i++)
+    {
+        if (g_str_has_prefix(builtin_name(i), word))
+        {
+            g_hash_table_add(seen, (gpointer)builtin_name(i));
+        }
+    }
+    char **dirs = dircache_path();
+    GPtrArray *listings = fetch_listings(dirs, true, &result->partial);
+    for (unsigned int d = 0; d < listings->len; d++)
+    {
+        dir_listing listing = g_ptr_array_index(listings, d);
+        if (listing == NULL)
+        {
+            continue;
+        }
+        unsigned int first, last;
+        dir_listing_prefix_range(listing, word, &first, &last);
+        for (unsigned int i = first; i < last; i++)
+        {
+            g_hash_table_add(seen, (gpointer)dir_listing_name(listing, i));
+        }
+    }
+
+    // los nombres se ordenan antes de mostrarlos; los listados siguen vivos hasta copiarlos
+    GPtrArray *names = g_ptr_array_sized_new(g_hash_table_size(seen));
+    GHashTableIter iter;
+    gpointer name;
+    g_hash_table_iter_init(&iter, seen);
+    while (g_hash_table_iter_next(&iter, &name, NULL))
+    {
+        g_ptr_array_add(names, name);
+    }
+    g_ptr_array_sort(names, compare_names);
+
+    GString *common = g_string_new(word);
+    bool first = true;
+    result->count = names->len;
+    unsigned int shown = MIN(names->len, (unsigned int)COMPLETION_MAX_SHOWN);
+    result->matches = calloc(shown + 1, sizeof(char *));
+    for (unsigned int i = 0; i < names->len; i++)
+    {
+        common_prefix(common, &first, g_ptr_array_index(names, i));
+        if (i < shown)
+        {
+            result->matches[i] = strdup(g_ptr_array_index(names, i));
+        }
+    }
+    result->common = g_string_free(common, FALSE);
+
+    g_ptr_array_free(names, TRUE);
+    g_hash_table_destroy(seen);
+    release_listings(listings);
+    g_strfreev(dirs);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de completar nombres de archivos
+  -- se completa el último componente de la ruta; los ocultos solo si se escribió el punto --
+------------------------------------------------------------------------------------------------
+*/
+static void complete_file(completion *result, const char *word)
+{
+    const char *slash = strrchr(word, '/');
+    size_t dir_len = (slash != NULL) ? (size_t)(slash - word) + 1 : 0;
+    const char *base = word + dir_len;
+    char *dir;
+    if (dir_len == 0)
+    {
+        dir = strdup(".");
+    }
+    else if (word[0] == '~' && word[1] == '/' && getenv("HOME") != NULL)
+    {
+        dir = g_strdup_printf("%s%.*s", getenv("HOME"), (int)dir_len - 1, word + 1);
+    }
+    else
+    {
+        dir = strndup(word, dir_len);
+    }
+
+    char *dirs[] = {dir, NULL};
+    GPtrArray *listings = fetch_listings(dirs, false, &result->partial);
+    dir_listing listing = g_ptr_array_index(listings, 0);
+
+    GString *common = g_string_new(NULL);
+    bool first = true;
+    GPtrArray *matches = g_ptr_array_new();
+    if (listing != NULL)
+    {
+        // los nombres están ordenados: las coincidencias son un rango, y los ocultos
+        // (que empiezan con '.') son otro rango que se saltea si no se pidieron
+        unsigned int from, to, hidden_from = 0, hidden_to = 0;
+        dir_listing_prefix_range(listing, base, &from, &to);
+        if (base[0] != '.')
+        {
+            dir_listing_prefix_range(listing, ".", &hidden_from, &hidden_to);
+        }
+        if (hidden_from < from || hidden_to > to)
+        {
+            hidden_from = hidden_to = from; // los ocultos no caen dentro del rango
+        }
+        for (unsigned int i = from; i < to && result->count < COMPLETION_MAX_SHOWN; i++)
+        {
+            if (i == hidden_from && hidden_to > hidden_from)
+            {
+                i = hidden_to - 1;
+                continue;
+            }
+            g_ptr_array_add(matches, g_strdup_printf("%s%s", dir_listing_name(listing, i),
+                                                     dir_listing_is_dir(listing, i) ? "/" : ""));
+            result->is_dir = dir_listing_is_dir(listing, i);
+            result->count++;
+        }
+        result->count = (to - from) - (hidden_to - hidden_from);
+        if (result->count > 0)
+        {
+            // el prefijo común de un rango ordenado es el de su primer y su último nombre
+            unsigned int start = (hidden_from == from) ? hidden_to : from;
+            unsigned int last = (hidden_to == to) ? hidden_from - 1 : to - 1;
+            common_prefix(common, &first, dir_listing_name(listing, start));
+            common_prefix(common, &first, dir_listing_name(listing, last));
+        }
+    }
+    if (result->count == 0)
+    {
+        result->common = strdup(word);
+    }
+    else
+    {
+        g_string_prepend_len(common, word, dir_len);
+        if (result->count == 1 && result->is_dir)
+        {
+            g_string_append_c(common, '/');
+        }
+        result->common = g_string_free(common, FALSE);
+        common = NULL;
+    }
+    g_ptr_array_add(matches, NULL);
+    result->matches = (char **)g_ptr_array_free(matches, FALSE);
+
+    if (common != NULL)
+    {
+        g_string_free(common, TRUE);
+    }
+    release_listings(listings);
+    free(dir);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de decidir si la palabra que empieza en `start' es un comando
+       -- lo es si es la primera de la línea o si viene después de |, & o ; --
+------------------------------------------------------------------------------------------------
+*/
+static bool is_command_position(const char *line, size_t start)
+{
+    while (start > 0 && (line[start - 1] == ' ' || line[start - 1] == '\t'))
+    {
+        start--;
+    }
+    return start == 0 || strchr(COMMAND_BREAKS, line[start - 1]) != NULL;
+}
+
+completion *completion_complete(const char *line, size_t cursor)
+{
+    assert(line != NULL && cursor <= strlen(line));
+    completion *result = calloc(1, sizeof(completion));
+    assert(result != NULL);
+    size_t start = cursor;
+    while (start > 0 && strchr(WORD_BREAKS, line[start - 1]) == NULL)
+    {
+        start--;
+    }
+    result->word_start = start;
+    char *word = strndup(line + start, cursor - start);
+    if (is_command_position(line, start) && strchr(word, '/') == NULL)
+    {
+        complete_command(result, word);
+        result->is_dir = false;
+    }
+    else
+    {
+        complete_file(result, word);
+    }
+    free(word);
+    return result;
+}
+
+void completion_destroy(completion *result)
+{
+    assert(result != NULL);
+    for (unsigned int i = 0; result->matches != NULL && result->matches[i] != NULL; i++)
+    {
+        free(result->matches[i]);
+    }
+    free(result->matches);
+    free(result->common);
+    free(result);
+}
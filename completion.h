@@ -0,0 +1,61 @@
+/* Completado de la palabra bajo el cursor (tecla Tab).
+ * En posición de comando se completan los comandos internos y los ejecutables
+ * de $PATH; en el resto, nombres de archivos. Los directorios se leen en un
+ * hilo aparte a través de dircache, y el completado espera como mucho
+ * COMPLETION_TIMEOUT_MS: lo que no llegó a leerse aparecerá en el próximo Tab.
+ */
+
+#ifndef COMPLETION_H
+#define COMPLETION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "dircache.h"
+
+#define COMPLETION_TIMEOUT_MS 100 // Espera máxima por directorios que aún no están en cache
+#define COMPLETION_MAX_SHOWN 512  // Máxima cantidad de coincidencias que se devuelven para mostrar
+
+typedef void (*dir_index)(const char *path, dir_listing listing);
+
+typedef struct
+{
+    size_t word_start;  // posición donde empieza la palabra completada
+    char *common;       // prefijo común más largo de todas las coincidencias
+    unsigned int count; // cantidad total de coincidencias
+    char **matches;     // las primeras coincidencias en orden (sin el directorio), terminadas en NULL
+    bool is_dir;        // si count == 1, ¿la única coincidencia es un directorio?
+    bool partial;       // ¿quedaron directorios sin leer al vencer la espera?
+} completion;
+
+completion *completion_complete(const char *line, size_t cursor);
+/*
+ * Completa la palabra de `line' que termina en la posición `cursor'.
+ *   Returns: resultado a liberar con completion_destroy(). Si no hubo
+ *     coincidencias, count == 0 y common es la palabra original.
+ * Requires: line != NULL && cursor <= strlen(line)
+ */
+
+void completion_destroy(completion *result);
+/*
+ * Libera un resultado de completion_complete().
+ * Requires: result != NULL
+ */
+
+void completion_prefetch(void);
+/*
+ * Pide al hilo de fondo que lea los directorios de $PATH, para que el primer
+ * Tab no tenga que esperarlos. No bloquea.
+ */
+
+void completion_index_path(const char *path, dir_index index);
+/*
+ * Pide al hilo de fondo el listado de ejecutables de `path' (leyéndolo solo
+ * si no está en cache) y que, ya en ese hilo, llame a index(path, listado).
+ * El listado es NULL si el directorio no existe; si no, index() se queda con
+ * la referencia y debe soltarla con dircache_release(). No bloquea, y un
+ * pedido igual que todavía no se atendió no se repite.
+ * Requires: path != NULL && index != NULL
+ */
+
+#endif /* COMPLETION_H */
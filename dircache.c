@@ -0,0 +1,314 @@
+#include <assert.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <glib.h>
+
+#include "dircache.h"
+#include "getdents.h"
+
+#define RACY_NSEC (20 * 1000000L) // un mtime tan cerca del momento de leer no alcanza para saber si cambió
+
+struct dir_entry
+{
+    const char *name;
+    bool is_dir;
+};
+
+struct dir_listing_s
+{
+    int refs;                  // referencias vivas (el cache tiene una mientras lo guarda)
+    struct timespec mtime;     // mtime del directorio al momento de leerlo
+    bool racy;                 // el mtime era casi el de ese momento: otro cambio podía dejarlo igual
+    dev_t dev;                 // identidad del directorio, por si lo reemplazan
+    ino_t ino;
+    unsigned int count;        // cantidad de nombres
+    struct dir_entry *entries; // nombres ordenados
+    char *names;               // bloque contiguo donde viven los nombres
+};
+
+// ruta (con un prefijo que indica el tipo de listado) -> dir_listing
+static GHashTable *cache = NULL;
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static char *cache_key(const char *path, bool executables)
+{
+    return g_strdup_printf("%c%s", executables ? 'x' : 'f', path);
+}
+
+static void listing_free(dir_listing listing)
+{
+    free(listing->entries);
+    free(listing->names);
+    free(listing);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de soltar una referencia, liberando el listado con la última
+                -- debe llamarse con cache_lock tomado --
+------------------------------------------------------------------------------------------------
+*/
+static void listing_unref_locked(gpointer data)
+{
+    dir_listing listing = data;
+    if (--listing->refs == 0)
+    {
+        listing_free(listing);
+    }
+}
+
+static int entry_compare(const void *a, const void *b)
+{
+    return strcmp(((const struct dir_entry *)a)->name, ((const struct dir_entry *)b)->name);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de decidir si una entrada va al listado
+  -- d_type evita un stat() por archivo; solo se consulta el inodo cuando no alcanza --
+------------------------------------------------------------------------------------------------
+*/
+static bool entry_accept(int dirfd, const struct linux_dirent64 *d, bool executables, bool *is_dir)
+{
+    struct stat st;
+    *is_dir = (d->d_type == DT_DIR);
+    if (d->d_type == DT_LNK || d->d_type == DT_UNKNOWN)
+    {
+        *is_dir = fstatat(dirfd, d->d_name, &st, 0) == 0 && S_ISDIR(st.st_mode);
+    }
+    if (!executables)
+    {
+        return true;
+    }
+    return !*is_dir && d->d_type != DT_FIFO && d->d_type != DT_SOCK &&
+           faccessat(dirfd, d->d_name, X_OK, 0) == 0;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de decidir si un mtime es demasiado reciente para confiar en él
+  -- el kernel guarda los tiempos con la resolución del tick: un archivo creado en el mismo
+          tick que la lectura no cambiaría el mtime, y el listado quedaría viejo --
+------------------------------------------------------------------------------------------------
+*/
+static bool is_racy(const struct timespec *mtime)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    long long elapsed = (long long)(now.tv_sec - mtime->tv_sec) * 1000000000LL + (now.tv_nsec - mtime->tv_nsec);
+    return elapsed < RACY_NSEC;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de leer un directorio completo con getdents64
+  -- los nombres se copian a un único bloque y recién al final se arman los punteros --
+------------------------------------------------------------------------------------------------
+*/
+static dir_listing listing_read(const char *path, bool executables)
+{
+    int fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    bool racy = is_racy(&st.st_mtim);
+    GString *names = g_string_sized_new(GETDENTS_BUFFER);
+    GArray *offsets = g_array_new(FALSE, FALSE, sizeof(size_t));
+    GArray *dirs = g_array_new(FALSE, FALSE, sizeof(bool));
+    char *buffer = malloc(GETDENTS_BUFFER);
+    long nread;
+    while ((nread = syscall(SYS_getdents64, fd, buffer, GETDENTS_BUFFER)) > 0)
+    {
+        for (long pos = 0; pos < nread;)
+        {
+            struct linux_dirent64 *d = (struct linux_dirent64 *)(buffer + pos);
+            pos += d->d_reclen;
+            bool is_dir;
+            if (strcmp(d->d_name, ".") == 0 || strcmp(d->d_name, "..") == 0 ||
+                !entry_accept(fd, d, executables, &is_dir))
+            {
+                continue;
+            }
+            size_t offset = names->len;
+            g_string_append_len(names, d->d_name, strlen(d->d_name) + 1);
+            g_array_append_val(offsets, offset);
+            g_array_append_val(dirs, is_dir);
+        }
+    }
+    free(buffer);
+    close(fd);
+
+    dir_listing listing = malloc(sizeof(struct dir_listing_s));
+    assert(listing != NULL);
+    listing->refs = 1;
+    listing->mtime = st.st_mtim;
+    listing->racy = racy;
+    listing->dev = st.st_dev;
+    listing->ino = st.st_ino;
+    listing->count = offsets->len;
+    listing->names = g_string_free(names, FALSE);
+    listing->entries = malloc((listing->count + 1) * sizeof(struct dir_entry));
+    for (unsigned int i = 0; i < listing->count; i++)
+    {
+        listing->entries[i].name = listing->names + g_array_index(offsets, size_t, i);
+        listing->entries[i].is_dir = g_array_index(dirs, bool, i);
+    }
+    qsort(listing->entries, listing->count, sizeof(struct dir_entry), entry_compare);
+    g_array_free(offsets, TRUE);
+    g_array_free(dirs, TRUE);
+    return listing;
+}
+
+static bool listing_is_fresh(const dir_listing listing, const struct stat *st)
+{
+    return !listing->racy && listing->ino == st->st_ino && listing->dev == st->st_dev &&
+           listing->mtime.tv_sec == st->st_mtim.tv_sec &&
+           listing->mtime.tv_nsec == st->st_mtim.tv_nsec;
+}
+
+dir_listing dircache_scan(const char *path, bool executables)
+{
+    assert(path != NULL);
+    dir_listing listing = listing_read(path, executables);
+    if (listing == NULL)
+    {
+        return NULL;
+    }
+    pthread_mutex_lock(&cache_lock);
+    if (cache == NULL)
+    {
+        cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, listing_unref_locked);
+    }
+    listing->refs++; // una para el cache y otra para el llamador
+    g_hash_table_replace(cache, cache_key(path, executables), listing);
+    pthread_mutex_unlock(&cache_lock);
+    return listing;
+}
+
+dir_listing dircache_get(const char *path, bool executables, bool scan)
+{
+    assert(path != NULL);
+    struct stat st;
+    if (stat(path, &st) != 0)
+    {
+        return NULL;
+    }
+    dir_listing listing = NULL;
+    char *key = cache_key(path, executables);
+    pthread_mutex_lock(&cache_lock);
+    if (cache != NULL)
+    {
+        listing = g_hash_table_lookup(cache, key);
+        if (listing != NULL && listing_is_fresh(listing, &st))
+        {
+            listing->refs++;
+        }
+        else
+        {
+            listing = NULL;
+        }
+    }
+    pthread_mutex_unlock(&cache_lock);
+    g_free(key);
+
+    if (listing == NULL && scan)
+    {
+        listing = dircache_scan(path, executables);
+    }
+    return listing;
+}
+
+void dircache_release(dir_listing listing)
+{
+    assert(listing != NULL);
+    pthread_mutex_lock(&cache_lock);
+    listing_unref_locked(listing);
+    pthread_mutex_unlock(&cache_lock);
+}
+
+unsigned int dir_listing_length(const dir_listing listing)
+{
+    assert(listing != NULL);
+    return listing->count;
+}
+
+const char *dir_listing_name(const dir_listing listing, unsigned int i)
+{
+    assert(listing != NULL && i < listing->count);
+    return listing->entries[i].name;
+}
+
+bool dir_listing_is_dir(const dir_listing listing, unsigned int i)
+{
+    assert(listing != NULL && i < listing->count);
+    return listing->entries[i].is_dir;
+}
+
+void dir_listing_prefix_range(const dir_listing listing, const char *prefix,
+                              unsigned int *first, unsigned int *last)
+{
+    assert(listing != NULL && prefix != NULL && first != NULL && last != NULL);
+    size_t len = strlen(prefix);
+    // primer nombre >= prefix
+    unsigned int lo = 0, hi = listing->count;
+    while (lo < hi)
+    {
+        unsigned int mid = lo + (hi - lo) / 2;
+        if (strcmp(listing->entries[mid].name, prefix) < 0)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    *first = lo;
+    // primer nombre que ya no empieza con prefix
+    hi = listing->count;
+    while (lo < hi)
+    {
+        unsigned int mid = lo + (hi - lo) / 2;
+        if (strncmp(listing->entries[mid].name, prefix, len) == 0)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    *last = lo;
+}
+
+char **dircache_path(void)
+{
+    const char *path = getenv("PATH");
+    char **dirs = g_strsplit((path != NULL) ? path : "/usr/local/bin:/usr/bin:/bin", ":", -1);
+    for (unsigned int i = 0; dirs[i] != NULL; i++)
+    {
+        if (dirs[i][0] == '\0')
+        {
+            // un componente vacío de PATH significa el directorio actual
+            g_free(dirs[i]);
+            dirs[i] = g_strdup(".");
+        }
+    }
+    return dirs;
+}
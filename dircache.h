@@ -0,0 +1,79 @@
+/* Cache de listados de directorios.
+ * Cada listado se lee con getdents64, se guarda ordenado y se reutiliza
+ * mientras el mtime del directorio no cambie. Los listados son inmutables y
+ * se comparten con conteo de referencias, así que un hilo puede seguir usando
+ * uno mientras otro lo reemplaza por una versión más nueva.
+ * Un listado leído casi en el mismo momento en que cambió el directorio no
+ * se reutiliza: con la resolución de los mtime, un cambio posterior podría
+ * no notarse.
+ */
+
+#ifndef DIRCACHE_H
+#define DIRCACHE_H
+
+#include <stdbool.h>
+
+typedef struct dir_listing_s *dir_listing;
+
+dir_listing dircache_get(const char *path, bool executables, bool scan);
+/*
+ * Obtiene el listado del directorio `path'.
+ *   path: directorio a listar.
+ *   executables: si es true, el listado contiene solo los archivos que se
+ *     pueden ejecutar (pensado para los directorios de $PATH).
+ *   scan: si el listado no está en cache o quedó viejo, ¿leerlo ahora? Si es
+ *     false se devuelve NULL en ese caso, sin tocar el directorio más que
+ *     con un stat().
+ *   Returns: listado con una referencia que el llamador debe soltar con
+ *     dircache_release(), o NULL si no está disponible.
+ * Requires: path != NULL
+ * Es seguro llamarla desde varios hilos a la vez.
+ */
+
+dir_listing dircache_scan(const char *path, bool executables);
+/*
+ * Igual que dircache_get(path, executables, true), pero sin consultar el
+ * cache: siempre vuelve a leer el directorio y reemplaza la versión guardada.
+ */
+
+void dircache_release(dir_listing listing);
+/*
+ * Suelta una referencia obtenida con dircache_get() o dircache_scan().
+ * Requires: listing != NULL
+ */
+
+unsigned int dir_listing_length(const dir_listing listing);
+/*
+ * Cantidad de nombres del listado (sin contar "." y "..").
+ * Requires: listing != NULL
+ */
+
+const char *dir_listing_name(const dir_listing listing, unsigned int i);
+/*
+ * Nombre número `i' del listado. Los nombres están ordenados con strcmp().
+ *   Returns: cadena propiedad del listado.
+ * Requires: listing != NULL && i < dir_listing_length(listing)
+ */
+
+bool dir_listing_is_dir(const dir_listing listing, unsigned int i);
+/*
+ * Indica si el nombre número `i' es un directorio (siguiendo enlaces).
+ * Requires: listing != NULL && i < dir_listing_length(listing)
+ */
+
+void dir_listing_prefix_range(const dir_listing listing, const char *prefix,
+                              unsigned int *first, unsigned int *last);
+/*
+ * Busca los nombres que empiezan con `prefix'. Como están ordenados, forman
+ * un rango contiguo [*first, *last) que se encuentra con búsqueda binaria.
+ * Requires: listing != NULL && prefix != NULL && first != NULL && last != NULL
+ * Ensures: *first <= *last <= dir_listing_length(listing)
+ */
+
+char **dircache_path(void);
+/*
+ * Directorios de $PATH, en orden. Un componente vacío se devuelve como ".".
+ *   Returns: arreglo terminado en NULL, a liberar con g_strfreev().
+ */
+
+#endif /* DIRCACHE_H */
@@ -5,12 +5,20 @@
 #include <sys/wait.h> // permite usar wait()
 #include <fcntl.h>    // permite usar open() y otras constantes
 #include <string.h>   // permite usar strdup()
+#include <errno.h>    // permite distinguir por qué falló execvp()
+#include <glib.h>     // permite usar g_strdup_printf() y g_strfreev()
 
 #include "execute.h"            // contiene los prototipos de las funcines
 #include "command.h"            // definicion del tipo 'pipeline' y permite llamar a las funciones del TAD
 #include "builtin.h"            // permite llamar a las funciones de builtin
 #include "tests/syscall_mock.h" // requisito para pasar los tests
 #include "syntax.h"
+#include "dircache.h"           // permite obtener los directorios de $PATH
+#include "jobs.h"               // registra los pipelines en segundo plano
+#include "vars.h"               // arma el entorno de los hijos
+#include "batch.h"              // calcula si los argumentos entran en ARG_MAX
+
+extern char **environ;
 
 /*
  * Módulo que maneja el redireccionamiento de entrada ('<') del comando simple
@@ -64,11 +72,84 @@ static void execute_simple_command(scommand cmd)
     execvp(myargs[0], myargs); // ejecuta el comando con sus argumentos (si los hay)
 
     // el proceso no debe llegar hasta aqui de ejecutarse correctamente
+    // (el padre ya verificó que el comando existe y que sus argumentos entran, pero pudo cambiar en el medio)
+    if (errno == E2BIG)
+    {
+        fprintf(stderr, "%s: argument list too long\n", myargs[0]);
+        exit(BUILTIN_CANNOT_EXECUTE);
+    }
     printf("%s : command not found\n", myargs[0]);
-    suggest_command(myargs[0]);
     exit(EXIT_FAILURE);
 }
 
+/*
+ * Módulo que verifica, antes de crear procesos, que un comando se pueda ejecutar
+ * Busca en $PATH igual que execvp(); los comandos internos siempre existen
+ */
+static bool command_exists(scommand cmd)
+{
+    if (builtin_is_internal(cmd))
+    {
+        return true;
+    }
+    const char *name = scommand_front(cmd);
+    if (strchr(name, '/') != NULL)
+    { // una ruta no se busca en $PATH
+        return access(name, X_OK) == 0;
+    }
+    char **dirs = dircache_path();
+    bool found = false;
+    for (unsigned int i = 0; dirs[i] != NULL && !found; i++)
+    {
+        char *path = g_strdup_printf("%s/%s", dirs[i], name);
+        found = (access(path, X_OK) == 0);
+        g_free(path);
+    }
+    g_strfreev(dirs);
+    return found;
+}
+
+/*
+ * Módulo que verifica todos los comandos del 'pipeline' antes de ejecutarlo
+ * Informa y sugiere cada comando que no existe; si hay alguno, no se crea ningún proceso
+ */
+static bool pipeline_resolve(pipeline apipe)
+{
+    bool runnable = true;
+    for (unsigned int i = 0; i < pipeline_length(apipe); i++)
+    {
+        scommand cmd = pipeline_nth(apipe, i);
+        if (!command_exists(cmd))
+        {
+            printf("%s : command not found\n", scommand_front(cmd));
+            suggest_command(scommand_front(cmd));
+            runnable = false;
+        }
+    }
+    return runnable;
+}
+
+/*
+ * Módulo que verifica, antes de crear procesos, que los argumentos de cada comando externo entren en ARG_MAX
+ * (si no, execvp() fallaría con E2BIG); a un comando que no entra se le sugiere usar batch
+ */
+static bool pipeline_fits(pipeline apipe)
+{
+    bool fits = true;
+    for (unsigned int i = 0; i < pipeline_length(apipe) && fits; i++)
+    {
+        scommand cmd = pipeline_nth(apipe, i);
+        char **argv = scommand_argv(cmd);
+        fits = builtin_is_internal(cmd) || batch_fits(argv);
+        if (!fits)
+        {
+            fprintf(stderr, "%s: argument list too long (batch %s ... splits it)\n", argv[0], argv[0]);
+        }
+        free(argv);
+    }
+    return fits;
+}
+
 /*
  * Módulo encargado de redirigir la entrada del pipe
  */
@@ -103,16 +184,33 @@ static void descriptor_in_close(int descriptor_in)
     }
 }
 
+/*
+ * Módulo que traduce lo que devolvió waitpid() a un estado de salida como los de bash
+ * (el código de exit(), o 128 + la señal que terminó al proceso)
+ */
+static int exit_status(int wstatus)
+{
+    if (WIFSIGNALED(wstatus))
+    {
+        return 128 + WTERMSIG(wstatus);
+    }
+    return WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : EXIT_FAILURE;
+}
+
 /*
  * Módulo encargado de ejecutar los comandos externos
  * Itera el ciclo de ejecuciones por cada comando del 'pipeline'
+ * Devuelve el estado de salida del último comando (0 si quedó en segundo plano)
  */
-static void execute_external_command(pipeline apipe)
+static int execute_external_command(pipeline apipe)
 {
 
     unsigned int apipe_len = pipeline_length(apipe); // cuenta cuantos comandos hay separados por '|'
 
-    int *child_pid = malloc(apipe_len * sizeof(int)); // se crea un array para contener los 'process ID' de todos los 'child' creados
+    pid_t *child_pid = malloc(apipe_len * sizeof(pid_t)); // se crea un array para contener los 'process ID' de todos los 'child' creados
+    char *command = pipeline_get_wait(apipe) ? NULL : pipeline_to_string(apipe); // texto del trabajo en segundo plano
+    char **envp = vars_environment(); // el mismo entorno para todos los hijos (solo se rearma si cambió algo exportado)
+    int wstatus = 0;                  // cómo terminó cada 'child'; el estado del pipeline es el del último
 
     // para conectar cada comando del pipeline se crean descriptores de archivos
     int descriptores[2];              // descriptores de archivo para el pipe
@@ -138,6 +236,8 @@ static void execute_external_command(pipeline apipe)
         else if (rc == 0) // rc == 0, significa que el proceso es el 'child'
         {
 
+            environ = envp; // execvp() le pasa environ al programa
+
             redirect_pipe_in(descriptor_in); // Redirección de la entrada del pipe (si no es el primer comando)
 
             if (i < apipe_len - 1)
@@ -145,6 +245,12 @@ static void execute_external_command(pipeline apipe)
                 redirect_pipe_out(descriptores);
             }
 
+            if (builtin_is_internal(pipeline_front(apipe)))
+            { // un comando interno dentro de un pipe corre en el hijo, como uno externo
+                redirection_in(scommand_get_redir_in(pipeline_front(apipe)));
+                redirection_out(scommand_get_redir_out(pipeline_front(apipe)));
+                exit(builtin_run(pipeline_front(apipe)));
+            }
             execute_simple_command(pipeline_front(apipe)); // obtiene el primer comando de 'apipe' y llama a la función para ejecutarlo
         }
 
@@ -172,17 +278,66 @@ static void execute_external_command(pipeline apipe)
 
         for (unsigned int j = 0; j < apipe_len; ++j) // se itera según la cantidad de comandos del 'pipeline'
 
-            waitpid(child_pid[j], NULL, 0); // se espera hasta que cada 'child' haya terminado su proceso.
+            waitpid(child_pid[j], &wstatus, 0); // se espera hasta que cada 'child' haya terminado su proceso.
+    }
+    else
+    { // en segundo plano: se registra el trabajo para poder usar "kill %N" y recoger sus procesos
+        if (g_str_has_suffix(command, " &"))
+        {
+            command[strlen(command) - 2] = '\0';
+        }
+        unsigned int job = jobs_add(child_pid, apipe_len, command);
+        if (isatty(STDIN_FILENO))
+        {
+            printf("[%u] %d\n", job, (int)child_pid[apipe_len - 1]);
+        }
     }
+    free(command);
+    free(child_pid);
+    return pipeline_get_wait(apipe) ? exit_status(wstatus) : EXIT_SUCCESS;
+}
+
+/*
+ * Módulo encargado de ejecutar un comando interno en el mismo shell
+ * Sus redirecciones valen solo mientras corre: los descriptores originales se guardan y se restauran
+ */
+static int execute_builtin(scommand cmd)
+{
+    int saved_in = -1, saved_out = -1;
+    if (scommand_get_redir_in(cmd) != NULL)
+    {
+        saved_in = dup(STDIN_FILENO);
+        redirection_in(scommand_get_redir_in(cmd));
+    }
+    if (scommand_get_redir_out(cmd) != NULL)
+    {
+        fflush(stdout); // lo que ya estaba en el buffer va a la salida de antes
+        saved_out = dup(STDOUT_FILENO);
+        redirection_out(scommand_get_redir_out(cmd));
+    }
+    int status = builtin_run(cmd);
+    if (saved_out >= 0)
+    {
+        fflush(stdout);
+        dup2(saved_out, STDOUT_FILENO);
+        close(saved_out);
+    }
+    if (saved_in >= 0)
+    {
+        dup2(saved_in, STDIN_FILENO);
+        close(saved_in);
+    }
+    return status;
 }
 
 /*
  * Ejecuta un 'pipeline', identificando comandos nulos, vacíos, internos o externos
  */
-void execute_pipeline(pipeline apipe)
+int execute_pipeline(pipeline apipe)
 {
     // Caso 1 - el 'pipeline' es NULL
     assert(apipe != NULL); // por consigna ' Requires: apipe!=NULL '
+    int status = EXIT_SUCCESS;
 
     // Caso 2 - el 'pipeline' es vacio
     if (!pipeline_is_empty(apipe)) // si el 'pipeline' esta vacio, termina la función, sólo lo ejecuta si tiene contenido
@@ -190,12 +345,23 @@ void execute_pipeline(pipeline apipe)
         // Caso 3 - el 'pipeline' es un comando simple presente en builtin.c
         if (builtin_alone(apipe))
         {
-            builtin_run(pipeline_front(apipe)); // y en ese caso, simplemente obtiene el comando y lo ejecuta el módulo builtin.c
+            status = execute_builtin(pipeline_front(apipe)); // y en ese caso, simplemente obtiene el comando y lo ejecuta el módulo builtin.c
         }
         // Caso 4 - el 'pipeline' es un comando externo
+        // (si algún comando no existe, se informa sin crear ningún proceso)
+        else if (!pipeline_resolve(apipe))
+        {
+            status = BUILTIN_NOT_FOUND;
+        }
+        // (tampoco si los argumentos de alguno no entran en ARG_MAX)
+        else if (!pipeline_fits(apipe))
+        {
+            status = BUILTIN_CANNOT_EXECUTE;
+        }
         else
         {
-            execute_external_command(apipe); // llamada a la función que ejecute los comandos externos (simples y múltiples)
+            status = execute_external_command(apipe); // llamada a la función que ejecute los comandos externos (simples y múltiples)
         }
     }
+    return status;
 }
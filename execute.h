@@ -8,12 +8,14 @@
 #include "command.h"
 
 
-void execute_pipeline(pipeline apipe);
+int execute_pipeline(pipeline apipe);
 /*
  * Ejecuta un pipeline, identificando comandos internos, forkeando, y
  *   redirigiendo la entrada y salida. puede modificar `apipe' en el proceso
  *   de ejecución.
  *   apipe: pipeline a ejecutar
+ *   Returns: estado de salida del último comando (0 si quedó en segundo
+ *     plano, 127 si algún comando no existe)
  * Requires: apipe!=NULL
  */
 
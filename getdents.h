@@ -0,0 +1,24 @@
+/* Lectura de directorios con getdents64.
+ * dircache, proc y treewalk leen los directorios con la llamada al sistema,
+ * de a GETDENTS_BUFFER bytes por vez, en lugar de usar readdir(): así
+ * reciben muchos nombres por llamada y no reservan un DIR por directorio.
+ */
+
+#ifndef GETDENTS_H
+#define GETDENTS_H
+
+#include <stdint.h>
+
+#define GETDENTS_BUFFER (64 * 1024) // Tamaño del buffer de cada llamada a getdents64
+
+// Registro que devuelve getdents64 (no está en los headers de glibc)
+struct linux_dirent64
+{
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+#endif
@@ -0,0 +1,294 @@
+#include <assert.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <glib.h>
+
+#include "highlight.h"
+#include "builtin.h"
+#include "dircache.h"
+
+#define WORD_BREAKS " \t|&;<>" // Caracteres que terminan una palabra
+#define OPERATORS "|&;"        // Operadores luego de los cuales empieza un comando
+#define REDIRECTIONS "<>"      // Operadores seguidos por un nombre de archivo
+#define RETRY_MS 50            // Cada cuánto se vuelve a mirar si ya se leyó $PATH
+
+/* Qué espera el lexer después de un token. Una redirección puede aparecer
+ * antes del comando ("< in cat"), así que al esperar su archivo también se
+ * recuerda si el comando ya apareció.
+ */
+typedef enum
+{
+    LEX_COMMAND,
+    LEX_ARGUMENT,
+    LEX_TARGET_BEFORE_COMMAND,
+    LEX_TARGET_AFTER_COMMAND
+} lexer_state;
+
+struct lexed_token
+{
+    highlight_token token;
+    lexer_state after; // estado del lexer al terminar este token
+};
+
+static GArray *tokens = NULL;            // tokens de la línea actual
+static GHashTable *known = NULL;         // comandos conocidos (las claves apuntan a los listados)
+static GPtrArray *known_listings = NULL; // listados de $PATH con los que se armó `known'
+static bool known_complete = false;      // ¿estaban en cache todos los listados de $PATH?
+static double known_time = 0;            // cuándo se armó `known' (en milisegundos)
+
+static bool is_word_break(char c)
+{
+    return c != '\0' && strchr(WORD_BREAKS, c) != NULL;
+}
+
+static void release_listings(GPtrArray *listings)
+{
+    for (unsigned int i = 0; i < listings->len; i++)
+    {
+        dircache_release(g_ptr_array_index(listings, i));
+    }
+    g_ptr_array_free(listings, TRUE);
+}
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static bool same_listings(GPtrArray *a, GPtrArray *b)
+{
+    if (a == NULL || b == NULL || a->len != b->len)
+    {
+        return false;
+    }
+    for (unsigned int i = 0; i < a->len; i++)
+    {
+        if (g_ptr_array_index(a, i) != g_ptr_array_index(b, i))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de actualizar el conjunto de comandos conocidos
+  -- solo se rearma si alguno de los listados de $PATH cambió desde la última vez --
+------------------------------------------------------------------------------------------------
+*/
+static void refresh_known(void)
+{
+    char **dirs = dircache_path();
+    GPtrArray *listings = g_ptr_array_new();
+    bool complete = true;
+    for (unsigned int i = 0; dirs[i] != NULL; i++)
+    {
+        dir_listing listing = dircache_get(dirs[i], true, false);
+        if (listing != NULL)
+        {
+            g_ptr_array_add(listings, listing);
+        }
+        else if (access(dirs[i], F_OK) == 0)
+        {
+            complete = false; // existe pero todavía no se leyó
+        }
+    }
+    g_strfreev(dirs);
+    known_complete = complete;
+    known_time = now_ms();
+
+    if (same_listings(listings, known_listings))
+    {
+        release_listings(listings);
+        return;
+    }
+    if (known != NULL)
+    {
+        g_hash_table_destroy(known);
+        release_listings(known_listings);
+    }
+    known = g_hash_table_new(g_str_hash, g_str_equal);
+    known_listings = listings;
+    for (unsigned int i = 0; builtin_name(i) != NULL; i++)
+    {
+        g_hash_table_add(known, (gpointer)builtin_name(i));
+    }
+    for (unsigned int d = 0; d < listings->len; d++)
+    {
+        dir_listing listing = g_ptr_array_index(listings, d);
+        for (unsigned int i = 0; i < dir_listing_length(listing); i++)
+        {
+            g_hash_table_add(known, (gpointer)dir_listing_name(listing, i));
+        }
+    }
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de clasificar la palabra en posición de comando
+    -- las rutas (con '/') no se verifican, para no tocar el disco mientras se escribe --
+------------------------------------------------------------------------------------------------
+*/
+static highlight_kind command_kind(const char *word, size_t len)
+{
+    char name[NAME_MAX + 1];
+    if (memchr(word, '/', len) != NULL)
+    {
+        return HL_ARGUMENT;
+    }
+    if (len <= NAME_MAX)
+    {
+        memcpy(name, word, len);
+        name[len] = '\0';
+        if (g_hash_table_contains(known, name))
+        {
+            return HL_COMMAND;
+        }
+    }
+    return known_complete ? HL_NOT_FOUND : HL_ARGUMENT;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de leer el token que empieza en `pos'
+                  -- devuelve la posición siguiente y actualiza el estado --
+------------------------------------------------------------------------------------------------
+*/
+static size_t lex_token(const char *line, size_t len, size_t pos, lexer_state *state,
+                        highlight_token *token)
+{
+    size_t end = pos + 1;
+    char c = line[pos];
+    if (c == ' ' || c == '\t')
+    {
+        while (end < len && (line[end] == ' ' || line[end] == '\t'))
+        {
+            end++;
+        }
+        token->kind = HL_BLANK;
+    }
+    else if (strchr(OPERATORS, c) != NULL)
+    {
+        token->kind = HL_OPERATOR;
+        *state = LEX_COMMAND;
+    }
+    else if (strchr(REDIRECTIONS, c) != NULL)
+    {
+        token->kind = HL_REDIRECTION;
+        *state = (*state == LEX_COMMAND || *state == LEX_TARGET_BEFORE_COMMAND)
+                     ? LEX_TARGET_BEFORE_COMMAND
+                     : LEX_TARGET_AFTER_COMMAND;
+    }
+    else
+    {
+        while (end < len && !is_word_break(line[end]))
+        {
+            end++;
+        }
+        switch (*state)
+        {
+        case LEX_COMMAND:
+            token->kind = command_kind(line + pos, end - pos);
+            *state = LEX_ARGUMENT;
+            break;
+        case LEX_TARGET_BEFORE_COMMAND:
+            token->kind = HL_REDIRECTION;
+            *state = LEX_COMMAND;
+            break;
+        case LEX_TARGET_AFTER_COMMAND:
+            token->kind = HL_REDIRECTION;
+            *state = LEX_ARGUMENT;
+            break;
+        default:
+            token->kind = HL_ARGUMENT;
+            break;
+        }
+    }
+    token->start = pos;
+    token->length = end - pos;
+    return end;
+}
+
+void highlight_reset(void)
+{
+    if (tokens == NULL)
+    {
+        tokens = g_array_new(FALSE, FALSE, sizeof(struct lexed_token));
+    }
+    g_array_set_size(tokens, 0);
+    refresh_known();
+}
+
+unsigned int highlight_update(const char *line, size_t len, size_t edit_pos)
+{
+    assert(line != NULL && edit_pos <= len);
+    if (tokens == NULL)
+    {
+        highlight_reset();
+    }
+    else if (!known_complete && now_ms() - known_time >= RETRY_MS)
+    {
+        // el hilo de fondo de completion puede haber terminado de leer $PATH
+        refresh_known();
+        edit_pos = 0;
+    }
+    // se conservan los tokens que terminan antes del cambio: un token que llega justo
+    // hasta él puede crecer o unirse con lo nuevo
+    unsigned int keep = tokens->len;
+    while (keep > 0)
+    {
+        const highlight_token *last = &g_array_index(tokens, struct lexed_token, keep - 1).token;
+        if (last->start + last->length < edit_pos)
+        {
+            break;
+        }
+        keep--;
+    }
+    g_array_set_size(tokens, keep);
+
+    size_t pos = 0;
+    lexer_state state = LEX_COMMAND;
+    if (keep > 0)
+    {
+        const struct lexed_token *last = &g_array_index(tokens, struct lexed_token, keep - 1);
+        pos = last->token.start + last->token.length;
+        state = last->after;
+    }
+    while (pos < len)
+    {
+        struct lexed_token lexed;
+        pos = lex_token(line, len, pos, &state, &lexed.token);
+        lexed.after = state;
+        g_array_append_val(tokens, lexed);
+    }
+    return tokens->len;
+}
+
+const highlight_token *highlight_get(unsigned int i)
+{
+    assert(tokens != NULL && i < tokens->len);
+    return &g_array_index(tokens, struct lexed_token, i).token;
+}
+
+void highlight_destroy(void)
+{
+    if (tokens != NULL)
+    {
+        g_array_free(tokens, TRUE);
+        tokens = NULL;
+    }
+    if (known != NULL)
+    {
+        g_hash_table_destroy(known);
+        release_listings(known_listings);
+        known = NULL;
+        known_listings = NULL;
+    }
+}
@@ -0,0 +1,61 @@
+/* Resaltado de la línea mientras se escribe.
+ * Un lexer divide la línea en tokens (comandos, argumentos, redirecciones,
+ * operadores) y, en cada cambio, vuelve a leer solo desde el punto editado.
+ * Para saber si un comando existe se consulta un conjunto en memoria con los
+ * comandos internos y los ejecutables de $PATH; no se hace ningún stat() por
+ * tecla.
+ */
+
+#ifndef HIGHLIGHT_H
+#define HIGHLIGHT_H
+
+#include <stddef.h>
+
+typedef enum
+{
+    HL_BLANK,       // espacios y tabulaciones
+    HL_ARGUMENT,    // argumento, o comando que no se pudo verificar
+    HL_COMMAND,     // comando interno o ejecutable de $PATH
+    HL_NOT_FOUND,   // comando que no existe
+    HL_REDIRECTION, // '<' o '>' junto con su archivo
+    HL_OPERATOR     // '|', '&' o ';'
+} highlight_kind;
+
+typedef struct
+{
+    size_t start;        // posición del primer carácter del token
+    size_t length;       // cantidad de caracteres
+    highlight_kind kind; // qué es el token
+} highlight_token;
+
+void highlight_reset(void);
+/*
+ * Prepara el resaltado de una línea nueva (se llama en cada prompt).
+ * Actualiza el conjunto de comandos conocidos con los listados de $PATH que
+ * ya estén en dircache; si falta alguno, los comandos desconocidos se marcan
+ * como HL_ARGUMENT en lugar de HL_NOT_FOUND.
+ */
+
+unsigned int highlight_update(const char *line, size_t len, size_t edit_pos);
+/*
+ * Informa que la línea cambió y vuelve a leer los tokens desde el cambio.
+ *   line: contenido actual de la línea (no necesita terminar en '\0').
+ *   len: largo de la línea.
+ *   edit_pos: primera posición modificada desde el llamado anterior.
+ *   Returns: cantidad de tokens de la línea.
+ * Requires: line != NULL && edit_pos <= len
+ */
+
+const highlight_token *highlight_get(unsigned int i);
+/*
+ * Token número `i' de la línea, en orden. Los tokens cubren la línea entera.
+ *   Returns: token válido hasta el próximo highlight_update().
+ * Requires: i < valor devuelto por el último highlight_update()
+ */
+
+void highlight_destroy(void);
+/*
+ * Libera el conjunto de comandos y los tokens.
+ */
+
+#endif /* HIGHLIGHT_H */
@@ -0,0 +1,213 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#include "history.h"
+
+#define TRIGRAM_LEN 3      // Largo de las subcadenas indexadas
+#define CHECKED_LISTS 3    // Listas extra a intersecar antes de verificar con strstr()
+
+// entradas del historial, en orden de llegada (la última es la más reciente)
+static GPtrArray *entries = NULL;
+// índice invertido: trigrama -> GArray de números de entrada (ordenados, sin repetidos)
+static GHashTable *trigrams = NULL;
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de empaquetar los tres bytes de un trigrama en un entero
+------------------------------------------------------------------------------------------------
+*/
+static guint trigram_key(const char *s)
+{
+    return ((guint)(unsigned char)s[0] << 16) |
+           ((guint)(unsigned char)s[1] << 8) |
+           (guint)(unsigned char)s[2];
+}
+
+static void posting_free(gpointer posting)
+{
+    g_array_free(posting, TRUE);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de agregar la entrada `id' a la lista de cada trigrama de `line'
+  -- como las entradas llegan en orden creciente, las listas quedan ordenadas sin esfuerzo --
+------------------------------------------------------------------------------------------------
+*/
+static void index_line(const char *line, guint id)
+{
+    size_t len = strlen(line);
+    for (size_t i = 0; i + TRIGRAM_LEN <= len; i++)
+    {
+        gpointer key = GUINT_TO_POINTER(trigram_key(line + i));
+        GArray *posting = g_hash_table_lookup(trigrams, key);
+        if (posting == NULL)
+        {
+            posting = g_array_new(FALSE, FALSE, sizeof(guint));
+            g_hash_table_insert(trigrams, key, posting);
+        }
+        // un mismo trigrama puede repetirse en la línea, pero se indexa una sola vez
+        if (posting->len == 0 || g_array_index(posting, guint, posting->len - 1) != id)
+        {
+            g_array_append_val(posting, id);
+        }
+    }
+}
+
+void history_add(const char *line)
+{
+    assert(line != NULL);
+    size_t len = strcspn(line, "\n");
+    if (strspn(line, " \t") >= len)
+    {
+        return;
+    }
+    if (entries == NULL)
+    {
+        entries = g_ptr_array_new_with_free_func(free);
+        trigrams = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, posting_free);
+    }
+    char *entry = strndup(line, len);
+    guint id = entries->len;
+    g_ptr_array_add(entries, entry);
+    index_line(entry, id);
+}
+
+unsigned int history_length(void)
+{
+    return (entries == NULL) ? 0u : entries->len;
+}
+
+const char *history_get(unsigned int index)
+{
+    assert(index < history_length());
+    return g_ptr_array_index(entries, index);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de contar cuántos elementos de `posting' son menores a `bound'
+              -- búsqueda binaria, las listas de entradas están ordenadas --
+------------------------------------------------------------------------------------------------
+*/
+static guint posting_lower_bound(GArray *posting, guint bound)
+{
+    guint lo = 0, hi = posting->len;
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        if (g_array_index(posting, guint, mid) < bound)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static bool posting_contains(GArray *posting, guint id)
+{
+    guint pos = posting_lower_bound(posting, id);
+    return pos < posting->len && g_array_index(posting, guint, pos) == id;
+}
+
+static gint posting_compare_len(gconstpointer a, gconstpointer b)
+{
+    const GArray *pa = *(GArray *const *)a;
+    const GArray *pb = *(GArray *const *)b;
+    return (pa->len > pb->len) - (pa->len < pb->len);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de buscar linealmente hacia atrás (patrones de menos de 3 letras)
+------------------------------------------------------------------------------------------------
+*/
+static bool linear_search(const char *pattern, guint before, unsigned int *index)
+{
+    for (guint id = before; id-- > 0;)
+    {
+        if (strstr(g_ptr_array_index(entries, id), pattern) != NULL)
+        {
+            *index = id;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool history_search_before(const char *pattern, unsigned int before, unsigned int *index)
+{
+    assert(pattern != NULL && index != NULL);
+    if (entries == NULL)
+    {
+        return false;
+    }
+    if (before > entries->len)
+    {
+        before = entries->len;
+    }
+    size_t len = strlen(pattern);
+    if (len < TRIGRAM_LEN)
+    {
+        return linear_search(pattern, before, index);
+    }
+
+    /* Cada entrada que contiene al patrón aparece en la lista de todos sus
+     * trigramas: alcanza con recorrer la lista más corta desde el final y
+     * descartar candidatos contra las siguientes más cortas. */
+    size_t count = len - TRIGRAM_LEN + 1;
+    GArray **lists = malloc(count * sizeof(GArray *));
+    for (size_t i = 0; i < count; i++)
+    {
+        lists[i] = g_hash_table_lookup(trigrams, GUINT_TO_POINTER(trigram_key(pattern + i)));
+        if (lists[i] == NULL)
+        {
+            // algún trigrama nunca apareció: no puede haber coincidencias
+            free(lists);
+            return false;
+        }
+    }
+    qsort(lists, count, sizeof(GArray *), posting_compare_len);
+
+    size_t checked = MIN(count, (size_t)CHECKED_LISTS + 1);
+    bool found = false;
+    for (guint pos = posting_lower_bound(lists[0], before); pos-- > 0 && !found;)
+    {
+        guint id = g_array_index(lists[0], guint, pos);
+        bool candidate = true;
+        for (size_t i = 1; i < checked && candidate; i++)
+        {
+            candidate = posting_contains(lists[i], id);
+        }
+        if (candidate && strstr(g_ptr_array_index(entries, id), pattern) != NULL)
+        {
+            *index = id;
+            found = true;
+        }
+    }
+    free(lists);
+    return found;
+}
+
+bool history_search(const char *pattern, unsigned int *index)
+{
+    return history_search_before(pattern, history_length(), index);
+}
+
+void history_destroy(void)
+{
+    if (entries != NULL)
+    {
+        g_hash_table_destroy(trigrams);
+        g_ptr_array_free(entries, TRUE);
+        trigrams = NULL;
+        entries = NULL;
+    }
+    assert(history_length() == 0);
+}
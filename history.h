@@ -0,0 +1,55 @@
+/* Historial de comandos ingresados en la sesión.
+ * Además de guardar las líneas en orden, mantiene un índice de trigramas que
+ * se actualiza a medida que se agregan comandos, para que la búsqueda inversa
+ * (al estilo Ctrl-R) no tenga que recorrer todo el historial.
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdbool.h>
+
+void history_add(const char *line);
+/*
+ * Agrega una línea al final del historial e indexa sus trigramas.
+ * Se ignora el '\n' final y las líneas formadas solo por blancos.
+ *   line: línea a agregar. El módulo guarda su propia copia.
+ * Requires: line != NULL
+ */
+
+unsigned int history_length(void);
+/*
+ * Cantidad de entradas guardadas en el historial.
+ */
+
+const char *history_get(unsigned int index);
+/*
+ * Devuelve la entrada número `index' (0 es la más antigua).
+ *   Returns: cadena propiedad del módulo, no debe ser liberada.
+ * Requires: index < history_length()
+ */
+
+bool history_search(const char *pattern, unsigned int *index);
+/*
+ * Busca la entrada más reciente que contiene a `pattern' como subcadena.
+ *   pattern: cadena a buscar.
+ *   index: si se encontró, se guarda el número de la entrada.
+ *   Returns: ¿Se encontró alguna entrada?
+ * Requires: pattern != NULL && index != NULL
+ */
+
+bool history_search_before(const char *pattern, unsigned int before,
+                           unsigned int *index);
+/*
+ * Igual que history_search(), pero solo considera entradas con número menor
+ * a `before'. Sirve para seguir buscando hacia atrás desde una coincidencia.
+ * Requires: pattern != NULL && index != NULL
+ */
+
+void history_destroy(void);
+/*
+ * Libera toda la memoria del historial y de su índice.
+ * Ensures: history_length() == 0
+ */
+
+#endif /* HISTORY_H */
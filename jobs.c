@@ -0,0 +1,139 @@
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <glib.h>
+
+#include "jobs.h"
+#include "proc.h"
+
+struct job
+{
+    unsigned int number;
+    unsigned int count;   // procesos del pipeline
+    unsigned int running; // cuántos todavía no se recogieron
+    pid_t *pids;
+    int *pidfds; // -1 una vez recogido el proceso
+    char *command;
+};
+
+static GPtrArray *jobs = NULL; // struct job *, en orden de número
+
+static void job_free(gpointer data)
+{
+    struct job *job = data;
+    for (unsigned int i = 0; i < job->count; i++)
+    {
+        if (job->pidfds[i] >= 0)
+        {
+            close(job->pidfds[i]);
+        }
+    }
+    free(job->pids);
+    free(job->pidfds);
+    g_free(job->command);
+    free(job);
+}
+
+unsigned int jobs_add(const pid_t *pids, unsigned int count, const char *command)
+{
+    assert(pids != NULL && count > 0 && command != NULL);
+    if (jobs == NULL)
+    {
+        jobs = g_ptr_array_new_with_free_func(job_free);
+    }
+    struct job *job = malloc(sizeof(struct job));
+    assert(job != NULL);
+    job->number = (jobs->len > 0) ? ((struct job *)g_ptr_array_index(jobs, jobs->len - 1))->number + 1 : 1;
+    job->count = count;
+    job->running = count;
+    job->pids = malloc(count * sizeof(pid_t));
+    job->pidfds = malloc(count * sizeof(int));
+    for (unsigned int i = 0; i < count; i++)
+    {
+        // el hijo todavía no se recogió, así que su pid no se pudo reusar
+        job->pids[i] = pids[i];
+        job->pidfds[i] = proc_pidfd_open(pids[i]);
+    }
+    job->command = g_strdup(command);
+    g_ptr_array_add(jobs, job);
+    return job->number;
+}
+
+void jobs_reap(bool report)
+{
+    for (unsigned int j = 0; jobs != NULL && j < jobs->len;)
+    {
+        struct job *job = g_ptr_array_index(jobs, j);
+        for (unsigned int i = 0; i < job->count; i++)
+        {
+            if (job->pids[i] > 0 && waitpid(job->pids[i], NULL, WNOHANG) != 0)
+            {
+                // terminó (o ya no es hijo nuestro): su pidfd ya no sirve
+                job->pids[i] = 0;
+                job->running--;
+                if (job->pidfds[i] >= 0)
+                {
+                    close(job->pidfds[i]);
+                    job->pidfds[i] = -1;
+                }
+            }
+        }
+        if (job->running > 0)
+        {
+            j++;
+            continue;
+        }
+        if (report)
+        {
+            printf("[%u]  Done    %s\n", job->number, job->command);
+        }
+        g_ptr_array_remove_index(jobs, j);
+    }
+}
+
+bool jobs_signal(unsigned int number, int sig)
+{
+    struct job *job = NULL;
+    for (unsigned int j = 0; jobs != NULL && j < jobs->len && job == NULL; j++)
+    {
+        struct job *candidate = g_ptr_array_index(jobs, j);
+        job = (candidate->number == number) ? candidate : NULL;
+    }
+    if (job == NULL)
+    {
+        errno = ESRCH;
+        return false;
+    }
+    bool sent = false;
+    int error = ESRCH;
+    for (unsigned int i = 0; i < job->count; i++)
+    {
+        // sin pidfd (o ya recogido) no se manda nada: el pid podría ser de otro proceso
+        if (job->pids[i] <= 0 || job->pidfds[i] == -1)
+        {
+            continue;
+        }
+        if (proc_pidfd_signal(job->pidfds[i], job->pids[i], sig) == 0)
+        {
+            sent = true;
+        }
+        else
+        {
+            error = errno;
+        }
+    }
+    errno = sent ? 0 : error;
+    return sent;
+}
+
+void jobs_destroy(void)
+{
+    if (jobs != NULL)
+    {
+        g_ptr_array_free(jobs, TRUE);
+        jobs = NULL;
+    }
+}
@@ -0,0 +1,45 @@
+/* Registro de trabajos en segundo plano.
+ * Cada pipeline lanzado con '&' queda registrado con un número (el que se
+ * usa en "kill %N") y un pidfd por proceso. Los pidfd se abren al
+ * registrarlo, cuando ya se crearon todos los procesos del pipeline pero
+ * antes de recoger ninguno: un hijo que no se recogió no libera su pid, así
+ * que una señal a un trabajo nunca llega a otro proceso que lo haya heredado.
+ * Los trabajos terminados se recogen antes de cada prompt, o después de cada
+ * línea de un script.
+ */
+
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+unsigned int jobs_add(const pid_t *pids, unsigned int count, const char *command);
+/*
+ * Registra un trabajo con los procesos `pids' (los de un pipeline).
+ *   command: texto del pipeline, para los avisos (se copia).
+ *   Returns: el número del trabajo: uno más que el mayor de los que siguen
+ *     corriendo, o 1 si no queda ninguno.
+ * Requires: pids != NULL && count > 0 && command != NULL
+ */
+
+void jobs_reap(bool report);
+/*
+ * Recoge los procesos de los trabajos que terminaron (sin bloquear) y saca
+ * del registro los trabajos terminados. Con `report', avisa por stdout
+ * cuáles terminaron.
+ */
+
+bool jobs_signal(unsigned int number, int sig);
+/*
+ * Manda `sig' a todos los procesos que siguen vivos del trabajo `number'.
+ *   Returns: false si no hay un trabajo con ese número o si no se le pudo
+ *     mandar la señal a ningún proceso (errno queda con el motivo).
+ */
+
+void jobs_destroy(void);
+/*
+ * Libera el registro (los procesos siguen corriendo).
+ */
+
+#endif /* JOBS_H */
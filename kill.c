@@ -0,0 +1,268 @@
+#include <assert.h>
+#include <errno.h>
+#include <regex.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <glib.h>
+
+#include "kill.h"
+#include "jobs.h"
+#include "proc.h"
+
+#define KILL_USAGE "kill: usage: kill [-s sig | -n num | -sig] pid|%job ... or kill -l\n"
+#define PKILL_USAGE "pkill: usage: pkill [-s sig | -sig] [-f] [-x] pattern\n"
+
+// Señales que se aceptan por nombre (las demás, por número)
+static const struct
+{
+    const char *name;
+    int number;
+} signal_names[] = {
+    {"HUP", SIGHUP},   {"INT", SIGINT},   {"QUIT", SIGQUIT}, {"ILL", SIGILL},   {"TRAP", SIGTRAP},
+    {"ABRT", SIGABRT}, {"BUS", SIGBUS},   {"FPE", SIGFPE},   {"KILL", SIGKILL}, {"USR1", SIGUSR1},
+    {"SEGV", SIGSEGV}, {"USR2", SIGUSR2}, {"PIPE", SIGPIPE}, {"ALRM", SIGALRM}, {"TERM", SIGTERM},
+    {"CHLD", SIGCHLD}, {"CONT", SIGCONT}, {"STOP", SIGSTOP}, {"TSTP", SIGTSTP}, {"TTIN", SIGTTIN},
+    {"TTOU", SIGTTOU}, {"URG", SIGURG},   {"XCPU", SIGXCPU}, {"XFSZ", SIGXFSZ}, {"WINCH", SIGWINCH},
+};
+
+static bool parse_signal(const char *text, int *sig)
+{
+    char *end;
+    long number = strtol(text, &end, 10);
+    if (text[0] != '\0' && *end == '\0')
+    {
+        *sig = (int)number;
+        return number >= 0 && number < NSIG;
+    }
+    const char *name = (strncasecmp(text, "SIG", 3) == 0) ? text + 3 : text;
+    for (unsigned int i = 0; i < G_N_ELEMENTS(signal_names); i++)
+    {
+        if (strcasecmp(name, signal_names[i].name) == 0)
+        {
+            *sig = signal_names[i].number;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void list_signals(void)
+{
+    for (unsigned int i = 0; i < G_N_ELEMENTS(signal_names); i++)
+    {
+        printf("%2d) SIG%-6s%s", signal_names[i].number, signal_names[i].name, (i % 5 == 4) ? "\n" : " ");
+    }
+    printf("\n");
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de leer la señal al principio de los argumentos
+  -- acepta "-s sig", "-sig" y, en kill, "-n num"; deja en `args' lo que sigue. Devuelve
+                     false (y avisa) si la señal no es válida --
+------------------------------------------------------------------------------------------------
+*/
+static bool take_signal(scommand args, const char *command, int *sig)
+{
+    *sig = SIGTERM;
+    if (scommand_is_empty(args))
+    {
+        return true;
+    }
+    const char *option = scommand_front(args);
+    // "--" y las opciones de pkill no son señales
+    if (option[0] != '-' || strcmp(option, "--") == 0 || strcmp(option, "-f") == 0 || strcmp(option, "-x") == 0)
+    {
+        return true;
+    }
+    bool separate = strcmp(option, "-s") == 0 || (strcmp(option, "-n") == 0 && strcmp(command, "kill") == 0);
+    char *value = g_strdup(separate ? "" : option + 1);
+    scommand_pop_front(args);
+    if (separate && !scommand_is_empty(args))
+    {
+        g_free(value);
+        value = g_strdup(scommand_front(args));
+        scommand_pop_front(args);
+    }
+    bool ok = parse_signal(value, sig);
+    if (!ok)
+    {
+        fprintf(stderr, "%s: %s: invalid signal specification\n", command, value);
+    }
+    g_free(value);
+    return ok;
+}
+
+// Manda la señal a un pid; devuelve false (y avisa) si no le llegó (ESRCH, EPERM...)
+static bool kill_pid(const char *target, int sig)
+{
+    char *end;
+    long pid = strtol(target, &end, 10);
+    if (target[0] == '\0' || *end != '\0' || pid <= 0)
+    {
+        fprintf(stderr, "kill: %s: arguments must be process or job IDs\n", target);
+        return false;
+    }
+    int pidfd = proc_pidfd_open(pid);
+    bool sent = (pidfd != -1 && proc_pidfd_signal(pidfd, pid, sig) == 0);
+    if (!sent)
+    {
+        fprintf(stderr, "kill: (%ld) - %s\n", pid, strerror(errno));
+    }
+    if (pidfd >= 0)
+    {
+        close(pidfd);
+    }
+    return sent;
+}
+
+int kill_run(scommand args)
+{
+    assert(args != NULL);
+    if (!scommand_is_empty(args) && strcmp(scommand_front(args), "-l") == 0)
+    {
+        list_signals();
+        return EXIT_SUCCESS;
+    }
+    int sig;
+    if (!take_signal(args, "kill", &sig))
+    {
+        return EXIT_FAILURE;
+    }
+    if (!scommand_is_empty(args) && strcmp(scommand_front(args), "--") == 0)
+    {
+        scommand_pop_front(args);
+    }
+    if (scommand_is_empty(args))
+    {
+        fputs(KILL_USAGE, stderr);
+        return EXIT_FAILURE;
+    }
+    int status = EXIT_SUCCESS;
+    while (!scommand_is_empty(args))
+    {
+        const char *target = scommand_front(args);
+        if (target[0] == '%')
+        {
+            char *end;
+            unsigned long job = strtoul(target + 1, &end, 10);
+            errno = ESRCH;
+            if (target[1] == '\0' || *end != '\0' || !jobs_signal(job, sig))
+            {
+                fprintf(stderr, "kill: %s: %s\n", target, (errno == ESRCH) ? "no such job" : strerror(errno));
+                status = EXIT_FAILURE;
+            }
+        }
+        else if (!kill_pid(target, sig))
+        {
+            status = EXIT_FAILURE;
+        }
+        scommand_pop_front(args);
+    }
+    return status;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de mandarle la señal a un proceso elegido en la lectura de /proc
+  -- entre la lectura y la señal el proceso pudo terminar y su pid reusarse: con el pidfd ya
+     abierto se vuelve a leer su momento de arranque, y si no coincide no se manda nada --
+------------------------------------------------------------------------------------------------
+*/
+static bool signal_process(const proc_info *info, int sig)
+{
+    int pidfd = proc_pidfd_open(info->pid);
+    if (pidfd == -1)
+    {
+        return false; // ya terminó
+    }
+    proc_info now;
+    bool sent = false;
+    if (proc_get(info->pid, &now) && now.start_ticks == info->start_ticks)
+    {
+        sent = proc_pidfd_signal(pidfd, info->pid, sig) == 0;
+        if (!sent && errno != ESRCH)
+        {
+            fprintf(stderr, "pkill: killing pid %d failed: %s\n", (int)info->pid, strerror(errno));
+        }
+    }
+    if (pidfd >= 0)
+    {
+        close(pidfd);
+    }
+    return sent;
+}
+
+int pkill_run(scommand args)
+{
+    assert(args != NULL);
+    int sig;
+    if (!take_signal(args, "pkill", &sig))
+    {
+        return PKILL_USAGE_ERROR;
+    }
+    bool full = false, exact = false;
+    while (!scommand_is_empty(args) && scommand_front(args)[0] == '-')
+    {
+        const char *option = scommand_front(args);
+        if (strcmp(option, "-f") == 0 || strcmp(option, "-x") == 0)
+        {
+            full = full || option[1] == 'f';
+            exact = exact || option[1] == 'x';
+            scommand_pop_front(args);
+        }
+        else if (strcmp(option, "--") == 0)
+        {
+            scommand_pop_front(args);
+            break;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (scommand_length(args) != 1)
+    {
+        fputs(PKILL_USAGE, stderr);
+        return PKILL_USAGE_ERROR;
+    }
+
+    char *pattern = exact ? g_strdup_printf("^(%s)$", scommand_front(args)) : g_strdup(scommand_front(args));
+    regex_t regex;
+    int error = regcomp(&regex, pattern, REG_EXTENDED | REG_NOSUB);
+    g_free(pattern);
+    if (error != 0)
+    {
+        char message[256];
+        regerror(error, &regex, message, sizeof(message));
+        fprintf(stderr, "pkill: %s: %s\n", scommand_front(args), message);
+        return PKILL_USAGE_ERROR;
+    }
+    proc_table table = proc_scan(full ? PROC_CMDLINE : 0);
+    if (table == NULL)
+    {
+        perror("pkill: /proc");
+        regfree(&regex);
+        return PKILL_FATAL;
+    }
+    pid_t self = getpid();
+    int status = PKILL_NO_MATCH;
+    for (unsigned int i = 0; i < proc_table_length(table); i++)
+    {
+        const proc_info *info = proc_table_get(table, i);
+        // los hilos del kernel no tienen cmdline: con -f se compara su nombre
+        const char *text = (full && info->cmdline[0] != '\0') ? info->cmdline : info->comm;
+        if (info->pid != self && regexec(&regex, text, 0, NULL, 0) == 0)
+        {
+            status = signal_process(info, sig) ? EXIT_SUCCESS : status;
+        }
+    }
+    proc_table_destroy(table);
+    regfree(&regex);
+    return status;
+}
@@ -0,0 +1,43 @@
+/* Comandos internos kill y pkill.
+ * Las señales se mandan por pidfd: el proceso queda fijado al abrir el
+ * descriptor, así que si su pid se reusa en el medio la señal no le llega a
+ * otro. pkill elige los procesos con la misma lectura de /proc que ps.
+ */
+
+#ifndef KILL_H
+#define KILL_H
+
+#include "command.h"
+
+#define PKILL_NO_MATCH 1    // pkill: ningún proceso recibió la señal
+#define PKILL_USAGE_ERROR 2 // pkill: opciones, señal o expresión inválidas
+#define PKILL_FATAL 3       // pkill: no se pudo leer /proc
+
+int kill_run(scommand args);
+/*
+ * Ejecuta kill. Los argumentos (sin el "kill") se consumen de `args':
+ *   kill [-s sig | -n num | -sig] pid|%job ...
+ *   kill -l
+ * La señal por defecto es TERM; se acepta por nombre (con o sin "SIG") o por
+ * número. %N es el trabajo N lanzado con '&'. Los errores se informan por
+ * stderr.
+ *   Returns: EXIT_SUCCESS si la señal le llegó a todos (o con -l);
+ *     EXIT_FAILURE si los argumentos no sirven o a alguno no le llegó
+ *     (no existe, no hay permiso...), como en bash.
+ * Requires: args != NULL
+ */
+
+int pkill_run(scommand args);
+/*
+ * Ejecuta pkill. Los argumentos (sin el "pkill") se consumen de `args':
+ *   pkill [-s sig | -sig] [-f] [-x] pattern
+ * Manda la señal (TERM por defecto) a los procesos cuyo nombre cumple la
+ * expresión regular extendida `pattern'; con -f se compara la línea de
+ * comando completa y con -x la expresión tiene que cubrir todo el texto.
+ * El propio shell no se cuenta.
+ *   Returns: EXIT_SUCCESS si la señal le llegó a algún proceso; si no,
+ *     PKILL_NO_MATCH, PKILL_USAGE_ERROR o PKILL_FATAL (los de procps).
+ * Requires: args != NULL
+ */
+
+#endif /* KILL_H */
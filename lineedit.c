@@ -0,0 +1,661 @@
+#include <assert.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <glib.h>
+
+#include "lineedit.h"
+#include "autosuggest.h"
+#include "completion.h"
+#include "highlight.h"
+#include "syntax.h"
+
+#define KEY_CTRL(c) ((c) & 0x1f)
+#define KEY_TAB 9
+#define KEY_ESC 27
+#define KEY_BACKSPACE 127
+
+#define SUGGESTION_ON "\x1b[2m"   // las sugerencias se muestran atenuadas
+#define SUGGESTION_OFF "\x1b[22m"
+
+#define COLOR_TEXT "\x1b[33m" // color del texto escrito, el mismo con el que termina el prompt
+
+// Color de cada tipo de token; NULL deja el color del texto
+static const char *const highlight_colors[] = {
+    [HL_BLANK] = NULL,
+    [HL_ARGUMENT] = NULL,
+    [HL_COMMAND] = "\x1b[32m",
+    [HL_NOT_FOUND] = "\x1b[31m",
+    [HL_REDIRECTION] = "\x1b[36m",
+    [HL_OPERATOR] = "\x1b[35m",
+};
+
+#define PASTE_ENABLE "\x1b[?2004h" // la terminal marca el texto pegado (bracketed paste)
+#define PASTE_DISABLE "\x1b[?2004l"
+#define PASTE_END "\x1b[201~"      // el inicio es ESC [ 200 ~
+
+#define INPUT_BUFFER (64 * 1024) // Tamaño del buffer de lectura de la terminal
+
+// Teclas que no son un único byte (secuencias de escape)
+typedef enum
+{
+    KEY_NONE = 256,
+    KEY_LEFT,
+    KEY_RIGHT,
+    KEY_HOME,
+    KEY_END,
+    KEY_DELETE,
+    KEY_PASTE
+} special_key;
+
+// Estado de la línea que se está editando
+struct editor
+{
+    GString *buf;           // contenido de la línea
+    size_t cursor;          // posición del cursor dentro de buf
+    size_t term_col;        // columna (relativa al inicio de la línea) donde quedó el cursor de la terminal
+    const char *suggestion; // resto sugerido a partir del historial, o NULL
+    unsigned int tokens;    // cantidad de tokens resaltados de la línea
+    void (*prompt)(void);   // función que imprime el prompt
+};
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Funciones encargadas de poner la terminal en modo crudo y de restaurarla
+  -- en modo crudo cada tecla llega apenas se presiona y la terminal no hace eco --
+------------------------------------------------------------------------------------------------
+*/
+static struct termios saved_termios;
+
+// Lo que quedó después del último '\n' de un pegado; se edita en el próximo prompt
+static GString *pending = NULL;
+
+static bool enable_raw_mode(void)
+{
+    if (tcgetattr(STDIN_FILENO, &saved_termios) == -1)
+    {
+        return false;
+    }
+    struct termios raw = saved_termios;
+    raw.c_iflag &= ~(ICRNL | IXON);
+    raw.c_lflag &= ~(ECHO | ICANON | ISIG | IEXTEN);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    return tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) == 0;
+}
+
+static void disable_raw_mode(void)
+{
+    tcsetattr(STDIN_FILENO, TCSAFLUSH, &saved_termios);
+}
+
+static void write_all(const char *data, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t written = write(STDOUT_FILENO, data, len);
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (written <= 0)
+        {
+            return;
+        }
+        data += written;
+        len -= written;
+    }
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Funciones encargadas de leer la terminal de a bloques
+  -- un pegado llega de una vez, así que se lo toma con pocas llamadas a read() --
+------------------------------------------------------------------------------------------------
+*/
+static char input[INPUT_BUFFER];
+static size_t input_pos = 0, input_len = 0;
+
+static bool fill_input(void)
+{
+    ssize_t res;
+    while ((res = read(STDIN_FILENO, input, sizeof(input))) < 0 && errno == EINTR)
+    {
+    }
+    input_pos = 0;
+    input_len = (res > 0) ? (size_t)res : 0;
+    return res > 0;
+}
+
+static int read_byte(void)
+{
+    if (input_pos == input_len && !fill_input())
+    {
+        return EOF;
+    }
+    return (unsigned char)input[input_pos++];
+}
+
+// El próximo byte de la entrada, sin sacarlo
+static int peek_byte(void)
+{
+    if (input_pos == input_len && !fill_input())
+    {
+        return EOF;
+    }
+    return (unsigned char)input[input_pos];
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de leer una tecla, traduciendo las secuencias de escape
+------------------------------------------------------------------------------------------------
+*/
+static int read_key(void)
+{
+    int c = read_byte();
+    if (c != KEY_ESC)
+    {
+        return c;
+    }
+    int kind = read_byte();
+    if (kind != '[' && kind != 'O')
+    {
+        return KEY_NONE;
+    }
+    // secuencias CSI: ESC [ <parámetros> <final>
+    int param = 0, final;
+    while ((final = read_byte()) != EOF && final >= '0' && final <= '9')
+    {
+        param = param * 10 + (final - '0');
+    }
+    switch (final)
+    {
+    case 'C':
+        return KEY_RIGHT;
+    case 'D':
+        return KEY_LEFT;
+    case 'H':
+        return KEY_HOME;
+    case 'F':
+        return KEY_END;
+    case '~':
+        if (param == 1 || param == 7)
+        {
+            return KEY_HOME;
+        }
+        if (param == 4 || param == 8)
+        {
+            return KEY_END;
+        }
+        if (param == 200)
+        {
+            return KEY_PASTE;
+        }
+        return (param == 3) ? KEY_DELETE : KEY_NONE;
+    default:
+        return KEY_NONE;
+    }
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Funciones encargadas de recorrer la línea de a caracteres UTF-8
+  -- la línea se guarda en bytes; el cursor salta las secuencias enteras y en la terminal
+      cada caracter ocupa una columna (los bytes de continuación no cuentan) --
+------------------------------------------------------------------------------------------------
+*/
+static bool is_continuation(int byte)
+{
+    return (byte & 0xC0) == 0x80;
+}
+
+static size_t char_before(const GString *buf, size_t pos)
+{
+    do
+    {
+        pos--;
+    } while (pos > 0 && is_continuation((unsigned char)buf->str[pos]));
+    return pos;
+}
+
+static size_t char_after(const GString *buf, size_t pos)
+{
+    do
+    {
+        pos++;
+    } while (pos < buf->len && is_continuation((unsigned char)buf->str[pos]));
+    return pos;
+}
+
+static size_t text_columns(const char *text, size_t len)
+{
+    size_t columns = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        columns += !is_continuation((unsigned char)text[i]);
+    }
+    return columns;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de redibujar la línea
+  -- vuelve al inicio de lo escrito, lo reescribe junto con la sugerencia y borra el resto --
+        -- se arma todo en un buffer para emitirlo con una sola escritura --
+------------------------------------------------------------------------------------------------
+*/
+static void editor_refresh(struct editor *ed)
+{
+    GString *out = g_string_new(NULL);
+    if (ed->term_col > 0)
+    {
+        g_string_append_printf(out, "\x1b[%zuD", ed->term_col);
+    }
+    for (unsigned int i = 0; i < ed->tokens; i++)
+    {
+        const highlight_token *token = highlight_get(i);
+        const char *color = highlight_colors[token->kind];
+        g_string_append(out, (color != NULL) ? color : "");
+        g_string_append_len(out, ed->buf->str + token->start, token->length);
+        g_string_append(out, (color != NULL) ? COLOR_TEXT : "");
+    }
+    // columnas que hay después del cursor, para volver a él
+    size_t after = text_columns(ed->buf->str + ed->cursor, ed->buf->len - ed->cursor);
+    if (ed->suggestion != NULL && ed->cursor == ed->buf->len)
+    {
+        g_string_append(out, SUGGESTION_ON);
+        g_string_append(out, ed->suggestion);
+        g_string_append(out, SUGGESTION_OFF);
+        after += text_columns(ed->suggestion, strlen(ed->suggestion));
+    }
+    g_string_append(out, "\x1b[K");
+    if (after > 0)
+    {
+        g_string_append_printf(out, "\x1b[%zuD", after);
+    }
+    write_all(out->str, out->len);
+    g_string_free(out, TRUE);
+    ed->term_col = text_columns(ed->buf->str, ed->cursor);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de avisar al módulo de sugerencias que la línea cambió
+                 -- `edit_pos' es la primera posición modificada --
+------------------------------------------------------------------------------------------------
+*/
+static void editor_changed(struct editor *ed, size_t edit_pos)
+{
+    ed->suggestion = autosuggest_update(ed->buf->str, ed->buf->len, edit_pos);
+    ed->tokens = highlight_update(ed->buf->str, ed->buf->len, edit_pos);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de insertar un caracter tecleado en el cursor
+  -- si `c' empieza una secuencia UTF-8, sus bytes de continuación (que llegan con él) se
+                   insertan juntos, para no dibujar nunca medio caracter --
+------------------------------------------------------------------------------------------------
+*/
+static void editor_insert(struct editor *ed, int c)
+{
+    char sequence[4] = {(char)c};
+    size_t length = 1, expected = (c >= 0xF0) ? 4 : (c >= 0xE0) ? 3 : (c >= 0xC0) ? 2 : 1;
+    while (length < expected && peek_byte() != EOF && is_continuation(peek_byte()))
+    {
+        sequence[length++] = (char)read_byte();
+    }
+    g_string_insert_len(ed->buf, ed->cursor, sequence, length);
+    editor_changed(ed, ed->cursor);
+    ed->cursor += length;
+}
+
+static void editor_erase(struct editor *ed, size_t from, size_t count)
+{
+    if (count > 0)
+    {
+        g_string_erase(ed->buf, from, count);
+        editor_changed(ed, from);
+    }
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de aceptar la sugerencia mostrada, agregándola a la línea
+------------------------------------------------------------------------------------------------
+*/
+static void editor_accept_suggestion(struct editor *ed)
+{
+    size_t from = ed->buf->len;
+    g_string_append(ed->buf, ed->suggestion);
+    ed->cursor = ed->buf->len;
+    editor_changed(ed, from);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de listar las coincidencias de un completado debajo de la línea
+   -- se acomodan en columnas según el ancho de la terminal y luego se redibuja el prompt --
+------------------------------------------------------------------------------------------------
+*/
+static void editor_list(struct editor *ed, const completion *result)
+{
+    struct winsize ws;
+    size_t width = (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_col > 0) ? ws.ws_col : 80;
+    size_t column = 0;
+    for (unsigned int i = 0; result->matches[i] != NULL; i++)
+    {
+        column = MAX(column, strlen(result->matches[i]) + 2);
+    }
+    size_t per_row = MAX(width / column, (size_t)1);
+
+    GString *out = g_string_new(NULL);
+    g_string_append(out, ed->buf->str + ed->cursor);
+    for (unsigned int i = 0; result->matches[i] != NULL; i++)
+    {
+        g_string_append(out, (i % per_row == 0) ? "\r\n" : "");
+        g_string_append_printf(out, "%-*s", (int)column, result->matches[i]);
+    }
+    if (result->count > COMPLETION_MAX_SHOWN)
+    {
+        g_string_append_printf(out, "\r\n... and %u more", result->count - COMPLETION_MAX_SHOWN);
+    }
+    g_string_append(out, "\r\n");
+    write_all(out->str, out->len);
+    g_string_free(out, TRUE);
+
+    ed->prompt();
+    ed->term_col = 0;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de completar la palabra bajo el cursor (tecla Tab)
+  -- se inserta el prefijo común de las coincidencias; si no agrega nada, se las lista --
+------------------------------------------------------------------------------------------------
+*/
+static void editor_complete(struct editor *ed)
+{
+    completion *result = completion_complete(ed->buf->str, ed->cursor);
+    size_t word_len = ed->cursor - result->word_start;
+    size_t common_len = strlen(result->common);
+    if (result->count == 0 || result->partial)
+    {
+        // sin coincidencias, o con directorios que todavía se están leyendo
+        write_all("\a", 1);
+    }
+    if (result->count == 1 || common_len > word_len)
+    {
+        g_string_erase(ed->buf, result->word_start, word_len);
+        g_string_insert(ed->buf, result->word_start, result->common);
+        ed->cursor = result->word_start + common_len;
+        if (result->count == 1 && !result->is_dir && ed->buf->str[ed->cursor] != ' ')
+        {
+            g_string_insert_c(ed->buf, ed->cursor, ' ');
+        }
+        if (result->count == 1 && !result->is_dir)
+        {
+            ed->cursor++;
+        }
+        editor_changed(ed, result->word_start);
+    }
+    else if (result->count > 1)
+    {
+        editor_list(ed, result);
+    }
+    completion_destroy(result);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de leer el texto pegado hasta la marca de fin
+   -- se copia de a tramos entre escapes; los '\r' que manda la terminal pasan a '\n' --
+------------------------------------------------------------------------------------------------
+*/
+static bool read_paste(GString *paste)
+{
+    const size_t mark_len = strlen(PASTE_END);
+    while (true)
+    {
+        if (input_pos == input_len && !fill_input())
+        {
+            return false;
+        }
+        char *chunk = input + input_pos;
+        char *esc = memchr(chunk, KEY_ESC, input_len - input_pos);
+        size_t take = (esc != NULL) ? (size_t)(esc - chunk) : input_len - input_pos;
+        for (size_t i = 0; i < take; i++)
+        {
+            if (chunk[i] == '\r')
+            {
+                chunk[i] = (i + 1 < take && chunk[i + 1] == '\n') ? '\0' : '\n';
+            }
+        }
+        for (char *from = chunk, *end = chunk + take; from < end;)
+        {
+            char *nul = memchr(from, '\0', end - from);
+            char *to = (nul != NULL) ? nul : end;
+            g_string_append_len(paste, from, to - from);
+            from = to + 1;
+        }
+        input_pos += take;
+        if (esc == NULL)
+        {
+            continue;
+        }
+        // ¿es la marca de fin o un escape que venía en el texto?
+        size_t matched = 0;
+        int c;
+        while (matched < mark_len && (c = read_byte()) == PASTE_END[matched])
+        {
+            matched++;
+        }
+        if (matched == mark_len)
+        {
+            return true;
+        }
+        if (c == EOF)
+        {
+            return false;
+        }
+        input_pos--; // el byte que no coincidió se vuelve a mirar
+        g_string_append_len(paste, PASTE_END, matched);
+    }
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de incorporar un pegado a la línea
+   -- si el pegado no trae '\n' se inserta en el cursor como si se lo hubiera tecleado;
+      si trae, todas las líneas completas se devuelven juntas, con un único eco --
+------------------------------------------------------------------------------------------------
+*/
+static bool editor_paste(struct editor *ed)
+{
+    GString *paste = g_string_new(NULL);
+    bool complete = read_paste(paste);
+    g_string_insert_len(ed->buf, ed->cursor, paste->str, paste->len);
+    size_t from = ed->cursor;
+    ed->cursor += paste->len;
+    g_string_free(paste, TRUE);
+    char *last_newline = strrchr(ed->buf->str, '\n');
+    if (last_newline == NULL)
+    {
+        editor_changed(ed, from);
+        return !complete;
+    }
+
+    // lo que sigue al último '\n' queda para editar en el próximo prompt
+    size_t lines_len = last_newline - ed->buf->str;
+    pending = g_string_new(last_newline + 1);
+    g_string_truncate(ed->buf, lines_len);
+
+    GString *out = g_string_sized_new(ed->buf->len + ed->buf->len / 16 + 16);
+    if (ed->term_col > 0)
+    {
+        g_string_append_printf(out, "\x1b[%zuD", ed->term_col);
+    }
+    g_string_append(out, "\x1b[K");
+    for (const char *line = ed->buf->str, *end = line + ed->buf->len; line <= end;)
+    {
+        const char *newline = memchr(line, '\n', end - line);
+        const char *stop = (newline != NULL) ? newline : end;
+        g_string_append_len(out, line, stop - line);
+        g_string_append(out, "\r\n");
+        line = stop + 1;
+    }
+    write_all(out->str, out->len);
+    g_string_free(out, TRUE);
+    return true;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de editar una línea en modo crudo hasta que se presione Enter
+             -- devuelve false si se llegó al fin de archivo (Ctrl-D en línea vacía) --
+------------------------------------------------------------------------------------------------
+*/
+static bool editor_run(struct editor *ed)
+{
+    while (true)
+    {
+        int key = read_key();
+        switch (key)
+        {
+        case EOF:
+            return ed->buf->len > 0;
+        case '\r':
+        case '\n':
+            // borramos la sugerencia antes de pasar a la línea siguiente
+            ed->suggestion = NULL;
+            editor_refresh(ed);
+            write_all("\r\n", 2);
+            return true;
+        case KEY_CTRL('c'):
+            g_string_truncate(ed->buf, 0);
+            write_all("^C\r\n", 4);
+            return true;
+        case KEY_CTRL('d'):
+            if (ed->buf->len == 0)
+            {
+                return false;
+            }
+            editor_erase(ed, ed->cursor, (ed->cursor < ed->buf->len) ? char_after(ed->buf, ed->cursor) - ed->cursor : 0);
+            break;
+        case KEY_DELETE:
+            editor_erase(ed, ed->cursor, (ed->cursor < ed->buf->len) ? char_after(ed->buf, ed->cursor) - ed->cursor : 0);
+            break;
+        case KEY_BACKSPACE:
+        case KEY_CTRL('h'):
+            if (ed->cursor > 0)
+            {
+                size_t end = ed->cursor;
+                ed->cursor = char_before(ed->buf, ed->cursor);
+                editor_erase(ed, ed->cursor, end - ed->cursor);
+            }
+            break;
+        case KEY_CTRL('u'):
+            editor_erase(ed, 0, ed->cursor);
+            ed->cursor = 0;
+            break;
+        case KEY_CTRL('k'):
+            editor_erase(ed, ed->cursor, ed->buf->len - ed->cursor);
+            break;
+        case KEY_LEFT:
+        case KEY_CTRL('b'):
+            if (ed->cursor > 0)
+            {
+                ed->cursor = char_before(ed->buf, ed->cursor);
+            }
+            break;
+        case KEY_RIGHT:
+        case KEY_CTRL('f'):
+        case KEY_END:
+        case KEY_CTRL('e'):
+            if (ed->cursor < ed->buf->len)
+            {
+                ed->cursor = (key == KEY_END || key == KEY_CTRL('e')) ? ed->buf->len : char_after(ed->buf, ed->cursor);
+            }
+            else if (ed->suggestion != NULL)
+            {
+                editor_accept_suggestion(ed);
+            }
+            break;
+        case KEY_TAB:
+            editor_complete(ed);
+            break;
+        case KEY_PASTE:
+            if (editor_paste(ed))
+            {
+                return true;
+            }
+            break;
+        case KEY_HOME:
+        case KEY_CTRL('a'):
+            ed->cursor = 0;
+            break;
+        default:
+            // los bytes desde 0x80 son caracteres UTF-8 de más de un byte
+            if (key >= ' ' && key < KEY_NONE)
+            {
+                editor_insert(ed, key);
+            }
+            break;
+        }
+        editor_refresh(ed);
+    }
+}
+
+ssize_t lineedit_getline(char **line, size_t *len, void (*prompt)(void))
+{
+    assert(line != NULL && len != NULL && prompt != NULL);
+    static bool prefetched = false;
+    prompt();
+    if (!isatty(STDIN_FILENO) || !enable_raw_mode())
+    {
+        return getline(line, len, stdin);
+    }
+    if (!prefetched)
+    {
+        // a partir del primer prompt se leen los directorios de $PATH en segundo plano
+        completion_prefetch();
+        prefetched = true;
+    }
+
+    struct editor ed = {(pending != NULL) ? pending : g_string_new(NULL), 0, 0, NULL, 0, prompt};
+    pending = NULL;
+    write_all(PASTE_ENABLE, strlen(PASTE_ENABLE));
+    autosuggest_reset();
+    highlight_reset();
+    suggest_prefetch(); // reindexa en segundo plano los directorios de $PATH que cambiaron
+    if (ed.buf->len > 0)
+    {
+        ed.cursor = ed.buf->len;
+        editor_changed(&ed, 0);
+        editor_refresh(&ed);
+    }
+    bool got_line = editor_run(&ed);
+    write_all(PASTE_DISABLE, strlen(PASTE_DISABLE));
+    disable_raw_mode();
+
+    ssize_t read = -1;
+    if (got_line)
+    {
+        g_string_append_c(ed.buf, '\n');
+        if (*line == NULL || *len < ed.buf->len + 1)
+        {
+            *len = ed.buf->len + 1;
+            *line = realloc(*line, *len);
+            assert(*line != NULL);
+        }
+        memcpy(*line, ed.buf->str, ed.buf->len + 1);
+        read = ed.buf->len;
+    }
+    g_string_free(ed.buf, TRUE);
+    return read;
+}
@@ -0,0 +1,28 @@
+/* Lectura de líneas de comando.
+ * Si la entrada estándar es una terminal, se la pone en modo crudo y se edita
+ * la línea dentro del shell (cursor, borrado, sugerencias del historial).
+ * En otro caso (por ejemplo, un script por pipe) se lee con getline().
+ */
+
+#ifndef LINEEDIT_H
+#define LINEEDIT_H
+
+#include <stdio.h>
+#include <sys/types.h>
+
+ssize_t lineedit_getline(char **line, size_t *len, void (*prompt)(void));
+/*
+ * Muestra el prompt y lee una línea de stdin con la misma convención que
+ * getline(): la línea termina en '\n' y el buffer `*line' (de tamaño `*len')
+ * se agranda si es necesario y es propiedad del llamador.
+ *   prompt: función que imprime el prompt. El editor puede volver a llamarla
+ *     si necesita redibujar la línea desde cero (por ejemplo, después de
+ *     listar las opciones de un completado).
+ *   Si se pega texto con varias líneas, se devuelven todas juntas en `*line'
+ *   (separadas por '\n', la última también termina en '\n'); un resto sin
+ *   '\n' final queda en el editor para el próximo llamado.
+ *   Returns: cantidad de caracteres leídos, o -1 en fin de archivo.
+ * Requires: line != NULL && len != NULL && prompt != NULL
+ */
+
+#endif /* LINEEDIT_H */
@@ -0,0 +1,186 @@
+#include <assert.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "mapfile.h"
+#include "vars.h"
+
+#define MAPFILE_BLOCK (64 * 1024) // Tamaño de cada lectura (crece si una línea no entra)
+#define MAPFILE_USAGE "mapfile: usage: mapfile [-t] [-n count] [-u fd] [array]\n"
+
+struct loader
+{
+    const char *name; // arreglo destino
+    bool trim;        // -t
+    size_t max;       // -n (0: sin límite)
+    size_t loaded;    // líneas cargadas hasta ahora
+    char **lines;     // punteros de las líneas del bloque actual
+    size_t allocated; // lugares de `lines'
+};
+
+static bool parse_count(const char *text, long *number)
+{
+    char *end = NULL;
+    *number = strtol(text, &end, 10);
+    return text[0] != '\0' && *end == '\0' && *number >= 0;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de pasar al arreglo las líneas completas de buffer[0, length)
+  -- primero cuenta las líneas que entran (respetando -n), después las copia todas a un solo
+      bloque, cada una terminada en '\0', y el arreglo se queda con el bloque. Al final del
+          archivo la última línea puede no tener '\n'. Devuelve los bytes consumidos --
+------------------------------------------------------------------------------------------------
+*/
+static size_t adopt_lines(struct loader *loader, const char *buffer, size_t length, bool eof)
+{
+    size_t count = 0, consumed = 0;
+    while (consumed < length && (loader->max == 0 || loader->loaded + count < loader->max))
+    {
+        const char *newline = memchr(buffer + consumed, '\n', length - consumed);
+        if (newline == NULL && !eof)
+        {
+            break;
+        }
+        consumed = (newline != NULL) ? (size_t)(newline - buffer) + 1 : length;
+        count++;
+    }
+    if (count == 0)
+    {
+        return 0;
+    }
+    if (count > loader->allocated)
+    {
+        loader->allocated = count;
+        loader->lines = realloc(loader->lines, count * sizeof(char *));
+        assert(loader->lines != NULL);
+    }
+    char *block = malloc(consumed + count);
+    assert(block != NULL);
+    const char *line = buffer;
+    char *out = block;
+    for (size_t i = 0; i < count; i++)
+    {
+        const char *newline = memchr(line, '\n', buffer + consumed - line);
+        size_t size = (newline != NULL) ? (size_t)(newline - line) + 1 : (size_t)(buffer + consumed - line);
+        size_t keep = (loader->trim && newline != NULL) ? size - 1 : size;
+        memcpy(out, line, keep);
+        out[keep] = '\0';
+        loader->lines[i] = out;
+        out += keep + 1;
+        line += size;
+    }
+    vars_adopt(loader->name, block, loader->lines, count);
+    loader->loaded += count;
+    return consumed;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de leer `fd' de a bloques y cargar sus líneas
+  -- si -n cortó antes del final, lo que se leyó de más se devuelve con lseek (en un pipe
+                                     no se puede) --
+------------------------------------------------------------------------------------------------
+*/
+static bool load(struct loader *loader, int fd)
+{
+    size_t size = MAPFILE_BLOCK, have = 0;
+    char *buffer = malloc(size);
+    assert(buffer != NULL);
+    bool eof = false, failed = false;
+    while (!eof && (loader->max == 0 || loader->loaded < loader->max))
+    {
+        ssize_t n = read(fd, buffer + have, size - have);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0)
+        {
+            fprintf(stderr, "mapfile: %d: %s\n", fd, strerror(errno));
+            failed = true;
+            break;
+        }
+        eof = (n == 0);
+        have += n;
+        size_t consumed = adopt_lines(loader, buffer, have, eof);
+        memmove(buffer, buffer + consumed, have - consumed);
+        have -= consumed;
+        if (have == size)
+        {
+            // una sola línea ocupa todo el buffer
+            size *= 2;
+            buffer = realloc(buffer, size);
+            assert(buffer != NULL);
+        }
+    }
+    if (have > 0)
+    {
+        lseek(fd, -(off_t)have, SEEK_CUR);
+    }
+    free(buffer);
+    return !failed;
+}
+
+int mapfile_run(scommand args)
+{
+    assert(args != NULL);
+    struct loader loader = {"MAPFILE", false, 0, 0, NULL, 0};
+    long fd = STDIN_FILENO, number = 0;
+    while (!scommand_is_empty(args) && scommand_front(args)[0] == '-')
+    {
+        char *option = scommand_front(args);
+        if (strcmp(option, "-t") == 0)
+        {
+            loader.trim = true;
+        }
+        else if ((strcmp(option, "-n") == 0 || strcmp(option, "-u") == 0) && scommand_length(args) > 1)
+        {
+            bool count = (option[1] == 'n');
+            scommand_pop_front(args);
+            if (!parse_count(scommand_front(args), &number))
+            {
+                fprintf(stderr, "mapfile: %s: invalid %s\n", scommand_front(args), count ? "line count" : "file descriptor");
+                return EXIT_FAILURE;
+            }
+            if (count)
+            {
+                loader.max = number;
+            }
+            else
+            {
+                fd = number;
+            }
+        }
+        else
+        {
+            fputs(MAPFILE_USAGE, stderr);
+            return EXIT_FAILURE;
+        }
+        scommand_pop_front(args);
+    }
+    if (scommand_length(args) > 1)
+    {
+        fputs(MAPFILE_USAGE, stderr);
+        return EXIT_FAILURE;
+    }
+    if (!scommand_is_empty(args))
+    {
+        loader.name = scommand_front(args);
+    }
+    if (!vars_valid_name(loader.name, strlen(loader.name)))
+    {
+        fprintf(stderr, "mapfile: `%s': not a valid identifier\n", loader.name);
+        return EXIT_FAILURE;
+    }
+    vars_unset(loader.name);
+    vars_declare(loader.name, VAR_INDEXED);
+    bool loaded = load(&loader, (int)fd);
+    free(loader.lines);
+    return loaded ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,25 @@
+/* Comando interno mapfile.
+ * Carga las líneas de un descriptor en un arreglo indexado. Lee de a
+ * bloques grandes, y las líneas de cada bloque se copian juntas a una sola
+ * reserva de memoria, que pasa a ser del arreglo (vars_adopt).
+ */
+
+#ifndef MAPFILE_H
+#define MAPFILE_H
+
+#include "command.h"
+
+int mapfile_run(scommand args);
+/*
+ * Ejecuta mapfile. Los argumentos (sin el "mapfile") se consumen de `args':
+ *   mapfile [-t] [-n count] [-u fd] [array]
+ *   -t  sacar el '\n' del final de cada línea
+ *   -n  cargar como mucho `count' líneas (0: todas)
+ *   -u  leer de `fd' en lugar de la entrada estándar
+ * El arreglo (MAPFILE si no se indica) se vacía antes de cargarlo.
+ *   Returns: EXIT_SUCCESS, o EXIT_FAILURE si los argumentos no son válidos o
+ *     falló la lectura.
+ * Requires: args != NULL
+ */
+
+#endif /* MAPFILE_H */
@@ -5,12 +5,22 @@
 #include <time.h>
 #include <unistd.h>
 #include <string.h>
+#include <fcntl.h>
+#include <glib.h>
 
 #include "command.h"
 #include "execute.h"
 #include "parser.h"
 #include "parsing.h"
 #include "builtin.h"
+#include "history.h"
+#include "lineedit.h"
+#include "autosuggest.h"
+#include "highlight.h"
+#include "jobs.h"
+#include "vars.h"
+#include "script.h"
+#include "read.h"
 
 #include "obfuscated.h"
 
@@ -36,23 +46,110 @@ static void show_prompt(void)
     fflush(stdout);
 }
 
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de parsear todas las líneas leídas y compilar sus listas de pipelines
+  -- un pegado de muchas líneas se parsea con un solo parser, en una sola pasada; una línea
+        con muchos comandos (a && b ; c) es una sola lista. Las líneas de un script no
+                               van al historial --
+------------------------------------------------------------------------------------------------
+*/
+static void parse_lines(char *text, size_t length, script code, bool remember)
+{
+    Parser input = parser_new(fmemopen(text, length, "r"));
+    const char *line = text;
+    while (!parser_at_eof(input) && line < text + length)
+    {
+        // cada lista consume exactamente una línea, hasta su '\n'
+        if (remember)
+        {
+            history_add(line);
+        }
+        cmdlist list = parse_list(input);
+        if (list != NULL)
+        {
+            script_compile(code, list);
+        }
+        else
+        {
+            // una línea inválida descarta también el if o el ciclo que venía abierto
+            script_discard(code);
+        }
+        const char *newline = strchr(line, '\n');
+        line = (newline != NULL) ? newline + 1 : text + length;
+    }
+    parser_destroy(input);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de ejecutar un script, línea por línea y sin prompt
+  -- un if o un ciclo se ejecuta cuando termina de llegar; devuelve el último estado. Se lee
+      con read_line y no con stdio: un hijo que termina con exit() acomoda el offset de los
+           FILE que heredó, y le haría releer al shell líneas que ya había ejecutado --
+------------------------------------------------------------------------------------------------
+*/
+static int run_file(const char *path, script code)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        perror(path);
+        return BUILTIN_NOT_FOUND;
+    }
+    GString *line = g_string_new(NULL);
+    int status = EXIT_SUCCESS;
+    bool complete = true;
+    while (complete)
+    {
+        complete = read_line(fd, line, READ_AUTO);
+        if (!complete && line->len == 0)
+        {
+            break;
+        }
+        g_string_append_c(line, '\n');
+        parse_lines(line->str, line->len, code, false);
+        if (!script_pending(code))
+        {
+            status = script_run(code);
+        }
+        // sin prompt, los trabajos en segundo plano que terminaron se recogen después de cada línea (sin avisar)
+        jobs_reap(false);
+    }
+    if (script_pending(code))
+    {
+        fprintf(stderr, "%s: syntax error: unexpected end of file\n", path);
+        script_discard(code);
+        status = EXIT_FAILURE;
+    }
+    g_string_free(line, TRUE);
+    close(fd);
+    return status;
+}
+
 int main(int argc, char *argv[])
 {
-    pipeline pipe;
-    pipe = pipeline_new();
-    Parser input;
+    script code = script_new(); // código compilado que todavía no se ejecutó
+    int status = EXIT_SUCCESS;
 
     char *line = NULL;    // Cadena para almacenar la línea de entrada
     size_t len = 0;       // Tamaño del buffer para getline
     ssize_t read = 0;     // Cantidad de caracteres leídos
 
-    while (true)
+    // con un argumento se ejecuta ese script; si no, se leen comandos de la entrada
+    bool interactive = (argc < 2);
+    if (!interactive)
+    {
+        status = run_file(argv[1], code);
+    }
+    while (interactive)
     {
         ping_pong_loop("ArticBlueWombat");
-        show_prompt();
+        // se recogen los trabajos en segundo plano que terminaron (como bash, se avisa solo en una terminal)
+        jobs_reap(isatty(STDIN_FILENO));
         // obtengo la entrada y luego se la paso a parse new
-        // Leer la entrada del usuario (getline se encarga de gestionar el tamaño del buffer)
-        read = getline(&line, &len, stdin);
+        // Leer la entrada del usuario (lineedit muestra el prompt y gestiona el tamaño del buffer)
+        read = lineedit_getline(&line, &len, show_prompt);
 
         // Verificar si se ingresó Ctrl-D (EOF)
         if (read == -1)
@@ -63,36 +160,22 @@ int main(int argc, char *argv[])
 
         // Mostrar la línea de entrada antes de pasarla al parser
         // printf("Entrada recibida: %s", line);
-        if(strchr(line, '<')){
-            // printf("Redirección de salida\n");
-            set_flag_out_true();
-        }
-        if(strchr(line, '>')){
-            // printf("Redirección de entrada\n");
-            set_flag_in_true();
-        }
+        parse_lines(line, read, code, true);
 
-        input = parser_new(fmemopen(line, read, "r"));
-        pipe = parse_pipeline(input);
-        // verificamos si se ingreso ctrl-d, en tal caso cerramos myBash
-        if (parser_at_eof(input))
+        // se ejecuta todo lo compilado antes de volver a mostrar el prompt (salvo que falte
+        // cerrar un if o un ciclo: entonces se sigue leyendo)
+        if (!script_pending(code))
         {
-            printf("\n");
-            return EXIT_SUCCESS;
+            status = script_run(code);
         }
-        execute_pipeline(pipe);
-        pipe = pipeline_destroy(pipe);
-        parser_destroy(input);
     }
 
-    if (input != NULL)
-    {
-        parser_destroy(input);
-        input = NULL;
-    }
-    if (pipe != NULL)
-    {
-        pipeline_destroy(pipe);
-    }
-    return EXIT_SUCCESS;
+    script_destroy(code);
+    free(line);
+    autosuggest_destroy();
+    highlight_destroy();
+    jobs_destroy();
+    vars_destroy();
+    history_destroy();
+    return status;
 }
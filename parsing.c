@@ -1,21 +1,187 @@
+#include <assert.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
 #include <stdio.h>
+#include <glib.h>
 
 #include "parsing.h"
 #include "parser.h"
 #include "command.h"
+#include "vars.h"
+#include "brace.h"
+#include "pathname.h"
 
-bool flag_in = false;
-bool flag_out = false;
+#define BATCH_COMMAND "batch" // sus argumentos los expande él mismo, de a uno (word_stream)
 
-void set_flag_in_true(){
-    flag_in = true;
+// Operador que sigue a un pipeline dentro de una línea
+typedef enum
+{
+    OP_END,        // no hay más: lo que quede hasta el '\n' es basura
+    OP_SEQUENCE,   // ';'
+    OP_BACKGROUND, // '&' (el pipeline no se espera y la línea sigue)
+    OP_AND,        // "&&"
+    OP_OR          // "||"
+} list_op;
+
+// Estado del parseo de una línea
+struct line_state
+{
+    bool expand;    // expandir variables al parsear; si no, se expanden al ejecutar (expand_pipeline)
+    char *pending;  // lo que seguía a un ';' dentro de una misma palabra ("a;b")
+    bool separated; // el último comando simple terminó en un ';'
+    bool broken;    // algún comando simple tenía una redirección sin archivo: la línea no vale
+    list_op op;     // operador que siguió al último pipeline
+};
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de buscar el primer ';' que separa comandos dentro de una palabra
+  -- sigue las comillas como pattern_from_word: un ';' entre comillas o después de una '\' es
+                              parte de la palabra --
+------------------------------------------------------------------------------------------------
+*/
+static char *find_separator(char *arg)
+{
+    char quote = '\0';
+    for (char *c = arg; *c != '\0'; c++)
+    {
+        if ((quote == '\0' && (*c == '\'' || *c == '"')) || (quote != '\0' && *c == quote))
+        {
+            quote = (quote == '\0') ? *c : '\0';
+        }
+        else if (*c == '\\' && c[1] != '\0' && quote != '\'')
+        {
+            c++;
+        }
+        else if (*c == ';' && quote == '\0')
+        {
+            return c;
+        }
+    }
+    return NULL;
 }
 
-void set_flag_out_true(){
-    flag_out = true;
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de dar el próximo argumento
+  -- primero lo que quedó de una palabra cortada por un ';'; un ';' termina el comando y lo
+                       que lo sigue queda pendiente para el próximo --
+------------------------------------------------------------------------------------------------
+*/
+static char *next_argument(Parser p, struct line_state *state, arg_kind_t *arg_type)
+{
+    char *arg = state->pending;
+    state->pending = NULL;
+    *arg_type = ARG_NORMAL;
+    if (arg == NULL && (arg = parser_next_argument(p, arg_type)) == NULL)
+    {
+        return NULL;
+    }
+    char *semicolon = find_separator(arg);
+    if (semicolon != NULL)
+    {
+        state->separated = true;
+        state->pending = (semicolon[1] != '\0') ? strdup(semicolon + 1) : NULL;
+        *semicolon = '\0';
+    }
+    return arg;
+}
+
+void expand_word(char *word, GPtrArray *words)
+{
+    assert(word != NULL && words != NULL);
+    if (!pathname_has_pattern(word))
+    {
+        vars_expand(word, words);
+        return;
+    }
+    if (strchr(word, '$') == NULL)
+    {
+        // sin variables el patrón conserva sus comillas: lo que está entre ellas no es comodín
+        if (pathname_expand(word, words))
+        {
+            free(word);
+        }
+        else
+        {
+            vars_expand(word, words);
+        }
+        return;
+    }
+    // cada palabra se expande dos veces: como patrón (los comodines entre comillas no cuentan) y
+    // como texto, que es lo que queda si el patrón no coincide con nada
+    GPtrArray *patterns = g_ptr_array_new_with_free_func(free);
+    GPtrArray *expanded = g_ptr_array_new();
+    vars_expand_pattern(strdup(word), patterns);
+    vars_expand(word, expanded);
+    assert(patterns->len == expanded->len);
+    for (guint i = 0; i < expanded->len; i++)
+    {
+        char *each = g_ptr_array_index(expanded, i);
+        if (pathname_expand(g_ptr_array_index(patterns, i), words))
+        {
+            free(each);
+        }
+        else
+        {
+            g_ptr_array_add(words, each);
+        }
+    }
+    g_ptr_array_free(expanded, TRUE);
+    g_ptr_array_free(patterns, TRUE);
+}
+
+// Indica si `cmd' es un batch: sus argumentos quedan sin expandir hasta que los pida
+static bool is_batch(scommand cmd)
+{
+    return !scommand_is_empty(cmd) && strcmp(scommand_front(cmd), BATCH_COMMAND) == 0;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de expandir un argumento de un comando: primero las llaves y después
+                   las variables y los nombres de archivo de cada palabra que resulta
+------------------------------------------------------------------------------------------------
+*/
+static void expand_argument(char *word, GPtrArray *words)
+{
+    if (!brace_has_expression(word))
+    {
+        expand_word(word, words);
+        return;
+    }
+    brace generator = brace_new(word);
+    free(word);
+    for (char *each = brace_next(generator); each != NULL; each = brace_next(generator))
+    {
+        expand_word(each, words);
+    }
+    brace_destroy(generator);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de expandir el archivo de una redirección
+  -- tiene que quedar en un solo archivo: si la expansión da ninguno o varios, se avisa y
+                                    devuelve NULL --
+------------------------------------------------------------------------------------------------
+*/
+static char *expand_redirection(const char *file, GPtrArray *words)
+{
+    g_ptr_array_set_size(words, 0);
+    vars_expand(strdup(file), words);
+    char *expanded = (words->len == 1) ? g_ptr_array_index(words, 0) : NULL;
+    for (unsigned int k = (expanded != NULL); k < words->len; k++)
+    {
+        free(g_ptr_array_index(words, k));
+    }
+    g_ptr_array_set_size(words, 0);
+    if (expanded == NULL)
+    {
+        fprintf(stderr, "mybash: %s: ambiguous redirect\n", file);
+    }
+    return expanded;
 }
 
 /*
@@ -24,47 +190,79 @@ void set_flag_out_true(){
  -- toma un parser como parámetro y devuelve un scommand, es estática ya que no se necesita por fuera --
 ---------------------------------------------------------------------------------------------------------
 */
-static scommand parse_scommand(Parser p)
+static scommand parse_scommand(Parser p, struct line_state *state)
 {
     scommand cmd = scommand_new();
     char *arg = NULL;
     arg_kind_t arg_type;
+    GPtrArray *words = g_ptr_array_new(); // palabras que resultan de expandir cada argumento
+    arg_kind_t missing = ARG_NORMAL;      // una redirección que no tenía archivo ("ls >")
+    bool ambiguous = false;               // una redirección que no quedó en un solo archivo
 
-    // Parsear los argumentos del comando
-    while ((arg = parser_next_argument(p, &arg_type)) != NULL)
+    // Parsear los argumentos del comando (hasta el final, o hasta un ';')
+    while (!state->separated && (arg = next_argument(p, state, &arg_type)) != NULL)
     {
         // printf("Entra al while\n");
         // printf("Arg: %s\n", arg);
-        if (arg_type == ARG_NORMAL)
+        // se expanden las llaves, las variables y los nombres de archivo: una palabra puede quedar vacía (desaparece) o ser varias ({a,b}, ${a[@]}, *.c)
+        g_ptr_array_set_size(words, 0);
+        if (arg[0] == '\0')
         {
-            scommand_push_back(cmd, arg);
+            free(arg); // un ';' suelto, o un '<' o '>' sin archivo
+            missing = (arg_type != ARG_NORMAL) ? arg_type : missing;
         }
-        else if (arg_type == ARG_INPUT)
+        else if (arg_type != ARG_NORMAL)
         {
-            scommand_set_redir_in(cmd, arg);
+            char *file = state->expand ? expand_redirection(arg, words) : arg;
+            ambiguous = ambiguous || file == NULL;
+            if (file != arg)
+            {
+                free(arg);
+            }
+            if (file == NULL)
+            {
+                continue;
+            }
+            if (arg_type == ARG_INPUT)
+            {
+                scommand_set_redir_in(cmd, file);
+            }
+            else
+            {
+                scommand_set_redir_out(cmd, file);
+            }
         }
-        else if (arg_type == ARG_OUTPUT)
+        else
         {
-            // printf("Redir out: %s\n", arg);
-            scommand_set_redir_out(cmd, arg);
+            if (state->expand && !is_batch(cmd))
+            {
+                expand_argument(arg, words);
+            }
+            else
+            {
+                g_ptr_array_add(words, arg);
+            }
+            for (unsigned int i = 0; i < words->len; i++)
+            {
+                scommand_push_back(cmd, g_ptr_array_index(words, i));
+            }
         }
         // Comentado porque terminaba liberando la memoria del comando ingresado
         // free(arg); // Liberar el argumento ya que scommand lo copia internamente
     }
+    g_ptr_array_free(words, TRUE);
 
-    if(flag_in && (scommand_get_redir_in(cmd) == NULL)){
-        printf("Error: Redirección de entrada sin archivo\n");
-        scommand_destroy(cmd);
-        cmd = scommand_new();
-        flag_in = false;
-        return cmd;
+    // el parser también puede terminar el comando en un '<' o '>' que no tenía archivo
+    missing = (arg == NULL && arg_type != ARG_NORMAL) ? arg_type : missing;
+    if (missing != ARG_NORMAL)
+    {
+        fprintf(stderr, "Error: Redirección de %s sin archivo\n", (missing == ARG_INPUT) ? "entrada" : "salida");
     }
-    if(flag_out && (scommand_get_redir_out(cmd) == NULL)){
-        printf("Error: Redirección de salida sin archivo\n");
+    if (missing != ARG_NORMAL || ambiguous)
+    {
+        state->broken = true;
         scommand_destroy(cmd);
-        cmd = scommand_new();
-        flag_out = false;
-        return cmd;
+        return scommand_new();
     }
 
     // Verificar si el comando está vacío
@@ -78,66 +276,269 @@ static scommand parse_scommand(Parser p)
 }
 
 /* ------------------------------------------------------------------------------------------------
-*               Función encargada de parsear un pipeline completo y devolverlo
-       -- toma un parser como parámetro y devuelve un pipeline, que se utilizará en el main --
+*         Función encargada de parsear los comandos simples unidos por '|' y lo que los sigue
+       -- deja en state->op el operador que siguió al pipeline (un '|' seguido de otro es ||,
+                             y un '&' seguido de otro es &&) --
 ------------------------------------------------------------------------------------------------ */
-
-pipeline parse_pipeline(Parser p)
+static pipeline parse_sequence(Parser p, struct line_state *state)
 {
     pipeline result = pipeline_new();
-    scommand cmd = NULL;
-    bool error = false, another_pipe = true; // Indica si hay otro comando por parsear
-    pipeline_set_wait(result, true);         // Establecer en true por defecto
-    parser_skip_blanks(p);                   // Saltar blancos antes de empezar
-
-    cmd = parse_scommand(p);
-    error = (cmd == NULL); // Error si no se pudo parsear el primer comando
+    bool another_pipe = true;        // Indica si hay otro comando por parsear
+    pipeline_set_wait(result, true); // Establecer en true por defecto
+    state->op = OP_END;
+    state->separated = false;
 
-    while (another_pipe && !error)
+    while (another_pipe)
     {
+        scommand cmd = parse_scommand(p, state);
         if (scommand_is_empty(cmd))
         {
+            scommand_destroy(cmd);
             break;
         }
         pipeline_push_back(result, cmd); // Agregar el comando al pipeline
-        bool is_pipe = false;            // Indica si hay otro comando por parsear
-        parser_skip_blanks(p);           // Saltar blancos antes de intentar leer un pipe
-        parser_op_pipe(p, &is_pipe);     // Intentar leer un pipe
-        if (is_pipe)
+        another_pipe = false;
+        if (!state->separated)
         {
-            cmd = parse_scommand(p);
-            error = (cmd == NULL); // Error si no se pudo parsear el siguiente comando
-        }
-        else
-        {
-            another_pipe = false;
+            bool is_pipe = false;        // Indica si hay otro comando por parsear
+            parser_skip_blanks(p);       // Saltar blancos antes de intentar leer un pipe
+            parser_op_pipe(p, &is_pipe); // Intentar leer un pipe
+            if (is_pipe)
+            {
+                bool is_or = false;
+                parser_op_pipe(p, &is_or);
+                state->op = is_or ? OP_OR : OP_END;
+                another_pipe = !is_or;
+            }
         }
     }
 
-    // Manejo del operador de background '&'
-    bool is_background = false;
-    parser_skip_blanks(p); // Saltar blancos antes de intentar leer un background
-    parser_op_background(p, &is_background);
-    if (is_background)
+    if (state->separated)
+    {
+        state->op = OP_SEQUENCE;
+    }
+    else if (state->op == OP_END)
     {
-        pipeline_set_wait(result, false);
+        // Manejo del operador de background '&'
+        bool is_background = false;
+        parser_skip_blanks(p); // Saltar blancos antes de intentar leer un background
+        parser_op_background(p, &is_background);
+        if (is_background)
+        {
+            bool is_and = false;
+            parser_op_background(p, &is_and);
+            state->op = is_and ? OP_AND : OP_BACKGROUND;
+            pipeline_set_wait(result, is_and);
+        }
     }
+    return result;
+}
 
-    // Consumir posibles blancos restantes y el \n final
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de consumir el final de la línea
+  -- consume posibles blancos restantes y el \n final; devuelve false si había algo más --
+------------------------------------------------------------------------------------------------
+*/
+static bool parse_end(Parser p, struct line_state *state)
+{
+    bool garbage = (state->pending != NULL);
+    free(state->pending);
+    state->pending = NULL;
     parser_skip_blanks(p);
-    bool garbage = false;
-    parser_garbage(p, &garbage);
-    if (garbage)
+    bool rest = false;
+    parser_garbage(p, &rest);
+    return !(garbage || rest);
+}
+
+/* ------------------------------------------------------------------------------------------------
+*               Función encargada de parsear un pipeline completo y devolverlo
+       -- toma un parser como parámetro y devuelve un pipeline, que se utilizará en el main --
+------------------------------------------------------------------------------------------------ */
+
+pipeline parse_pipeline(Parser p)
+{
+    struct line_state state = {true, NULL, false, false, OP_END};
+    parser_skip_blanks(p); // Saltar blancos antes de empezar
+    pipeline result = parse_sequence(p, &state);
+    // una sola tubería por línea: después de un ';', && o || ya es basura
+    bool single = (state.op == OP_END || state.op == OP_BACKGROUND);
+    if (!parse_end(p, &state) || !single || state.broken)
     {
         pipeline_destroy(result);
         result = NULL;
     }
+    return result;
+}
+
+/* ------------------------------------------------------------------------------------------------
+*               Función encargada de parsear todos los pipelines de una línea
+       -- cada uno guarda cómo se une con el anterior; las variables no se expanden acá --
+------------------------------------------------------------------------------------------------ */
+
+cmdlist parse_list(Parser p)
+{
+    cmdlist result = cmdlist_new();
+    struct line_state state = {false, NULL, false, false, OP_END};
+    cmdlist_connector connector = CMDLIST_ALWAYS;
+    bool error = false, another = true;
+    parser_skip_blanks(p);
 
-    if (error)
+    while (another && !error)
     {
-        pipeline_destroy(result);
-        result = NULL;
+        pipeline pipe = parse_sequence(p, &state);
+        if (pipeline_is_empty(pipe))
+        {
+            // "a ;" o "a &" pueden terminar la línea; "a &&" o "a ||" necesitan algo después
+            error = (connector != CMDLIST_ALWAYS) || state.op != OP_END;
+            pipeline_destroy(pipe);
+            break;
+        }
+        cmdlist_push_back(result, pipe, connector);
+        connector = (state.op == OP_AND) ? CMDLIST_AND : (state.op == OP_OR) ? CMDLIST_OR : CMDLIST_ALWAYS;
+        another = (state.op != OP_END);
+        if (another)
+        {
+            parser_skip_blanks(p);
+        }
     }
 
+    if (!parse_end(p, &state) || error || state.broken)
+    {
+        cmdlist_destroy(result);
+        result = NULL;
+    }
     return result;
 }
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de expandir las llaves, variables y nombres de archivo de un pipeline
+                                      de parse_list
+  -- se llama justo antes de ejecutarlo, así ve lo que asignaron los pipelines anteriores --
+------------------------------------------------------------------------------------------------
+*/
+bool expand_pipeline(pipeline apipe, int *status)
+{
+    assert(apipe != NULL && status != NULL);
+    GPtrArray *words = g_ptr_array_new();
+    bool runnable = true;
+    *status = EXIT_SUCCESS;
+    for (unsigned int i = 0; i < pipeline_length(apipe) && *status == EXIT_SUCCESS; i++)
+    {
+        scommand cmd = pipeline_nth(apipe, i);
+        for (unsigned int j = is_batch(cmd) ? 0 : scommand_length(cmd); j > 0; j--)
+        {
+            // cada palabra sale del frente y sus expansiones vuelven por detrás, en el mismo orden
+            g_ptr_array_set_size(words, 0);
+            expand_argument(scommand_steal_front(cmd), words);
+            for (unsigned int k = 0; k < words->len; k++)
+            {
+                scommand_push_back(cmd, g_ptr_array_index(words, k));
+            }
+        }
+        for (int redir = 0; redir < 2; redir++)
+        {
+            char *file = (redir == 0) ? scommand_get_redir_in(cmd) : scommand_get_redir_out(cmd);
+            if (file == NULL)
+            {
+                continue;
+            }
+            char *expanded = expand_redirection(file, words);
+            if (expanded == NULL)
+            {
+                // el pipeline entero falla, como en bash
+                *status = EXIT_FAILURE;
+                runnable = false;
+                break;
+            }
+            if (redir == 0)
+            {
+                scommand_set_redir_in(cmd, expanded);
+            }
+            else
+            {
+                scommand_set_redir_out(cmd, expanded);
+            }
+        }
+        runnable = runnable && !scommand_is_empty(cmd);
+    }
+    g_ptr_array_free(words, TRUE);
+    return runnable;
+}
+
+struct word_stream_s
+{
+    scommand words;   // palabras que todavía no se expandieron
+    brace generator;  // llaves de la palabra actual (NULL: hay que sacar otra)
+    GPtrArray *queue; // lo que dio la expansión actual (variables y nombres de archivo)
+    guint next;       // próxima palabra de queue
+};
+
+word_stream word_stream_new(scommand words)
+{
+    assert(words != NULL);
+    word_stream self = malloc(sizeof(struct word_stream_s));
+    assert(self != NULL);
+    self->words = words;
+    self->generator = NULL;
+    self->queue = g_ptr_array_new();
+    self->next = 0;
+    return self;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de dar la próxima palabra expandida
+  -- cada expansión de las llaves se expande recién cuando se acabó lo que dio la anterior:
+                 en memoria hay una sola a la vez, aunque el rango sea enorme --
+------------------------------------------------------------------------------------------------
+*/
+char *word_stream_next(word_stream self)
+{
+    assert(self != NULL);
+    while (self->next == self->queue->len)
+    {
+        g_ptr_array_set_size(self->queue, 0); // lo que ya se dio es del llamador
+        self->next = 0;
+        char *each = (self->generator != NULL) ? brace_next(self->generator) : NULL;
+        if (each == NULL && self->generator != NULL)
+        {
+            self->generator = brace_destroy(self->generator);
+        }
+        if (each == NULL)
+        {
+            if (scommand_is_empty(self->words))
+            {
+                return NULL;
+            }
+            char *word = scommand_steal_front(self->words);
+            if (brace_has_expression(word))
+            {
+                self->generator = brace_new(word);
+                free(word);
+                continue;
+            }
+            each = word;
+        }
+        expand_word(each, self->queue);
+    }
+    return g_ptr_array_index(self->queue, self->next++);
+}
+
+word_stream word_stream_destroy(word_stream self)
+{
+    assert(self != NULL);
+    // las palabras que ya se dieron no se liberan: son del llamador
+    for (guint i = self->next; i < self->queue->len; i++)
+    {
+        free(g_ptr_array_index(self->queue, i));
+    }
+    g_ptr_array_free(self->queue, TRUE);
+    if (self->generator != NULL)
+    {
+        brace_destroy(self->generator);
+    }
+    free(self);
+    return NULL;
+}
@@ -1,7 +1,11 @@
 #ifndef _PARSING_H_
 #define _PARSING_H_
 
+#include <stdbool.h>
+#include <glib.h>
+
 #include "command.h"
+#include "cmdlist.h"
 #include "parser.h"
 
 pipeline parse_pipeline(Parser parser);
@@ -18,9 +22,74 @@ pipeline parse_pipeline(Parser parser);
  *     El parser esta detenido justo luego de un \n o en el fin de archivo.
  *     Si lo que se consumió es un pipeline valido, el resultado contiene la
  *     estructura correspondiente.
+ *     Una línea con más de un pipeline (';', && o ||) es un error.
+ */
+
+cmdlist parse_list(Parser parser);
+/*
+ * Lee todos los pipelines de una línea, unidos por ';', '&', && o ||
+ * (a && b || c ; d), hasta el fin de línea (inclusive) o de archivo. Un ';'
+ * también corta una palabra ("a;b" son dos comandos).
+ * A diferencia de parse_pipeline, las variables no se expanden: hay que
+ * llamar a expand_pipeline justo antes de ejecutar cada pipeline.
+ * Devuelve una nueva lista (a liberar por el llamador; vacía si la línea no
+ * tenía comandos), o NULL si la línea tiene basura o un && o || sin nada
+ * después.
+ * REQUIRES:
+ *     parser != NULL
+ *     ! parser_at_eof (parser)
+ */
+
+void expand_word(char *word, GPtrArray *words);
+/*
+ * Expande las variables de `word' y después los nombres de archivo
+ * (pathname.h) de lo que resulta, sin las llaves. Solo se buscan archivos
+ * si la palabra tiene comodines fuera de comillas; entonces también cuentan
+ * los del valor de una variable sin comillas. Agrega el resultado a `words'
+ * (a liberar con free()).
+ * REQUIRES: word != NULL (pasa a ser del módulo) && words != NULL
+ */
+
+bool expand_pipeline(pipeline apipe, int *status);
+/*
+ * Expande las llaves (brace.h), las variables y los nombres de archivo
+ * (pathname.h) de las palabras de `apipe', y las variables de sus
+ * redirecciones (como parse_pipeline al parsear). Los argumentos de un
+ * comando batch quedan sin expandir: los expande batch con un word_stream,
+ * a medida que arma cada tanda.
+ * Devuelve false si no hay que ejecutar el pipeline, y deja en `status' su
+ * estado de salida:
+ *   EXIT_SUCCESS: algún comando simple quedó sin palabras (no hay nada que
+ *     ejecutar en esa etapa).
+ *   EXIT_FAILURE: una redirección no quedó en un solo archivo (se avisa
+ *     "ambiguous redirect" por stderr).
+ * REQUIRES: apipe != NULL && status != NULL
+ */
+
+typedef struct word_stream_s *word_stream;
+
+word_stream word_stream_new(scommand words);
+/*
+ * Nuevo generador de las expansiones de las palabras de `words', como las
+ * haría expand_pipeline pero de a una: una palabra {1..100000000} no se
+ * expande entera, sino una expansión por vez. Las palabras se sacan de
+ * `words' a medida que se usan.
+ * REQUIRES: words != NULL (sigue siendo del llamador, y tiene que vivir
+ *     tanto como el generador)
+ */
+
+char *word_stream_next(word_stream self);
+/*
+ * Devuelve la próxima palabra ya expandida, o NULL si no quedan.
+ * El resultado queda a cargo del llamador (free()).
+ * REQUIRES: self != NULL
+ */
+
+word_stream word_stream_destroy(word_stream self);
+/*
+ * Destruye el generador, con las expansiones que no se pidieron.
+ * REQUIRES: self != NULL
+ * ENSURES: result == NULL
  */
- 
-void set_flag_out_true(void);
-void set_flag_in_true(void);
 
 #endif
@@ -0,0 +1,346 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <glib.h>
+
+#include "pathname.h"
+#include "dircache.h"
+#include "strextra.h"
+#include "treewalk.h"
+
+#define PATTERN_SPECIAL "*?[\\" // caracteres que se escapan con '\' cuando estaban entre comillas
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de pasar una palabra a un patrón
+  -- saca las comillas y escapa con '\' los comodines que estaban entre ellas o después de
+     una '\'; `wildcard' indica si quedó alguno sin escapar (un '[' cuenta si lo sigue un ']') --
+------------------------------------------------------------------------------------------------
+*/
+static char *pattern_from_word(const char *word, bool *wildcard)
+{
+    GString *pattern = g_string_sized_new(strlen(word) + 8);
+    char quote = '\0';
+    *wildcard = false;
+    for (const char *c = word; *c != '\0'; c++)
+    {
+        if ((quote == '\0' && (*c == '\'' || *c == '"')) || (quote != '\0' && *c == quote))
+        {
+            quote = (quote == '\0') ? *c : '\0';
+            continue;
+        }
+        bool literal = (quote != '\0');
+        // entre comillas dobles la '\' solo escapa $ ` " y '\'
+        if (*c == '\\' && c[1] != '\0' && (quote == '\0' || (quote == '"' && strchr("$`\"\\", c[1]) != NULL)))
+        {
+            c++;
+            literal = true;
+        }
+        if (literal && strchr(PATTERN_SPECIAL, *c) != NULL)
+        {
+            g_string_append_c(pattern, '\\');
+        }
+        else if (!literal && (*c == '*' || *c == '?' || (*c == '[' && strchr(c + 1, ']') != NULL)))
+        {
+            *wildcard = true;
+        }
+        g_string_append_c(pattern, *c);
+    }
+    return g_string_free(pattern, FALSE);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de comparar un caracter con el [...] que empieza en `p'
+  -- deja en `next' lo que sigue al ']'. Devuelve false si no hay ']': el '[' es un caracter
+                                         más --
+------------------------------------------------------------------------------------------------
+*/
+static bool match_bracket(const char *p, unsigned char c, bool *matched, const char **next)
+{
+    const char *i = p + 1;
+    bool negate = (*i == '!' || *i == '^');
+    bool found = false;
+    i += negate;
+    for (bool first = true; first || *i != ']'; first = false)
+    {
+        if (*i == '\0')
+        {
+            return false;
+        }
+        if (*i == '\\' && i[1] != '\0')
+        {
+            i++;
+        }
+        unsigned char low = (unsigned char)*i++, high = low;
+        if (*i == '-' && i[1] != ']' && i[1] != '\0')
+        {
+            i += (i[1] == '\\' && i[2] != '\0') ? 2 : 1;
+            high = (unsigned char)*i++;
+        }
+        found = found || (low <= c && c <= high);
+    }
+    *matched = (found != negate);
+    *next = i + 1;
+    return true;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de comparar un nombre con el patrón de un componente
+  -- recorre los dos una sola vez: ante una diferencia vuelve al último '*', que pasa a
+                        cubrir un caracter más del nombre --
+------------------------------------------------------------------------------------------------
+*/
+static bool pattern_match(const char *p, const char *name)
+{
+    const char *star = NULL, *resume = NULL;
+    while (*name != '\0')
+    {
+        const char *next = p + 1;
+        bool matched = false;
+        if (*p == '*')
+        {
+            star = ++p;
+            resume = name;
+            continue;
+        }
+        if (*p == '?')
+        {
+            matched = true;
+        }
+        else if (*p != '[' || !match_bracket(p, (unsigned char)*name, &matched, &next))
+        {
+            if (*p == '\\' && p[1] != '\0')
+            {
+                next = ++p + 1;
+            }
+            matched = (*p != '\0' && *p == *name);
+        }
+
+        if (matched)
+        {
+            p = next;
+            name++;
+        }
+        else if (star != NULL)
+        {
+            p = star;
+            name = ++resume;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    while (*p == '*')
+    {
+        p++;
+    }
+    return *p == '\0';
+}
+
+// Copia en `out' el principio del patrón que no tiene comodines (sin las '\'); indica si es todo el patrón
+static bool literal_prefix(const char *p, GString *out)
+{
+    g_string_truncate(out, 0);
+    for (; *p != '\0'; p++)
+    {
+        if (*p == '*' || *p == '?' || *p == '[')
+        {
+            return false;
+        }
+        if (*p == '\\' && p[1] != '\0')
+        {
+            p++;
+        }
+        g_string_append_c(out, *p);
+    }
+    return true;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de extender cada ruta de `paths' con los nombres de su directorio que
+                               coinciden con un componente
+  -- el listado sale de dircache; con el prefijo sin comodines se busca el rango de nombres que
+     vale la pena comparar. Si no es el último componente solo sirven los directorios --
+------------------------------------------------------------------------------------------------
+*/
+static void match_component(GPtrArray *paths, const char *component, bool last, GPtrArray *result)
+{
+    GString *prefix = g_string_new(NULL);
+    literal_prefix(component, prefix);
+    bool hidden = (prefix->str[0] == '.');
+    for (guint i = 0; i < paths->len; i++)
+    {
+        const char *path = g_ptr_array_index(paths, i);
+        dir_listing listing = dircache_get((path[0] != '\0') ? path : ".", false, true);
+        if (listing == NULL)
+        {
+            continue;
+        }
+        unsigned int first = 0, end = 0;
+        dir_listing_prefix_range(listing, prefix->str, &first, &end);
+        for (unsigned int k = first; k < end; k++)
+        {
+            const char *name = dir_listing_name(listing, k);
+            if ((name[0] == '.' && !hidden) || (!last && !dir_listing_is_dir(listing, k)))
+            {
+                continue;
+            }
+            if (pattern_match(component, name))
+            {
+                g_ptr_array_add(result, path_join(path, name, !last));
+            }
+        }
+        dircache_release(listing);
+    }
+    g_string_free(prefix, TRUE);
+}
+
+// Lo que tiene que cumplir un nombre en el recorrido de un ** (es un treewalk_filter)
+struct tree_match
+{
+    const char *component;
+    bool dirs_only;
+    bool hidden;
+};
+
+static bool tree_filter(const char *name, bool is_dir, void *data)
+{
+    const struct tree_match *match = data;
+    return (name[0] != '.' || match->hidden) && (is_dir || !match->dirs_only) && pattern_match(match->component, name);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de expandir un ** seguido de un componente
+  -- ** son cero o más directorios: el componente se busca en todo el árbol de cada ruta, con
+                          los hilos de treewalk --
+------------------------------------------------------------------------------------------------
+*/
+static void match_tree(GPtrArray *paths, const char *component, bool dirs_only, GPtrArray *result)
+{
+    GString *prefix = g_string_new(NULL);
+    literal_prefix(component, prefix);
+    struct tree_match match = {component, dirs_only, prefix->str[0] == '.'};
+    for (guint i = 0; i < paths->len; i++)
+    {
+        GPtrArray *found = treewalk_find(g_ptr_array_index(paths, i), tree_filter, &match, 0);
+        for (guint k = 0; k < found->len; k++)
+        {
+            char *path = g_ptr_array_index(found, k);
+            g_ptr_array_add(result, dirs_only ? path_join(path, "", true) : path);
+            g_ptr_array_index(found, k) = dirs_only ? path : NULL;
+        }
+        g_ptr_array_free(found, TRUE);
+    }
+    g_string_free(prefix, TRUE);
+}
+
+static int path_compare(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+bool pathname_has_pattern(const char *word)
+{
+    assert(word != NULL);
+    if (strpbrk(word, "*?[") == NULL)
+    {
+        return false;
+    }
+    bool wildcard = false;
+    free(pattern_from_word(word, &wildcard));
+    return wildcard;
+}
+
+bool pathname_expand(const char *word, GPtrArray *words)
+{
+    assert(word != NULL && words != NULL);
+    bool wildcard = false;
+    char *pattern = (strpbrk(word, "*?[") != NULL) ? pattern_from_word(word, &wildcard) : NULL;
+    if (!wildcard)
+    {
+        free(pattern);
+        return false;
+    }
+    char **components = g_strsplit(pattern, "/", -1);
+    GPtrArray *paths = g_ptr_array_new_with_free_func(free);
+    g_ptr_array_add(paths, strdup((pattern[0] == '/') ? "/" : ""));
+    GString *literal = g_string_new(NULL);
+    bool scattered = false; // hay nombres que salieron de más de un directorio: el orden no es el de los listados
+    bool check = false;     // el último componente no tenía comodines: falta ver si existe
+    for (unsigned int i = 0; components[i] != NULL && paths->len > 0; i++)
+    {
+        bool last = (components[i + 1] == NULL);
+        if (components[i][0] == '\0')
+        {
+            continue; // antes de una '/' al principio, o entre dos seguidas
+        }
+        GPtrArray *next = g_ptr_array_new_with_free_func(free);
+        if (strcmp(components[i], "**") == 0)
+        {
+            // varios ** seguidos valen uno; al final (o antes de una '/' final) es cualquier nombre
+            while (components[i + 1] != NULL && strcmp(components[i + 1], "**") == 0)
+            {
+                i++;
+            }
+            const char *target = components[i + 1];
+            for (guint k = 0; k < paths->len && target == NULL; k++)
+            {
+                // un ** al final también da el directorio donde empieza (el actual no)
+                const char *path = g_ptr_array_index(paths, k);
+                if (path[0] != '\0')
+                {
+                    g_ptr_array_add(next, strdup(path));
+                }
+            }
+            bool dirs_only = (target != NULL && (target[0] == '\0' || components[i + 2] != NULL));
+            match_tree(paths, (target != NULL && target[0] != '\0') ? target : "*", dirs_only, next);
+            i += (target != NULL);
+            scattered = true;
+            check = false;
+        }
+        else if (literal_prefix(components[i], literal))
+        {
+            for (guint k = 0; k < paths->len; k++)
+            {
+                g_ptr_array_add(next, path_join(g_ptr_array_index(paths, k), literal->str, !last));
+            }
+            check = last;
+        }
+        else
+        {
+            scattered = scattered || paths->len > 1;
+            match_component(paths, components[i], last, next);
+            check = false;
+        }
+        g_ptr_array_free(paths, TRUE);
+        paths = next;
+    }
+
+    guint added = words->len;
+    for (guint i = 0; i < paths->len; i++)
+    {
+        struct stat st;
+        char *path = g_ptr_array_index(paths, i);
+        if (!check || lstat(path, &st) == 0)
+        {
+            g_ptr_array_index(paths, i) = NULL;
+            g_ptr_array_add(words, path);
+        }
+    }
+    if (scattered)
+    {
+        qsort(words->pdata + added, words->len - added, sizeof(gpointer), path_compare);
+    }
+    bool found = (words->len > added);
+    g_ptr_array_free(paths, TRUE);
+    g_string_free(literal, TRUE);
+    g_strfreev(components);
+    free(pattern);
+    return found;
+}
@@ -0,0 +1,43 @@
+/* Expansión de nombres de archivo: *, ? y [...].
+ * Una palabra con alguno de esos caracteres fuera de comillas es un patrón y
+ * se reemplaza por los nombres que coinciden, ordenados con strcmp() (el
+ * orden de bytes del locale C, sin strcoll). Si no coincide ninguno la
+ * palabra queda como está, como en bash.
+ *
+ * El patrón se compara de a un componente (lo que hay entre dos '/') contra
+ * los listados de dircache, dentro del mismo proceso: un directorio que no
+ * cambió desde la última vez no se vuelve a leer, solo se le hace un stat().
+ * Un '*' o un '?' no coinciden con el '.' del principio de un nombre (los
+ * archivos ocultos aparecen solo si el componente empieza con '.').
+ * En [...] valen los rangos (a-z) y la negación con '!' o '^'; un ']' justo
+ * después del '[' (o de la negación) es un caracter más. Lo que está entre
+ * comillas o después de una '\' no es especial.
+ *
+ * Un componente que es solo ** vale por cero o más directorios (el globstar
+ * de bash): ** seguido del componente *.log da los .log de todo el árbol.
+ * Esos árboles no se leen con dircache sino con treewalk, en paralelo y sin
+ * guardar nada.
+ */
+
+#ifndef PATHNAME_H
+#define PATHNAME_H
+
+#include <stdbool.h>
+#include <glib.h>
+
+bool pathname_has_pattern(const char *word);
+/*
+ * Indica si `word' tiene algún comodín fuera de comillas.
+ * Requires: word != NULL
+ */
+
+bool pathname_expand(const char *word, GPtrArray *words);
+/*
+ * Agrega a `words' los nombres que coinciden con el patrón `word'.
+ *   words: las palabras agregadas quedan a cargo del llamador (free()).
+ *   Returns: false si `word' no es un patrón o no coincidió con ningún
+ *     nombre; en ese caso no se agrega nada.
+ * Requires: word != NULL && words != NULL
+ */
+
+#endif /* PATHNAME_H */
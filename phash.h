@@ -0,0 +1,31 @@
+/* Función de hash de los nombres de los comandos internos.
+ * La usan builtin.c y el generador de tablas (tools/gentables.c), que en
+ * tiempo de compilación busca una semilla con la que ningún par de nombres
+ * cae en la misma posición de la tabla (hash perfecto).
+ */
+
+#ifndef PHASH_H
+#define PHASH_H
+
+#include <stdint.h>
+
+static inline uint32_t phash(const char *s, uint32_t seed)
+{
+    uint32_t h = 2166136261u ^ seed; // FNV-1a
+    for (; *s != '\0'; s++)
+    {
+        h = (h ^ (unsigned char)*s) * 16777619u;
+    }
+    h ^= h >> 15; // mezcla final: así los bits altos dependen de todo el nombre
+    h *= 0x2c1b3c6du;
+    h ^= h >> 12;
+    return h;
+}
+
+/* Posición de `s' en una tabla de 2^bits lugares */
+static inline uint32_t phash_slot(const char *s, uint32_t seed, unsigned int bits)
+{
+    return phash(s, seed) & ((1u << bits) - 1);
+}
+
+#endif /* PHASH_H */
@@ -0,0 +1,467 @@
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <glib.h>
+
+#include "print.h"
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024 // Máximo de iovec por llamada a writev (el de Linux)
+#endif
+#define FORMAT_CACHE_SIZE 64 // Formatos de printf compilados que se guardan
+#define FLAGS "-+ #0"        // Banderas de una conversión de printf
+
+/* Un pedazo de un formato de printf ya compilado: un texto fijo o una
+ * conversión que consume un argumento.
+ */
+typedef struct
+{
+    char conversion; // 0 si es texto fijo; si no, la letra de la conversión
+    char *text;      // texto fijo (con las '\' ya interpretadas), o el formato de C de la conversión
+    size_t length;   // largo de `text'
+    bool stop;       // el texto terminaba en \c: no se escribe nada más
+} format_piece;
+
+typedef struct
+{
+    GArray *pieces;           // format_piece, en orden
+    unsigned int conversions; // cuántos pedazos consumen un argumento
+} compiled_format;
+
+static GHashTable *formats = NULL; // formato -> compiled_format *
+
+static bool simple_escape(char c, char *value)
+{
+    static const char escapes[][2] = {{'\\', '\\'}, {'a', '\a'}, {'b', '\b'}, {'e', '\033'}, {'f', '\f'},
+                                      {'n', '\n'},   {'r', '\r'}, {'t', '\t'}, {'v', '\v'}};
+    for (unsigned int i = 0; i < G_N_ELEMENTS(escapes); i++)
+    {
+        if (escapes[i][0] == c)
+        {
+            *value = escapes[i][1];
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de interpretar las secuencias con '\' en el mismo lugar
+  -- el resultado nunca es más largo que el original. En echo y en %b los octales son \0nnn;
+     en el formato de printf, \nnn. Devuelve el largo nuevo; `stop' queda en true si se
+                         encontró \c (lo que sigue se descarta) --
+------------------------------------------------------------------------------------------------
+*/
+static size_t expand_escapes(char *text, size_t length, bool octal_zero, bool *stop)
+{
+    size_t r = 0, w = 0;
+    *stop = false;
+    while (r < length)
+    {
+        if (text[r] != '\\' || r + 1 == length)
+        {
+            text[w++] = text[r++];
+            continue;
+        }
+        char c = text[r + 1], value;
+        r += 2;
+        if (c == 'c')
+        {
+            *stop = true;
+            return w;
+        }
+        else if (simple_escape(c, &value))
+        {
+            text[w++] = value;
+        }
+        else if (c == 'x' && r < length && g_ascii_isxdigit(text[r]))
+        {
+            int code = 0;
+            for (unsigned int digits = 0; digits < 2 && r < length && g_ascii_isxdigit(text[r]); digits++)
+            {
+                code = code * 16 + g_ascii_xdigit_value(text[r]);
+                r++;
+            }
+            text[w++] = (char)code;
+        }
+        else if ((octal_zero && c == '0') || (!octal_zero && c >= '0' && c <= '7'))
+        {
+            int code = octal_zero ? 0 : c - '0';
+            unsigned int max_digits = octal_zero ? 3 : 2;
+            for (unsigned int digits = 0; digits < max_digits && r < length && text[r] >= '0' && text[r] <= '7';
+                 digits++)
+            {
+                code = code * 8 + (text[r++] - '0');
+            }
+            text[w++] = (char)code;
+        }
+        else
+        {
+            // secuencia desconocida: queda como está
+            text[w++] = '\\';
+            text[w++] = c;
+        }
+    }
+    return w;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de escribir los iovec en stdout
+  -- lo que quedó en el buffer de stdio se escribe antes; se reintenta si writev escribe menos
+                               de lo pedido --
+------------------------------------------------------------------------------------------------
+*/
+static bool write_iovecs(struct iovec *iov, unsigned int count)
+{
+    fflush(stdout);
+    while (count > 0)
+    {
+        ssize_t written = writev(STDOUT_FILENO, iov, MIN(count, IOV_MAX));
+        if (written < 0)
+        {
+            if (errno != EINTR)
+            {
+                perror("write");
+                return false;
+            }
+            continue;
+        }
+        while (count > 0 && (size_t)written >= iov->iov_len)
+        {
+            written -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0)
+        {
+            iov->iov_base = (char *)iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+    return true;
+}
+
+// ¿Es `option' un grupo de opciones de echo ("-n", "-ne", "-E"...)?
+static bool is_echo_option(const char *option)
+{
+    return option[0] == '-' && option[1] != '\0' && strspn(option + 1, "neE") == strlen(option + 1);
+}
+
+int echo_run(scommand args)
+{
+    assert(args != NULL);
+    bool newline = true, escapes = false;
+    while (!scommand_is_empty(args) && is_echo_option(scommand_front(args)))
+    {
+        for (const char *c = scommand_front(args) + 1; *c != '\0'; c++)
+        {
+            newline = newline && *c != 'n';
+            escapes = (*c == 'e') || (escapes && *c != 'E');
+        }
+        scommand_pop_front(args);
+    }
+
+    // las palabras se sacan del comando sin copiarlas y van directo a los iovec
+    unsigned int count = scommand_length(args);
+    char **words = malloc((count + 1) * sizeof(char *));
+    struct iovec *iov = malloc((2 * count + 1) * sizeof(struct iovec));
+    unsigned int used = 0;
+    bool stop = false;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        words[i] = scommand_steal_front(args);
+        if (stop)
+        {
+            continue;
+        }
+        size_t length = strlen(words[i]);
+        if (escapes)
+        {
+            length = expand_escapes(words[i], length, true, &stop);
+        }
+        if (i > 0)
+        {
+            iov[used++] = (struct iovec){" ", 1};
+        }
+        iov[used++] = (struct iovec){words[i], length};
+    }
+    if (newline && !stop)
+    {
+        iov[used++] = (struct iovec){"\n", 1};
+    }
+    bool written = write_iovecs(iov, used);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        free(words[i]);
+    }
+    free(iov);
+    free(words);
+    return written ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static void free_format(gpointer data)
+{
+    compiled_format *format = data;
+    for (unsigned int i = 0; i < format->pieces->len; i++)
+    {
+        g_free(g_array_index(format->pieces, format_piece, i).text);
+    }
+    g_array_free(format->pieces, TRUE);
+    free(format);
+}
+
+static void add_text(compiled_format *format, const char *text, size_t length)
+{
+    if (length == 0)
+    {
+        return;
+    }
+    format_piece piece = {0, g_strndup(text, length), 0, false};
+    piece.length = expand_escapes(piece.text, length, false, &piece.stop);
+    g_array_append_val(format->pieces, piece);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de compilar un formato de printf
+  -- cada conversión se traduce al formato de C que la escribe (con el modificador de largo
+     que corresponde al tipo con que se lee el argumento). Devuelve NULL (y avisa) si el
+                       formato tiene una conversión inválida --
+------------------------------------------------------------------------------------------------
+*/
+static compiled_format *compile_format(const char *text)
+{
+    compiled_format *format = malloc(sizeof(compiled_format));
+    assert(format != NULL);
+    format->pieces = g_array_new(FALSE, FALSE, sizeof(format_piece));
+    format->conversions = 0;
+    const char *start = text;
+    while (*start != '\0')
+    {
+        const char *percent = strchr(start, '%');
+        if (percent == NULL)
+        {
+            add_text(format, start, strlen(start));
+            break;
+        }
+        add_text(format, start, percent - start);
+        if (percent[1] == '%')
+        {
+            add_text(format, "%", 1);
+            start = percent + 2;
+            continue;
+        }
+        // %[banderas][ancho][.precisión]conversión
+        const char *end = percent + 1;
+        end += strspn(end, FLAGS);
+        end += strspn(end, "0123456789");
+        if (*end == '.')
+        {
+            end++;
+            end += strspn(end, "0123456789");
+        }
+        const char *modifier = NULL;
+        switch (*end)
+        {
+        case 'd':
+        case 'i':
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+            modifier = "ll";
+            break;
+        case 'c':
+        case 's':
+        case 'b':
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+            modifier = "";
+            break;
+        default:
+            break;
+        }
+        if (modifier == NULL)
+        {
+            if (*end == '\0')
+            {
+                fprintf(stderr, "printf: %s: missing format character\n", percent);
+            }
+            else
+            {
+                fprintf(stderr, "printf: %%%c: invalid format character\n", *end);
+            }
+            free_format(format);
+            return NULL;
+        }
+        // %b se escribe como %s una vez interpretadas las '\' del argumento
+        char conversion = (*end == 'b') ? 's' : *end;
+        format_piece piece = {*end, g_strdup_printf("%.*s%s%c", (int)(end - percent), percent, modifier, conversion),
+                              0, false};
+        piece.length = strlen(piece.text);
+        g_array_append_val(format->pieces, piece);
+        format->conversions++;
+        start = end + 1;
+    }
+    return format;
+}
+
+static const compiled_format *lookup_format(const char *text)
+{
+    if (formats == NULL)
+    {
+        formats = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, free_format);
+    }
+    compiled_format *format = g_hash_table_lookup(formats, text);
+    if (format == NULL)
+    {
+        format = compile_format(text);
+        if (format == NULL)
+        {
+            return NULL;
+        }
+        if (g_hash_table_size(formats) >= FORMAT_CACHE_SIZE)
+        {
+            g_hash_table_remove_all(formats); // un script no suele usar tantos formatos distintos
+        }
+        g_hash_table_insert(formats, g_strdup(text), format);
+    }
+    return format;
+}
+
+// Valor numérico de un argumento; 'x o "x es el código del carácter, como en POSIX
+static bool numeric_argument(const char *arg, long long *integer, double *real)
+{
+    if (arg[0] == '\'' || arg[0] == '"')
+    {
+        *integer = (unsigned char)arg[1];
+        *real = *integer;
+        return true;
+    }
+    char *end;
+    errno = 0;
+    *integer = strtoll(arg, &end, 0);
+    bool ok = arg[0] == '\0' || (*end == '\0' && errno == 0);
+    errno = 0;
+    *real = strtod(arg, &end);
+    ok = ok || (*end == '\0' && errno == 0);
+    if (!ok)
+    {
+        fprintf(stderr, "printf: %s: invalid number\n", arg);
+    }
+    return ok;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de escribir una conversión con su argumento
+   -- devuelve false si el argumento era un %b con \c: no se escribe nada más. Si no era un
+                  número válido, `invalid' pasa a true --
+------------------------------------------------------------------------------------------------
+*/
+static bool append_conversion(GString *out, const format_piece *piece, const char *arg, bool *invalid)
+{
+    long long integer = 0;
+    double real = 0;
+    bool stop = false;
+    switch (piece->conversion)
+    {
+    case 's':
+        g_string_append_printf(out, piece->text, arg);
+        break;
+    case 'b':
+    {
+        char *expanded = g_strdup(arg);
+        expanded[expand_escapes(expanded, strlen(expanded), true, &stop)] = '\0';
+        g_string_append_printf(out, piece->text, expanded);
+        g_free(expanded);
+        break;
+    }
+    case 'c':
+        if (arg[0] != '\0')
+        {
+            g_string_append_printf(out, piece->text, arg[0]);
+        }
+        break;
+    case 'd':
+    case 'i':
+    case 'o':
+    case 'u':
+    case 'x':
+    case 'X':
+        *invalid = !numeric_argument(arg, &integer, &real) || *invalid;
+        g_string_append_printf(out, piece->text, integer);
+        break;
+    default:
+        *invalid = !numeric_argument(arg, &integer, &real) || *invalid;
+        g_string_append_printf(out, piece->text, real);
+        break;
+    }
+    return !stop;
+}
+
+int printf_run(scommand args)
+{
+    assert(args != NULL);
+    if (scommand_is_empty(args))
+    {
+        fprintf(stderr, "printf: usage: printf format [arguments]\n");
+        return EXIT_FAILURE;
+    }
+    const compiled_format *format = lookup_format(scommand_front(args));
+    scommand_pop_front(args);
+    if (format == NULL)
+    {
+        return EXIT_FAILURE;
+    }
+    unsigned int count = scommand_length(args);
+    char **values = malloc((count + 1) * sizeof(char *));
+    for (unsigned int i = 0; i < count; i++)
+    {
+        values[i] = scommand_steal_front(args);
+    }
+
+    GString *out = g_string_new(NULL);
+    unsigned int next = 0;
+    bool go_on = true, invalid = false;
+    do
+    {
+        for (unsigned int i = 0; go_on && i < format->pieces->len; i++)
+        {
+            const format_piece *piece = &g_array_index(format->pieces, format_piece, i);
+            if (piece->conversion == 0)
+            {
+                g_string_append_len(out, piece->text, piece->length);
+                go_on = !piece->stop;
+            }
+            else
+            {
+                // los argumentos que faltan valen "" (o 0)
+                go_on = append_conversion(out, piece, (next < count) ? values[next] : "", &invalid);
+                next++;
+            }
+        }
+    } while (go_on && format->conversions > 0 && next < count);
+
+    struct iovec iov = {out->str, out->len};
+    bool written = write_iovecs(&iov, 1);
+    g_string_free(out, TRUE);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        free(values[i]);
+    }
+    free(values);
+    return (written && !invalid) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,38 @@
+/* Comandos internos echo y printf.
+ * Los dos arman toda su salida antes de escribirla, y la escriben con una
+ * sola llamada al sistema (writev en echo, write en printf), en lugar de
+ * pasar por stdio palabra por palabra.
+ */
+
+#ifndef PRINT_H
+#define PRINT_H
+
+#include "command.h"
+
+int echo_run(scommand args);
+/*
+ * Ejecuta echo. Los argumentos (sin el "echo") se consumen de `args'.
+ * Escribe los argumentos separados por un espacio y terminados en '\n'.
+ *   -n  no escribir el '\n' final
+ *   -e  interpretar secuencias con '\' (\n, \t, \0nnn, \xHH, \c, ...)
+ *   -E  no interpretarlas (es lo que se hace por defecto)
+ * Las opciones se pueden juntar ("-ne").
+ *   Returns: EXIT_SUCCESS, o EXIT_FAILURE si no se pudo escribir.
+ * Requires: args != NULL
+ */
+
+int printf_run(scommand args);
+/*
+ * Ejecuta printf. Los argumentos (sin el "printf") se consumen de `args':
+ *   printf format [arg...]
+ * Acepta las conversiones %d %i %o %u %x %X %c %s %b %e %E %f %F %g %G y
+ * %%, con banderas, ancho y precisión. Si sobran argumentos, el formato se
+ * vuelve a usar hasta consumirlos. Cada formato se compila una sola vez y se
+ * guarda, así que repetir el mismo printf no lo vuelve a interpretar.
+ *   Returns: EXIT_SUCCESS, o EXIT_FAILURE si falta el formato o no es
+ *     válido, algún argumento no era un número o no se pudo escribir. Un
+ *     argumento inválido se informa y vale 0, pero se sigue escribiendo.
+ * Requires: args != NULL
+ */
+
+#endif /* PRINT_H */
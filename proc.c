@@ -0,0 +1,413 @@
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <glib.h>
+
+#include "proc.h"
+#include "getdents.h"
+
+#define STAT_BUFFER 1024          // /proc/<pid>/stat ocupa unos 300 bytes
+#define CMDLINE_BUFFER 4096       // Se muestran como mucho estos bytes de los argumentos
+#define PROC_PIDS_PER_THREAD 1024 // Con menos procesos por hilo no conviene repartir
+
+static long page_kb = 4; // tamaño de página en KiB (se averigua en proc_scan)
+
+/* Parte de la tabla que lee un hilo: un tramo contiguo de pids, con sus
+ * propios arreglos para que los hilos no compartan nada mientras leen.
+ */
+struct scan_chunk
+{
+    int procfd;
+    const pid_t *pids;
+    unsigned int count;
+    unsigned int flags;
+    GArray *procs;    // proc_info leídos, en el orden de `pids'
+    GString *strings; // sus cmdline
+    GArray *offsets;  // posición del cmdline de cada uno dentro de `strings'
+};
+
+/* Todo lo que usa una lectura queda en la tabla, para que proc_refresh() no
+ * vuelva a pedir memoria ni a abrir /proc.
+ */
+struct proc_table_s
+{
+    GArray *procs;        // proc_info, en orden de pid
+    GString *strings;     // los cmdline, uno tras otro, cada uno terminado en '\0'
+    GArray *offsets;      // posición de cada cmdline dentro de `strings' (se arma al unir los tramos)
+    GArray *pids;         // pids listados en la última lectura
+    char *dents;          // buffer para getdents64
+    int procfd;           // descriptor de /proc
+    unsigned int threads; // hilos pedidos (0: automático)
+    struct scan_chunk chunks[PROC_MAX_THREADS];
+};
+
+static gint compare_pids(gconstpointer a, gconstpointer b)
+{
+    pid_t x = *(const pid_t *)a, y = *(const pid_t *)b;
+    return (x > y) - (x < y);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de listar los pids de /proc
+         -- las entradas que no son números (self, sys, meminfo...) no son procesos --
+------------------------------------------------------------------------------------------------
+*/
+static void list_pids(int procfd, GArray *pids, char *buffer)
+{
+    g_array_set_size(pids, 0);
+    lseek(procfd, 0, SEEK_SET);
+    long nread;
+    while ((nread = syscall(SYS_getdents64, procfd, buffer, GETDENTS_BUFFER)) > 0)
+    {
+        for (long pos = 0; pos < nread;)
+        {
+            struct linux_dirent64 *d = (struct linux_dirent64 *)(buffer + pos);
+            pos += d->d_reclen;
+            if (d->d_name[0] < '1' || d->d_name[0] > '9')
+            {
+                continue;
+            }
+            pid_t pid = 0;
+            const char *c = d->d_name;
+            while (*c >= '0' && *c <= '9')
+            {
+                pid = pid * 10 + (*c++ - '0');
+            }
+            if (*c == '\0')
+            {
+                g_array_append_val(pids, pid);
+            }
+        }
+    }
+    g_array_sort(pids, compare_pids); // /proc ya los da en orden, pero no lo promete
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de leer un archivo chico de /proc/<pid> con un solo pread
+                 -- devuelve la cantidad de bytes leídos, o -1 si no se pudo --
+------------------------------------------------------------------------------------------------
+*/
+static ssize_t read_proc_file(int procfd, pid_t pid, const char *name, char *buffer, size_t size)
+{
+    char path[32];
+    snprintf(path, sizeof(path), "%d/%s", (int)pid, name);
+    int fd = openat(procfd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    ssize_t nread = pread(fd, buffer, size, 0);
+    close(fd);
+    return nread;
+}
+
+static long long next_field(char **cursor)
+{
+    return strtoll(*cursor, cursor, 10);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de interpretar /proc/<pid>/stat
+  -- el nombre va entre paréntesis y puede contener ')' o espacios: los campos numéricos
+                       empiezan después del último ')' (ver proc(5)) --
+------------------------------------------------------------------------------------------------
+*/
+static bool parse_stat(char *buffer, proc_info *info)
+{
+    char *name_start = strchr(buffer, '(');
+    char *name_end = strrchr(buffer, ')');
+    if (name_start == NULL || name_end == NULL || name_end < name_start || name_end[1] != ' ')
+    {
+        return false;
+    }
+    size_t comm_len = MIN((size_t)(name_end - name_start - 1), (size_t)PROC_COMM_SIZE - 1);
+    memcpy(info->comm, name_start + 1, comm_len);
+    info->comm[comm_len] = '\0';
+
+    char *cursor = name_end + 2;
+    info->state = *cursor++;
+    info->ppid = next_field(&cursor); // campo 4
+    for (unsigned int field = 5; field < 14; field++)
+    {
+        next_field(&cursor); // pgrp, session, tty_nr, tpgid, flags, minflt, cminflt, majflt, cmajflt
+    }
+    info->cpu_ticks = next_field(&cursor);  // 14: utime
+    info->cpu_ticks += next_field(&cursor); // 15: stime
+    for (unsigned int field = 16; field < 20; field++)
+    {
+        next_field(&cursor); // cutime, cstime, priority, nice
+    }
+    info->threads = next_field(&cursor); // 20
+    next_field(&cursor);                 // 21: itrealvalue
+    info->start_ticks = next_field(&cursor);
+    next_field(&cursor); // 23: vsize
+    long long rss_pages = next_field(&cursor);
+    info->rss_kb = rss_pages * page_kb;
+    return true;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de leer un proceso
+    -- devuelve false si terminó antes de poder leerlo; el cmdline queda en `strings' y
+                       en `cmdline' su posición dentro de ese bloque --
+------------------------------------------------------------------------------------------------
+*/
+static bool read_process(int procfd, pid_t pid, unsigned int flags, proc_info *info,
+                         GString *strings, size_t *cmdline)
+{
+    char buffer[CMDLINE_BUFFER];
+    ssize_t nread = read_proc_file(procfd, pid, "stat", buffer, STAT_BUFFER - 1);
+    if (nread <= 0)
+    {
+        return false;
+    }
+    buffer[nread] = '\0';
+    info->pid = pid;
+    if (!parse_stat(buffer, info))
+    {
+        return false;
+    }
+    info->uid = 0;
+    if (flags & PROC_OWNER)
+    {
+        struct stat st;
+        char name[16];
+        snprintf(name, sizeof(name), "%d", (int)pid);
+        if (fstatat(procfd, name, &st, 0) == 0)
+        {
+            info->uid = st.st_uid;
+        }
+    }
+    *cmdline = strings->len;
+    if (flags & PROC_CMDLINE)
+    {
+        nread = read_proc_file(procfd, pid, "cmdline", buffer, sizeof(buffer));
+        // los argumentos vienen separados por '\0'; el último '\0' se descarta
+        while (nread > 0 && buffer[nread - 1] == '\0')
+        {
+            nread--;
+        }
+        for (ssize_t i = 0; i < nread; i++)
+        {
+            if (buffer[i] == '\0' || buffer[i] == '\n')
+            {
+                buffer[i] = ' ';
+            }
+        }
+        g_string_append_len(strings, buffer, MAX(nread, 0));
+    }
+    g_string_append_c(strings, '\0');
+    return true;
+}
+
+static void *scan_chunk(void *arg)
+{
+    struct scan_chunk *chunk = arg;
+    g_array_set_size(chunk->procs, 0);
+    g_string_truncate(chunk->strings, 0);
+    g_array_set_size(chunk->offsets, 0);
+    for (unsigned int i = 0; i < chunk->count; i++)
+    {
+        proc_info info;
+        size_t offset;
+        if (read_process(chunk->procfd, chunk->pids[i], chunk->flags, &info, chunk->strings, &offset))
+        {
+            g_array_append_val(chunk->procs, info);
+            g_array_append_val(chunk->offsets, offset);
+        }
+    }
+    return NULL;
+}
+
+static unsigned int default_threads(unsigned int pids)
+{
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned int threads = (cores > 0) ? (unsigned int)cores : 1;
+    threads = MIN(threads, PROC_MAX_THREADS);
+    return MAX(1u, MIN(threads, pids / PROC_PIDS_PER_THREAD));
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de unir los tramos en la tabla
+  -- los tramos se recorren en orden, así que la tabla queda ordenada por pid sin importar
+                            cuál hilo terminó primero --
+------------------------------------------------------------------------------------------------
+*/
+static void merge_chunks(proc_table table, unsigned int count)
+{
+    g_array_set_size(table->procs, 0);
+    g_string_truncate(table->strings, 0);
+    g_array_set_size(table->offsets, 0);
+    for (unsigned int c = 0; c < count; c++)
+    {
+        struct scan_chunk *chunk = &table->chunks[c];
+        size_t base = table->strings->len;
+        g_array_append_vals(table->procs, chunk->procs->data, chunk->procs->len);
+        g_string_append_len(table->strings, chunk->strings->str, chunk->strings->len);
+        for (unsigned int i = 0; i < chunk->offsets->len; i++)
+        {
+            size_t offset = base + g_array_index(chunk->offsets, size_t, i);
+            g_array_append_val(table->offsets, offset);
+        }
+    }
+    // el bloque ya no crece: recién ahora se pueden armar los punteros
+    for (unsigned int i = 0; i < table->procs->len; i++)
+    {
+        g_array_index(table->procs, proc_info, i).cmdline =
+            table->strings->str + g_array_index(table->offsets, size_t, i);
+    }
+}
+
+void proc_refresh(proc_table table, unsigned int flags)
+{
+    assert(table != NULL);
+    list_pids(table->procfd, table->pids, table->dents);
+    unsigned int threads = (table->threads == 0) ? default_threads(table->pids->len) : table->threads;
+    threads = MAX(1u, MIN(threads, MAX(table->pids->len, 1u)));
+
+    // cada hilo lee un tramo contiguo; el primero lo lee este mismo hilo
+    pthread_t workers[PROC_MAX_THREADS];
+    bool started[PROC_MAX_THREADS];
+    for (unsigned int c = 0; c < threads; c++)
+    {
+        struct scan_chunk *chunk = &table->chunks[c];
+        unsigned int first = (unsigned long)table->pids->len * c / threads;
+        unsigned int last = (unsigned long)table->pids->len * (c + 1) / threads;
+        if (chunk->procs == NULL)
+        {
+            chunk->procs = g_array_new(FALSE, FALSE, sizeof(proc_info));
+            chunk->strings = g_string_new(NULL);
+            chunk->offsets = g_array_new(FALSE, FALSE, sizeof(size_t));
+        }
+        chunk->procfd = table->procfd;
+        chunk->pids = &g_array_index(table->pids, pid_t, first);
+        chunk->count = last - first;
+        chunk->flags = flags;
+        started[c] = c > 0 && pthread_create(&workers[c], NULL, scan_chunk, chunk) == 0;
+    }
+    for (unsigned int c = 0; c < threads; c++)
+    {
+        if (started[c])
+        {
+            pthread_join(workers[c], NULL);
+        }
+        else
+        {
+            scan_chunk(&table->chunks[c]); // el primer tramo, o uno cuyo hilo no se pudo crear
+        }
+    }
+    merge_chunks(table, threads);
+}
+
+proc_table proc_scan_threads(unsigned int flags, unsigned int threads)
+{
+    int procfd = open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (procfd < 0)
+    {
+        return NULL;
+    }
+    page_kb = sysconf(_SC_PAGESIZE) / 1024;
+    proc_table table = calloc(1, sizeof(struct proc_table_s));
+    assert(table != NULL);
+    table->procs = g_array_new(FALSE, FALSE, sizeof(proc_info));
+    table->strings = g_string_new(NULL);
+    table->offsets = g_array_new(FALSE, FALSE, sizeof(size_t));
+    table->pids = g_array_new(FALSE, FALSE, sizeof(pid_t));
+    table->dents = malloc(GETDENTS_BUFFER);
+    table->procfd = procfd;
+    table->threads = MIN(threads, PROC_MAX_THREADS);
+    proc_refresh(table, flags);
+    return table;
+}
+
+proc_table proc_scan(unsigned int flags)
+{
+    return proc_scan_threads(flags, 0);
+}
+
+unsigned int proc_table_length(const proc_table table)
+{
+    assert(table != NULL);
+    return table->procs->len;
+}
+
+const proc_info *proc_table_get(const proc_table table, unsigned int i)
+{
+    assert(table != NULL && i < table->procs->len);
+    return &g_array_index(table->procs, proc_info, i);
+}
+
+void proc_table_destroy(proc_table table)
+{
+    assert(table != NULL);
+    for (unsigned int c = 0; c < PROC_MAX_THREADS && table->chunks[c].procs != NULL; c++)
+    {
+        g_array_free(table->chunks[c].procs, TRUE);
+        g_string_free(table->chunks[c].strings, TRUE);
+        g_array_free(table->chunks[c].offsets, TRUE);
+    }
+    g_array_free(table->procs, TRUE);
+    g_string_free(table->strings, TRUE);
+    g_array_free(table->offsets, TRUE);
+    g_array_free(table->pids, TRUE);
+    free(table->dents);
+    close(table->procfd);
+    free(table);
+}
+
+bool proc_get(pid_t pid, proc_info *info)
+{
+    assert(info != NULL);
+    int procfd = open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (procfd < 0)
+    {
+        return false;
+    }
+    page_kb = sysconf(_SC_PAGESIZE) / 1024;
+    GString *strings = g_string_new(NULL);
+    size_t offset;
+    bool found = read_process(procfd, pid, 0, info, strings, &offset);
+    info->cmdline = "";
+    g_string_free(strings, TRUE);
+    close(procfd);
+    return found;
+}
+
+int proc_pidfd_open(pid_t pid)
+{
+#ifdef SYS_pidfd_open
+    int pidfd = syscall(SYS_pidfd_open, pid, 0);
+    if (pidfd >= 0 || errno != ENOSYS)
+    {
+        return pidfd;
+    }
+#endif
+    // kernel sin pidfd: se recuerda el pid, con el riesgo de que se reuse
+    return (kill(pid, 0) == 0 || errno == EPERM) ? PROC_NO_PIDFD : -1;
+}
+
+int proc_pidfd_signal(int pidfd, pid_t pid, int sig)
+{
+#ifdef SYS_pidfd_send_signal
+    if (pidfd >= 0)
+    {
+        return syscall(SYS_pidfd_send_signal, pidfd, sig, NULL, 0);
+    }
+#endif
+    return kill(pid, sig);
+}
@@ -0,0 +1,107 @@
+/* Tabla de procesos leída de /proc.
+ * Los pids se listan con getdents64 sobre un descriptor de /proc, y de cada
+ * proceso se leen stat (y, si se pide, cmdline) con openat y un único pread,
+ * sin armar rutas completas ni pasar por stdio. Con muchos procesos, la
+ * lectura se reparte entre varios hilos, cada uno con un tramo de pids.
+ * También se pueden abrir pidfds, para mandar señales sin que el pid se
+ * reuse en el medio.
+ */
+
+#ifndef PROC_H
+#define PROC_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+#define PROC_COMM_SIZE 64 // Lugar para el nombre del proceso (el kernel lo trunca antes)
+
+#define PROC_MAX_THREADS 8 // Máxima cantidad de hilos que leen /proc a la vez
+
+#define PROC_NO_PIDFD (-2) // proc_pidfd_open() en un kernel sin pidfd
+
+#define PROC_CMDLINE 0x1 // leer también /proc/<pid>/cmdline
+#define PROC_OWNER 0x2   // averiguar el dueño de cada proceso (un fstatat más por proceso)
+
+typedef struct
+{
+    pid_t pid;
+    pid_t ppid;
+    char state;                     // R, S, D, Z, T, I, ... (ver proc(5))
+    uid_t uid;                      // dueño del proceso (solo con PROC_OWNER)
+    unsigned long rss_kb;           // memoria residente, en KiB
+    unsigned long long cpu_ticks;   // tiempo de CPU (usuario + sistema), en ticks del reloj
+    unsigned long long start_ticks; // momento en que arrancó, en ticks desde el inicio del sistema
+    long threads;                   // cantidad de hilos
+    char comm[PROC_COMM_SIZE];      // nombre del ejecutable
+    const char *cmdline;            // argumentos separados por espacios, o "" (hilos del kernel o sin PROC_CMDLINE)
+} proc_info;
+
+typedef struct proc_table_s *proc_table;
+
+proc_table proc_scan(unsigned int flags);
+/*
+ * Lee todos los procesos del sistema.
+ *   flags: combinación de PROC_CMDLINE y PROC_OWNER.
+ *   Returns: tabla ordenada por pid, a liberar con proc_table_destroy(), o
+ *     NULL si no se pudo abrir /proc. Los procesos que terminan mientras se
+ *     lee la tabla no aparecen.
+ */
+
+proc_table proc_scan_threads(unsigned int flags, unsigned int threads);
+/*
+ * Igual que proc_scan(), pero repartiendo la lectura entre `threads' hilos.
+ * Con threads == 0 se elige según los procesadores disponibles (hasta
+ * PROC_MAX_THREADS) y la cantidad de procesos. El resultado no depende de la
+ * cantidad de hilos: siempre queda ordenado por pid.
+ */
+
+void proc_refresh(proc_table table, unsigned int flags);
+/*
+ * Vuelve a leer todos los procesos dentro de la misma tabla, reusando su
+ * memoria y el descriptor de /proc (pensado para leer una y otra vez, como
+ * `ps -w'). Los punteros que devolvió proc_table_get() dejan de valer.
+ * Requires: table != NULL
+ */
+
+unsigned int proc_table_length(const proc_table table);
+/*
+ * Cantidad de procesos de la tabla.
+ * Requires: table != NULL
+ */
+
+const proc_info *proc_table_get(const proc_table table, unsigned int i);
+/*
+ * Proceso número `i' de la tabla.
+ *   Returns: puntero válido hasta proc_refresh() o proc_table_destroy().
+ * Requires: table != NULL && i < proc_table_length(table)
+ */
+
+void proc_table_destroy(proc_table table);
+/*
+ * Libera la tabla.
+ * Requires: table != NULL
+ */
+
+bool proc_get(pid_t pid, proc_info *info);
+/*
+ * Lee un solo proceso (solo /proc/<pid>/stat: sin dueño ni cmdline).
+ *   Returns: false si el proceso no existe.
+ * Requires: info != NULL
+ */
+
+int proc_pidfd_open(pid_t pid);
+/*
+ * Abre un pidfd del proceso: un descriptor que lo identifica aunque su pid se
+ * reuse después. Si el kernel no tiene pidfd devuelve PROC_NO_PIDFD y las
+ * señales se mandan por pid.
+ *   Returns: el descriptor (a cerrar con close()), PROC_NO_PIDFD, o -1 si el
+ *     proceso no existe (errno queda con el motivo).
+ */
+
+int proc_pidfd_signal(int pidfd, pid_t pid, int sig);
+/*
+ * Manda `sig' al proceso de `pidfd' (o a `pid', si pidfd es PROC_NO_PIDFD).
+ *   Returns: 0, o -1 con errno si no se pudo (ESRCH si ya terminó).
+ */
+
+#endif /* PROC_H */
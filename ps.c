@@ -0,0 +1,952 @@
+#include <assert.h>
+#include <limits.h>
+#include <poll.h>
+#include <pwd.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <glib.h>
+
+#include "ps.h"
+#include "proc.h"
+
+#define HEADER_COLOR "\033[0;31m"
+#define RESET "\033[0m"
+#define USER_WIDTH 8              // Ancho de la columna de usuario (los nombres largos se cortan)
+#define TREE_INDENT "    "        // Sangría de cada nivel del árbol
+#define TREE_BRANCH " \\_ "       // Marca de un hijo en el árbol
+#define OUTPUT_BUFFER (64 * 1024) // Las líneas se juntan y se escriben de a bloques
+#define DEFAULT_COLUMNS "pid,ppid,user,stat,rss,time,nlwp,args"
+#define WATCH_COLUMNS "pid,user,stat,pcpu,rss,drss,time,comm" // Columnas por defecto con -w
+#define WATCH_SORT "-pcpu"                                     // Orden por defecto con -w
+#define ENTER_SCREEN "\033[?1049h\033[?25l"                    // Pantalla alternativa, sin cursor
+#define LEAVE_SCREEN "\033[?25h\033[?1049l"
+#define USAGE                                                                                      \
+    "ps: usage: ps [-e] [-o col,...] [--sort [-]col,...] [-u user,...] [-C name,...] [--forest]\n" \
+    "          [-w seconds [-n count]]\n"
+
+typedef enum
+{
+    COL_PID,
+    COL_PPID,
+    COL_USER,
+    COL_STATE,
+    COL_RSS,
+    COL_TIME,
+    COL_THREADS,
+    COL_CPU,
+    COL_RSS_DELTA,
+    COL_COMM,
+    COL_ARGS
+} ps_column;
+
+struct column_spec
+{
+    const char *header;
+    int width;          // ancho mínimo; negativo si se alinea a la izquierda
+    unsigned int needs; // qué tiene que leer proc_scan() para esta columna
+};
+
+static const struct column_spec column_specs[] = {
+    [COL_PID] = {"PID", 7, 0},
+    [COL_PPID] = {"PPID", 7, 0},
+    [COL_USER] = {"USER", -USER_WIDTH, PROC_OWNER},
+    [COL_STATE] = {"S", 1, 0},
+    [COL_RSS] = {"RSS", 9, 0},
+    [COL_TIME] = {"TIME", 11, 0},
+    [COL_THREADS] = {"NLWP", 5, 0},
+    [COL_CPU] = {"%CPU", 5, 0},
+    [COL_RSS_DELTA] = {"DRSS", 8, 0},
+    [COL_COMM] = {"COMMAND", -15, 0},
+    [COL_ARGS] = {"COMMAND", -15, PROC_CMDLINE},
+};
+
+// Nombres con los que se pueden pedir las columnas (los de procps y algunos sinónimos)
+static const struct
+{
+    const char *name;
+    ps_column column;
+} column_names[] = {
+    {"pid", COL_PID}, {"ppid", COL_PPID}, {"user", COL_USER}, {"stat", COL_STATE},
+    {"state", COL_STATE}, {"s", COL_STATE}, {"rss", COL_RSS}, {"time", COL_TIME},
+    {"cputime", COL_TIME}, {"nlwp", COL_THREADS}, {"threads", COL_THREADS}, {"pcpu", COL_CPU},
+    {"%cpu", COL_CPU}, {"drss", COL_RSS_DELTA}, {"comm", COL_COMM}, {"args", COL_ARGS},
+    {"cmd", COL_ARGS}, {"command", COL_ARGS},
+};
+
+/* Lo que se muestra de un proceso: lo leído de /proc más lo que se calcula
+ * comparando con la muestra anterior.
+ */
+struct ps_row
+{
+    const proc_info *info;
+    double cpu;     // uso de CPU en %: desde la muestra anterior o, si no la hay, desde que arrancó
+    long rss_delta; // cambio de la memoria residente desde la muestra anterior, en KiB
+};
+
+/* Lo que se recuerda de un proceso entre muestras. Un pid se puede reusar, así
+ * que el proceso se identifica por pid y momento de arranque.
+ */
+struct sample
+{
+    pid_t pid;
+    unsigned long long start_ticks;
+    unsigned long long cpu_ticks;
+    unsigned long rss_kb;
+};
+
+struct sampler
+{
+    GHashTable *previous; // struct sample * -> el mismo puntero, de la muestra anterior
+    GArray *samples[2];   // struct sample; se alternan entre una muestra y la siguiente
+    unsigned int current; // cuál de los dos tiene la muestra anterior
+    double time_ms;       // cuándo se tomó la muestra anterior; 0 si todavía no hay
+};
+
+struct sort_key
+{
+    ps_column column;
+    bool descending;
+};
+
+struct ps_options
+{
+    GArray *columns;       // ps_column, en el orden en que se muestran
+    GArray *sort;          // struct sort_key, de la más a la menos importante
+    GArray *uids;          // uid_t; vacío si no se filtra por usuario
+    GPtrArray *names;      // nombres de ejecutable; vacío si no se filtra por nombre
+    bool forest;           // ¿mostrar como árbol?
+    GHashTable *users;     // uid -> nombre de usuario, para no llamar a getpwuid() por proceso
+    double interval;       // segundos entre muestras con -w; 0 si se muestra una sola vez
+    long count;            // cantidad de muestras con -w (-n); 0 hasta que se aprieta 'q'
+    unsigned int max_rows; // cuántos procesos se muestran como mucho
+    bool watching;         // ¿se arma un cuadro entero antes de escribirlo?
+};
+
+static bool lookup_column(const char *name, ps_column *column)
+{
+    for (unsigned int i = 0; i < G_N_ELEMENTS(column_names); i++)
+    {
+        if (strcmp(name, column_names[i].name) == 0)
+        {
+            *column = column_names[i].column;
+            return true;
+        }
+    }
+    fprintf(stderr, "ps: unknown column: %s\n", name);
+    return false;
+}
+
+static bool parse_columns(struct ps_options *options, const char *list)
+{
+    char **names = g_strsplit(list, ",", -1);
+    bool ok = true;
+    g_array_set_size(options->columns, 0);
+    for (unsigned int i = 0; ok && names[i] != NULL; i++)
+    {
+        ps_column column;
+        ok = lookup_column(names[i], &column);
+        g_array_append_val(options->columns, column);
+    }
+    g_strfreev(names);
+    return ok && options->columns->len > 0;
+}
+
+static bool parse_sort(struct ps_options *options, const char *list)
+{
+    char **names = g_strsplit(list, ",", -1);
+    bool ok = true;
+    for (unsigned int i = 0; ok && names[i] != NULL; i++)
+    {
+        struct sort_key key = {COL_PID, names[i][0] == '-'};
+        const char *name = (names[i][0] == '-' || names[i][0] == '+') ? names[i] + 1 : names[i];
+        ok = lookup_column(name, &key.column);
+        g_array_append_val(options->sort, key);
+    }
+    g_strfreev(names);
+    return ok;
+}
+
+static bool parse_users(struct ps_options *options, const char *list)
+{
+    char **users = g_strsplit(list, ",", -1);
+    bool ok = true;
+    for (unsigned int i = 0; ok && users[i] != NULL; i++)
+    {
+        char *end;
+        uid_t uid = strtoul(users[i], &end, 10);
+        if (users[i][0] == '\0' || *end != '\0')
+        {
+            struct passwd *pw = getpwnam(users[i]);
+            ok = pw != NULL;
+            if (!ok)
+            {
+                fprintf(stderr, "ps: unknown user: %s\n", users[i]);
+            }
+            uid = ok ? pw->pw_uid : 0;
+        }
+        g_array_append_val(options->uids, uid);
+    }
+    g_strfreev(users);
+    return ok;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de interpretar los argumentos de ps
+  -- las opciones con valor aceptan "-o lista" y, las largas, también "--sort=lista" --
+------------------------------------------------------------------------------------------------
+*/
+static bool parse_options(scommand args, struct ps_options *options)
+{
+    bool ok = parse_columns(options, DEFAULT_COLUMNS);
+    bool columns_given = false;
+    while (ok && !scommand_is_empty(args))
+    {
+        char *option = g_strdup(scommand_front(args));
+        scommand_pop_front(args);
+        char *value = NULL;
+        if (g_str_has_prefix(option, "--sort="))
+        {
+            value = g_strdup(option + strlen("--sort="));
+            option[strlen("--sort")] = '\0';
+        }
+        else if ((strcmp(option, "-o") == 0 || strcmp(option, "--sort") == 0 ||
+                  strcmp(option, "-u") == 0 || strcmp(option, "-C") == 0 ||
+                  strcmp(option, "-w") == 0 || strcmp(option, "-n") == 0) &&
+                 !scommand_is_empty(args))
+        {
+            value = g_strdup(scommand_front(args));
+            scommand_pop_front(args);
+        }
+
+        if (strcmp(option, "-e") == 0 || strcmp(option, "-A") == 0)
+        {
+            // ya se muestran todos los procesos
+        }
+        else if (strcmp(option, "--forest") == 0 || strcmp(option, "-H") == 0)
+        {
+            options->forest = true;
+        }
+        else if (value == NULL)
+        {
+            ok = false;
+        }
+        else if (strcmp(option, "-o") == 0)
+        {
+            ok = parse_columns(options, value);
+            columns_given = true;
+        }
+        else if (strcmp(option, "-w") == 0)
+        {
+            char *end;
+            options->interval = strtod(value, &end);
+            ok = *end == '\0' && options->interval > 0;
+        }
+        else if (strcmp(option, "-n") == 0)
+        {
+            char *end;
+            options->count = strtol(value, &end, 10);
+            ok = *end == '\0' && options->count > 0;
+        }
+        else if (strcmp(option, "--sort") == 0)
+        {
+            ok = parse_sort(options, value);
+        }
+        else if (strcmp(option, "-u") == 0)
+        {
+            ok = parse_users(options, value);
+        }
+        else
+        {
+            char **names = g_strsplit(value, ",", -1);
+            for (unsigned int i = 0; names[i] != NULL; i++)
+            {
+                g_ptr_array_add(options->names, names[i]);
+            }
+            g_free(names); // las cadenas quedaron en options->names
+        }
+        g_free(option);
+        g_free(value);
+    }
+    // como top: por defecto, las columnas de uso y los que más CPU usan primero
+    if (ok && options->interval > 0 && !columns_given)
+    {
+        ok = parse_columns(options, WATCH_COLUMNS);
+    }
+    if (ok && options->interval > 0 && options->sort->len == 0)
+    {
+        ok = parse_sort(options, WATCH_SORT);
+    }
+    return ok && (options->count == 0 || options->interval > 0);
+}
+
+static const char *user_name(struct ps_options *options, uid_t uid)
+{
+    char *name = g_hash_table_lookup(options->users, GUINT_TO_POINTER(uid));
+    if (name == NULL)
+    {
+        struct passwd *pw = getpwuid(uid);
+        name = (pw != NULL) ? g_strdup(pw->pw_name) : g_strdup_printf("%u", (unsigned int)uid);
+        g_hash_table_insert(options->users, GUINT_TO_POINTER(uid), name);
+    }
+    return name;
+}
+
+static bool selected(const struct ps_options *options, const proc_info *info)
+{
+    bool user_ok = options->uids->len == 0;
+    for (unsigned int i = 0; !user_ok && i < options->uids->len; i++)
+    {
+        user_ok = g_array_index(options->uids, uid_t, i) == info->uid;
+    }
+    bool name_ok = options->names->len == 0;
+    for (unsigned int i = 0; !name_ok && i < options->names->len; i++)
+    {
+        name_ok = strcmp(g_ptr_array_index(options->names, i), info->comm) == 0;
+    }
+    return user_ok && name_ok;
+}
+
+static int compare_column(struct ps_options *options, ps_column column, const struct ps_row *x,
+                          const struct ps_row *y)
+{
+#define COMPARE(x, y) (((x) > (y)) - ((x) < (y)))
+    const proc_info *a = x->info, *b = y->info;
+    switch (column)
+    {
+    case COL_PID:
+        return COMPARE(a->pid, b->pid);
+    case COL_PPID:
+        return COMPARE(a->ppid, b->ppid);
+    case COL_USER:
+        return strcmp(user_name(options, a->uid), user_name(options, b->uid));
+    case COL_STATE:
+        return COMPARE(a->state, b->state);
+    case COL_RSS:
+        return COMPARE(a->rss_kb, b->rss_kb);
+    case COL_TIME:
+        return COMPARE(a->cpu_ticks, b->cpu_ticks);
+    case COL_THREADS:
+        return COMPARE(a->threads, b->threads);
+    case COL_CPU:
+        return COMPARE(x->cpu, y->cpu);
+    case COL_RSS_DELTA:
+        return COMPARE(x->rss_delta, y->rss_delta);
+    case COL_COMM:
+        return strcmp(a->comm, b->comm);
+    default:
+        return strcmp(a->cmdline, b->cmdline);
+    }
+#undef COMPARE
+}
+
+static gint compare_procs(gconstpointer a, gconstpointer b, gpointer data)
+{
+    struct ps_options *options = data;
+    const struct ps_row *x = a, *y = b;
+    for (unsigned int i = 0; i < options->sort->len; i++)
+    {
+        struct sort_key key = g_array_index(options->sort, struct sort_key, i);
+        int order = compare_column(options, key.column, x, y);
+        if (order != 0)
+        {
+            return key.descending ? -order : order;
+        }
+    }
+    return (x->info->pid > y->info->pid) - (x->info->pid < y->info->pid);
+}
+
+static void append_time(GString *line, int width, unsigned long long ticks)
+{
+    unsigned long long seconds = ticks / sysconf(_SC_CLK_TCK);
+    unsigned long long days = seconds / 86400;
+    char text[32];
+    if (days > 0)
+    {
+        snprintf(text, sizeof(text), "%llu-%02llu:%02llu:%02llu", days, seconds / 3600 % 24,
+                 seconds / 60 % 60, seconds % 60);
+    }
+    else
+    {
+        snprintf(text, sizeof(text), "%02llu:%02llu:%02llu", seconds / 3600, seconds / 60 % 60,
+                 seconds % 60);
+    }
+    g_string_append_printf(line, "%*s", width, text);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de armar la línea de un proceso
+  -- en el árbol, el nombre del comando se corre según la profundidad; si la columna del
+            comando no es la última se la completa hasta su ancho para alinear --
+------------------------------------------------------------------------------------------------
+*/
+static void append_row(GString *line, struct ps_options *options, const struct ps_row *row,
+                       unsigned int depth)
+{
+    const proc_info *info = row->info;
+    for (unsigned int i = 0; i < options->columns->len; i++)
+    {
+        ps_column column = g_array_index(options->columns, ps_column, i);
+        int width = column_specs[column].width;
+        bool last = i + 1 == options->columns->len;
+        if (i > 0)
+        {
+            g_string_append_c(line, ' ');
+        }
+        switch (column)
+        {
+        case COL_PID:
+            g_string_append_printf(line, "%*d", width, (int)info->pid);
+            break;
+        case COL_PPID:
+            g_string_append_printf(line, "%*d", width, (int)info->ppid);
+            break;
+        case COL_USER:
+        {
+            const char *name = user_name(options, info->uid);
+            if (strlen(name) > USER_WIDTH)
+            {
+                g_string_append_printf(line, "%.*s+", USER_WIDTH - 1, name);
+            }
+            else
+            {
+                g_string_append_printf(line, "%*s", last ? 0 : width, name);
+            }
+            break;
+        }
+        case COL_STATE:
+            g_string_append_c(line, info->state);
+            break;
+        case COL_RSS:
+            g_string_append_printf(line, "%*lu", width, info->rss_kb);
+            break;
+        case COL_TIME:
+            append_time(line, width, info->cpu_ticks);
+            break;
+        case COL_THREADS:
+            g_string_append_printf(line, "%*ld", width, info->threads);
+            break;
+        case COL_CPU:
+            g_string_append_printf(line, "%*.1f", width, row->cpu);
+            break;
+        case COL_RSS_DELTA:
+            g_string_append_printf(line, "%*ld", width, row->rss_delta);
+            break;
+        default:
+        {
+            size_t start = line->len;
+            for (unsigned int d = 1; d < depth; d++)
+            {
+                g_string_append(line, TREE_INDENT);
+            }
+            if (depth > 0)
+            {
+                g_string_append(line, TREE_BRANCH);
+            }
+            if (column == COL_ARGS && info->cmdline[0] != '\0')
+            {
+                g_string_append(line, info->cmdline);
+            }
+            else if (column == COL_ARGS)
+            {
+                g_string_append_printf(line, "[%s]", info->comm); // hilo del kernel
+            }
+            else
+            {
+                g_string_append(line, info->comm);
+            }
+            while (!last && line->len - start < (size_t)-width)
+            {
+                g_string_append_c(line, ' ');
+            }
+            break;
+        }
+        }
+    }
+    g_string_append_c(line, '\n');
+}
+
+static void flush_output(const struct ps_options *options, GString *line)
+{
+    if (!options->watching && line->len >= OUTPUT_BUFFER)
+    {
+        fputs(line->str, stdout);
+        g_string_truncate(line, 0);
+    }
+}
+
+static void append_header(GString *line, struct ps_options *options)
+{
+    g_string_append(line, isatty(STDOUT_FILENO) ? HEADER_COLOR : "");
+    for (unsigned int i = 0; i < options->columns->len; i++)
+    {
+        const struct column_spec *spec = &column_specs[g_array_index(options->columns, ps_column, i)];
+        bool last = i + 1 == options->columns->len;
+        g_string_append_printf(line, "%s%*s", (i > 0) ? " " : "", last && spec->width < 0 ? 0 : spec->width,
+                               spec->header);
+    }
+    g_string_append(line, isatty(STDOUT_FILENO) ? RESET "\n" : "\n");
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de mostrar los procesos como árbol
+  -- cada proceso cuelga de su padre si el padre también se muestra; los hermanos siguen
+     el orden pedido. Una segunda pasada muestra lo que no se alcanzó desde una raíz (solo
+                    pasaría si los pids se reusan mientras se lee la tabla) --
+------------------------------------------------------------------------------------------------
+*/
+static void print_forest(GString *line, struct ps_options *options, const struct ps_row *rows,
+                         unsigned int count)
+{
+    GHashTable *positions = g_hash_table_new(g_direct_hash, g_direct_equal);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        g_hash_table_insert(positions, GINT_TO_POINTER(rows[i].info->pid), GUINT_TO_POINTER(i + 1));
+    }
+    // hijos en listas enlazadas por índice; se arman al revés para que queden en orden al apilarlos
+    unsigned int *first_child = malloc(count * sizeof(unsigned int));
+    unsigned int *next_sibling = malloc(count * sizeof(unsigned int));
+    bool *root = malloc(count * sizeof(bool));
+    bool *shown = calloc(count, sizeof(bool));
+    for (unsigned int i = 0; i < count; i++)
+    {
+        first_child[i] = UINT_MAX;
+    }
+    for (unsigned int i = 0; i < count; i++)
+    {
+        gpointer position = g_hash_table_lookup(positions, GINT_TO_POINTER(rows[i].info->ppid));
+        unsigned int parent = GPOINTER_TO_UINT(position);
+        root[i] = parent == 0 || parent - 1 == i;
+        if (!root[i])
+        {
+            next_sibling[i] = first_child[parent - 1];
+            first_child[parent - 1] = i;
+        }
+    }
+    GArray *stack = g_array_new(FALSE, FALSE, sizeof(unsigned int) * 2);
+    unsigned int printed = 0;
+    for (unsigned int pass = 0; pass < 2 && printed < options->max_rows; pass++)
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            if (shown[i] || (pass == 0 && !root[i]))
+            {
+                continue;
+            }
+            unsigned int entry[2] = {i, 0}; // posición y profundidad
+            g_array_append_val(stack, entry);
+            while (stack->len > 0 && printed < options->max_rows)
+            {
+                unsigned int *top = &g_array_index(stack, unsigned int, 2 * (stack->len - 1));
+                unsigned int current = top[0], depth = top[1];
+                g_array_set_size(stack, stack->len - 1);
+                if (shown[current])
+                {
+                    continue;
+                }
+                shown[current] = true;
+                printed++;
+                append_row(line, options, &rows[current], depth);
+                for (unsigned int child = first_child[current]; child != UINT_MAX; child = next_sibling[child])
+                {
+                    unsigned int pending[2] = {child, depth + 1};
+                    g_array_append_val(stack, pending);
+                }
+                flush_output(options, line);
+            }
+        }
+    }
+    g_array_free(stack, TRUE);
+    free(shown);
+    free(root);
+    free(next_sibling);
+    free(first_child);
+    g_hash_table_destroy(positions);
+}
+
+static double boot_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_BOOTTIME, &ts); // el mismo reloj que start_ticks
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static guint sample_hash(gconstpointer key)
+{
+    const struct sample *s = key;
+    return (guint)s->pid ^ (guint)(s->start_ticks * 2654435761u);
+}
+
+static gboolean sample_equal(gconstpointer a, gconstpointer b)
+{
+    const struct sample *x = a, *y = b;
+    return x->pid == y->pid && x->start_ticks == y->start_ticks;
+}
+
+static unsigned int scan_flags(const struct ps_options *options)
+{
+    unsigned int flags = (options->uids->len > 0) ? PROC_OWNER : 0;
+    for (unsigned int i = 0; i < options->columns->len; i++)
+    {
+        flags |= column_specs[g_array_index(options->columns, ps_column, i)].needs;
+    }
+    for (unsigned int i = 0; i < options->sort->len; i++)
+    {
+        flags |= column_specs[g_array_index(options->sort, struct sort_key, i).column].needs;
+    }
+    return flags;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de armar, filtrar y ordenar las filas a mostrar
+  -- el uso de CPU y el cambio de memoria salen de la muestra anterior del mismo proceso
+     (mismo pid y mismo arranque); sin muestra anterior, el uso de CPU es el promedio desde
+                       que arrancó, como en el ps de procps --
+------------------------------------------------------------------------------------------------
+*/
+static void collect_rows(struct ps_options *options, proc_table table, GArray *rows,
+                         struct sampler *sampler)
+{
+    double ticks_per_ms = sysconf(_SC_CLK_TCK) / 1e3;
+    double now = boot_ms();
+    double elapsed = (sampler != NULL && sampler->time_ms > 0) ? now - sampler->time_ms : 0;
+    GArray *samples = NULL;
+    if (sampler != NULL)
+    {
+        samples = sampler->samples[1 - sampler->current];
+        g_array_set_size(samples, 0);
+    }
+    g_array_set_size(rows, 0);
+    for (unsigned int i = 0; i < proc_table_length(table); i++)
+    {
+        const proc_info *info = proc_table_get(table, i);
+        struct sample sample = {info->pid, info->start_ticks, info->cpu_ticks, info->rss_kb};
+        const struct sample *previous =
+            (sampler != NULL) ? g_hash_table_lookup(sampler->previous, &sample) : NULL;
+        if (samples != NULL)
+        {
+            g_array_append_val(samples, sample);
+        }
+        if (!selected(options, info))
+        {
+            continue;
+        }
+        struct ps_row row = {info, 0, 0};
+        if (previous != NULL && elapsed > 0)
+        {
+            row.cpu = 100 * (info->cpu_ticks - previous->cpu_ticks) / (elapsed * ticks_per_ms);
+            row.rss_delta = (long)info->rss_kb - (long)previous->rss_kb;
+        }
+        else if (now * ticks_per_ms > info->start_ticks)
+        {
+            row.cpu = 100 * info->cpu_ticks / (now * ticks_per_ms - info->start_ticks);
+        }
+        g_array_append_val(rows, row);
+    }
+    if (options->sort->len > 0)
+    {
+        g_array_sort_with_data(rows, compare_procs, options);
+    }
+    if (sampler != NULL)
+    {
+        // la muestra nueva pasa a ser la anterior; sus elementos ya no se mueven hasta la próxima
+        g_hash_table_remove_all(sampler->previous);
+        for (unsigned int i = 0; i < samples->len; i++)
+        {
+            struct sample *s = &g_array_index(samples, struct sample, i);
+            g_hash_table_add(sampler->previous, s);
+        }
+        sampler->current = 1 - sampler->current;
+        sampler->time_ms = now;
+    }
+}
+
+static void append_processes(GString *line, struct ps_options *options, GArray *rows)
+{
+    append_header(line, options);
+    if (options->forest)
+    {
+        print_forest(line, options, (const struct ps_row *)rows->data, rows->len);
+    }
+    else
+    {
+        for (unsigned int i = 0; i < rows->len && i < options->max_rows; i++)
+        {
+            append_row(line, options, &g_array_index(rows, struct ps_row, i), 0);
+            flush_output(options, line);
+        }
+    }
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de leer, filtrar, ordenar y mostrar los procesos
+           -- de /proc se lee solo lo que piden las columnas, el orden y los filtros --
+------------------------------------------------------------------------------------------------
+*/
+static bool show_processes(struct ps_options *options)
+{
+    proc_table table = proc_scan(scan_flags(options));
+    if (table == NULL)
+    {
+        perror("ps: /proc");
+        return false;
+    }
+    GArray *rows = g_array_sized_new(FALSE, FALSE, sizeof(struct ps_row), proc_table_length(table));
+    collect_rows(options, table, rows, NULL);
+    GString *line = g_string_sized_new(OUTPUT_BUFFER);
+    append_processes(line, options, rows);
+    fputs(line->str, stdout);
+    g_string_free(line, TRUE);
+    g_array_free(rows, TRUE);
+    proc_table_destroy(table);
+    return true;
+}
+
+// Cantidad de bytes de `line' que ocupan a lo sumo `width' columnas (las secuencias de escape no ocupan)
+static size_t visible_prefix(const char *line, size_t len, unsigned int width)
+{
+    size_t i = 0;
+    unsigned int columns = 0;
+    while (i < len && (columns < width || line[i] == '\033'))
+    {
+        if (line[i] == '\033')
+        {
+            while (i < len && !g_ascii_isalpha(line[i]))
+            {
+                i++;
+            }
+        }
+        else if (((unsigned char)line[i] & 0xC0) != 0x80)
+        {
+            columns++; // los bytes de continuación de UTF-8 no cuentan
+        }
+        i++;
+        while (i < len && ((unsigned char)line[i] & 0xC0) == 0x80)
+        {
+            i++;
+        }
+    }
+    return i;
+}
+
+static void free_line(gpointer line)
+{
+    g_string_free(line, TRUE);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de dibujar un cuadro de ps -w en la terminal
+  -- solo se reescriben las líneas que cambiaron respecto del cuadro anterior; si cambió el
+                     tamaño de la terminal se redibuja todo --
+------------------------------------------------------------------------------------------------
+*/
+static void draw_frame(GString *out, GString *frame, GPtrArray *screen, unsigned int width)
+{
+    g_string_truncate(out, 0);
+    const char *line = frame->str;
+    unsigned int row = 0;
+    while (line < frame->str + frame->len)
+    {
+        const char *end = strchr(line, '\n');
+        size_t len = visible_prefix(line, end - line, width);
+        if (row == screen->len)
+        {
+            g_ptr_array_add(screen, g_string_new(NULL));
+        }
+        GString *old = g_ptr_array_index(screen, row);
+        if (old->len != len || memcmp(old->str, line, len) != 0)
+        {
+            g_string_append_printf(out, "\033[%u;1H", row + 1);
+            g_string_append_len(out, line, len);
+            g_string_append(out, "\033[K");
+            g_string_truncate(old, 0);
+            g_string_append_len(old, line, len);
+        }
+        line = end + 1;
+        row++;
+    }
+    if (row < screen->len)
+    {
+        // el cuadro nuevo es más corto: se borra lo que sobraba del anterior
+        g_string_append_printf(out, "\033[%u;1H\033[J", row + 1);
+        g_ptr_array_set_size(screen, row);
+    }
+    fwrite(out->str, 1, out->len, stdout);
+    fflush(stdout);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de esperar hasta la próxima muestra
+  -- devuelve true si se pidió salir ('q', Ctrl-C o fin de la entrada); si la entrada no es
+                        una terminal, solo se espera --
+------------------------------------------------------------------------------------------------
+*/
+static bool wait_for_quit(double seconds, bool keyboard)
+{
+    struct pollfd input = {STDIN_FILENO, POLLIN, 0};
+    int timeout = (int)(seconds * 1000);
+    if (poll(&input, keyboard ? 1 : 0, timeout) <= 0)
+    {
+        return false;
+    }
+    char key;
+    ssize_t nread = read(STDIN_FILENO, &key, 1);
+    return nread <= 0 || key == 'q' || key == 'Q' || key == 3;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada del modo ps -w, parecido a top
+  -- cada muestra reusa la tabla de procesos, las filas, el cuadro y el registro de la muestra
+     anterior, así que después de la primera no se pide memoria nueva. En una terminal se usa
+       la pantalla alternativa; si la salida no es una terminal, se escriben los cuadros
+                                    uno tras otro --
+------------------------------------------------------------------------------------------------
+*/
+static bool watch_processes(struct ps_options *options)
+{
+    unsigned int flags = scan_flags(options);
+    proc_table table = proc_scan(flags);
+    if (table == NULL)
+    {
+        perror("ps: /proc");
+        return false;
+    }
+    bool terminal = isatty(STDOUT_FILENO);
+    struct termios saved, raw;
+    bool keyboard = isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &saved) == 0;
+    if (keyboard)
+    {
+        raw = saved;
+        raw.c_lflag &= ~(ICANON | ECHO | ISIG); // Ctrl-C llega como tecla y también sale
+        raw.c_cc[VMIN] = 1;
+        raw.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+    }
+    if (terminal)
+    {
+        fputs(ENTER_SCREEN, stdout);
+    }
+
+    struct sampler sampler = {g_hash_table_new(sample_hash, sample_equal),
+                              {g_array_new(FALSE, FALSE, sizeof(struct sample)),
+                               g_array_new(FALSE, FALSE, sizeof(struct sample))},
+                              0,
+                              0};
+    GArray *rows = g_array_new(FALSE, FALSE, sizeof(struct ps_row));
+    GString *frame = g_string_new(NULL);
+    GString *out = g_string_new(NULL);
+    GPtrArray *screen = g_ptr_array_new_with_free_func(free_line);
+    unsigned short last_rows = 0, last_cols = 0; // tamaño de la terminal en el cuadro anterior
+    options->watching = true;
+    bool quit = false;
+    for (long sample = 0; !quit && (options->count == 0 || sample < options->count); sample++)
+    {
+        if (sample > 0)
+        {
+            proc_refresh(table, flags);
+        }
+        collect_rows(options, table, rows, &sampler);
+        struct winsize size = {24, 80, 0, 0};
+        if (terminal)
+        {
+            struct winsize actual;
+            if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &actual) == 0 && actual.ws_row > 0 && actual.ws_col > 0)
+            {
+                size = actual;
+            }
+            if (size.ws_row != last_rows || size.ws_col != last_cols)
+            {
+                fputs("\033[H\033[2J", stdout);
+                g_ptr_array_set_size(screen, 0);
+                last_rows = size.ws_row;
+                last_cols = size.ws_col;
+            }
+            // una línea de estado y el encabezado
+            options->max_rows = (size.ws_row > 2) ? size.ws_row - 2 : 0;
+        }
+        g_string_truncate(frame, 0);
+        g_string_append_printf(frame, "ps -w %g: %u procesos, %u mostrados%s\n", options->interval,
+                               proc_table_length(table), MIN(rows->len, options->max_rows),
+                               keyboard ? " ('q' para salir)" : "");
+        append_processes(frame, options, rows);
+        if (terminal)
+        {
+            draw_frame(out, frame, screen, size.ws_col);
+        }
+        else
+        {
+            fputs(frame->str, stdout);
+            fputc('\n', stdout);
+            fflush(stdout);
+        }
+        bool last = options->count > 0 && sample + 1 == options->count;
+        quit = !last && wait_for_quit(options->interval, keyboard);
+    }
+
+    if (terminal)
+    {
+        fputs(LEAVE_SCREEN, stdout);
+        fflush(stdout);
+    }
+    if (keyboard)
+    {
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+    }
+    g_ptr_array_free(screen, TRUE);
+    g_string_free(out, TRUE);
+    g_string_free(frame, TRUE);
+    g_array_free(rows, TRUE);
+    g_array_free(sampler.samples[0], TRUE);
+    g_array_free(sampler.samples[1], TRUE);
+    g_hash_table_destroy(sampler.previous);
+    proc_table_destroy(table);
+    return true;
+}
+
+int ps_run(scommand args)
+{
+    assert(args != NULL);
+    struct ps_options options = {
+        g_array_new(FALSE, FALSE, sizeof(ps_column)),
+        g_array_new(FALSE, FALSE, sizeof(struct sort_key)),
+        g_array_new(FALSE, FALSE, sizeof(uid_t)),
+        g_ptr_array_new_with_free_func(g_free),
+        false,
+        g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free),
+        0,
+        0,
+        UINT_MAX,
+        false};
+    bool done = false;
+    if (!parse_options(args, &options))
+    {
+        fprintf(stderr, USAGE);
+    }
+    else if (options.interval > 0)
+    {
+        done = watch_processes(&options);
+    }
+    else
+    {
+        done = show_processes(&options);
+    }
+    g_array_free(options.columns, TRUE);
+    g_array_free(options.sort, TRUE);
+    g_array_free(options.uids, TRUE);
+    g_ptr_array_free(options.names, TRUE);
+    g_hash_table_destroy(options.users);
+    return done ? EXIT_SUCCESS : EXIT_FAILURE;
+}
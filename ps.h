@@ -0,0 +1,33 @@
+/* Comando interno ps.
+ * Muestra la tabla de procesos de proc.h con columnas a elección, ordenada
+ * por una o más claves, filtrada por usuario o por nombre, y opcionalmente
+ * como árbol de padres e hijos. Con -w se vuelve a mostrar cada tantos
+ * segundos, al estilo de top.
+ */
+
+#ifndef PS_H
+#define PS_H
+
+#include "command.h"
+
+int ps_run(scommand args);
+/*
+ * Ejecuta ps. Los argumentos (sin el "ps") se consumen de `args':
+ *   -e, -A              todos los procesos (es lo que se muestra siempre)
+ *   -o col[,col...]     columnas: pid ppid user stat rss time nlwp pcpu drss
+ *                       comm args
+ *   --sort [-]col[,...] orden (con '-', de mayor a menor); por defecto, pid
+ *   -u user[,user...]   solo procesos de esos usuarios (nombre o uid)
+ *   -C name[,name...]   solo procesos con ese nombre de ejecutable
+ *   --forest, -H        árbol de procesos
+ *   -w seconds          repetir cada `seconds' segundos hasta que se aprieta
+ *                       'q'; el %CPU (pcpu) y el cambio de memoria (drss) se
+ *                       miden entre una muestra y la siguiente
+ *   -n count            con -w, terminar después de `count' muestras
+ * Los errores de uso se informan por stderr.
+ *   Returns: EXIT_SUCCESS, o EXIT_FAILURE si las opciones no son válidas o no
+ *     se pudo leer /proc.
+ * Requires: args != NULL
+ */
+
+#endif /* PS_H */
@@ -0,0 +1,283 @@
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+
+#include "read.h"
+#include "vars.h"
+
+#define READ_BLOCK_MIN 128         // Primera lectura más chica
+#define READ_BLOCK_MAX (64 * 1024) // Lectura más grande (una línea más larga se lee en varias)
+#define READ_USAGE "read: usage: read [-r] [-u fd] [-p prompt] [name ...]\n"
+#define DEFAULT_IFS " \t\n"
+
+// Tamaño de la primera lectura de cada línea: sigue el largo de las últimas líneas leídas,
+// así no se lee (y se devuelve) mucho más de lo que hace falta
+static size_t block_hint = READ_BLOCK_MIN;
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de leer una línea de a un byte
+  -- en un pipe o una terminal es la única forma de no consumir nada de la línea siguiente --
+------------------------------------------------------------------------------------------------
+*/
+static bool read_bytes(int fd, GString *line)
+{
+    char c;
+    ssize_t n;
+    while ((n = read(fd, &c, 1)) != 0)
+    {
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0)
+        {
+            perror("read");
+            return false;
+        }
+        if (c == '\n')
+        {
+            return true;
+        }
+        g_string_append_c(line, c);
+    }
+    return false;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de leer una línea de a bloques desde `offset'
+  -- cada bloque se lee directo al final de `line'; si no tiene '\n' el siguiente es del doble.
+     Al final el offset de `fd' se deja justo después de la línea, así lo que se leyó de más
+                           queda para el próximo que lea de `fd' --
+------------------------------------------------------------------------------------------------
+*/
+static bool read_blocks(int fd, off_t offset, GString *line)
+{
+    size_t chunk = block_hint;
+    bool found = false;
+    while (!found)
+    {
+        size_t start = line->len;
+        g_string_set_size(line, start + chunk);
+        ssize_t n = pread(fd, line->str + start, chunk, offset);
+        if (n < 0 && errno == EINTR)
+        {
+            g_string_set_size(line, start);
+            continue;
+        }
+        if (n <= 0)
+        {
+            if (n < 0)
+            {
+                perror("read");
+            }
+            g_string_set_size(line, start);
+            break;
+        }
+        char *newline = memchr(line->str + start, '\n', n);
+        size_t used = (newline != NULL) ? (size_t)(newline - (line->str + start)) : (size_t)n;
+        g_string_set_size(line, start + used);
+        offset += used + (newline != NULL);
+        found = (newline != NULL);
+        if (chunk < READ_BLOCK_MAX)
+        {
+            chunk *= 2;
+        }
+    }
+    lseek(fd, offset, SEEK_SET);
+    // la próxima primera lectura alcanza para dos líneas como esta, sin pasarse mucho
+    while (block_hint < READ_BLOCK_MAX && block_hint < 2 * (line->len + 1))
+    {
+        block_hint *= 2;
+    }
+    while (block_hint > READ_BLOCK_MIN && block_hint > 8 * (line->len + 1))
+    {
+        block_hint /= 2;
+    }
+    return found;
+}
+
+bool read_line(int fd, GString *line, int strategy)
+{
+    assert(line != NULL);
+    g_string_truncate(line, 0);
+    // un pipe o una terminal no se pueden posicionar: lseek falla con ESPIPE
+    off_t offset = (strategy == READ_AUTO) ? lseek(fd, 0, SEEK_CUR) : -1;
+    return (offset < 0) ? read_bytes(fd, line) : read_blocks(fd, offset, line);
+}
+
+// Marca en `separator' los caracteres de `ifs', para no buscarlos con strchr en cada caracter
+static void separator_table(const char *ifs, bool separator[UCHAR_MAX + 1])
+{
+    memset(separator, 0, (UCHAR_MAX + 1) * sizeof(bool));
+    for (; *ifs != '\0'; ifs++)
+    {
+        separator[(unsigned char)*ifs] = true;
+    }
+}
+
+static void skip_separators(const GString *line, size_t *i, const bool *separator)
+{
+    while (*i < line->len && separator[(unsigned char)line->str[*i]])
+    {
+        (*i)++;
+    }
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de repartir la línea entre las variables de `names'
+  -- cada nombre recibe un campo y el último el resto (sin los separadores del final). Sin
+        -r, una '\' hace que el caracter siguiente se tome tal cual, aunque sea separador.
+              Los tramos sin caracteres especiales se copian enteros al campo --
+------------------------------------------------------------------------------------------------
+*/
+static void assign_fields(const GString *line, scommand names, bool raw, const bool *separator)
+{
+    const unsigned char *text = (const unsigned char *)line->str;
+    GString *field = g_string_new(NULL);
+    size_t i = 0;
+    skip_separators(line, &i, separator);
+    for (; !scommand_is_empty(names); scommand_pop_front(names))
+    {
+        bool last = (scommand_length(names) == 1);
+        size_t keep = 0; // largo del campo sin los separadores del final
+        g_string_truncate(field, 0);
+        while (i < line->len)
+        {
+            size_t run = i;
+            while (run < line->len && !separator[text[run]] && (raw || text[run] != '\\'))
+            {
+                run++;
+            }
+            g_string_append_len(field, line->str + i, run - i);
+            keep = (run > i) ? field->len : keep;
+            i = run;
+            if (i == line->len)
+            {
+                break;
+            }
+            if (!raw && text[i] == '\\')
+            {
+                // una '\' sola al final (si no hubo más líneas) queda como está
+                size_t escaped = (i + 1 < line->len) ? i + 1 : i;
+                g_string_append_c(field, line->str[escaped]);
+                i = escaped + 1;
+                keep = field->len;
+                continue;
+            }
+            if (!last)
+            {
+                break;
+            }
+            g_string_append_c(field, line->str[i++]);
+        }
+        g_string_truncate(field, keep);
+        vars_set(scommand_front(names), field->str);
+        skip_separators(line, &i, separator);
+    }
+    g_string_free(field, TRUE);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de ver si la línea termina en una '\' sin escapar
+------------------------------------------------------------------------------------------------
+*/
+static bool continues(const GString *line)
+{
+    size_t backslashes = 0;
+    while (backslashes < line->len && line->str[line->len - 1 - backslashes] == '\\')
+    {
+        backslashes++;
+    }
+    return backslashes % 2 == 1;
+}
+
+bool read_run(scommand args)
+{
+    assert(args != NULL);
+    bool raw = false;
+    long fd = STDIN_FILENO;
+    const char *prompt = NULL;
+    while (!scommand_is_empty(args) && scommand_front(args)[0] == '-')
+    {
+        char *option = scommand_front(args), *end = NULL;
+        if (strcmp(option, "-r") == 0)
+        {
+            raw = true;
+        }
+        else if (strcmp(option, "-u") == 0 && scommand_length(args) > 1)
+        {
+            scommand_pop_front(args);
+            fd = strtol(scommand_front(args), &end, 10);
+            if (scommand_front(args)[0] == '\0' || *end != '\0' || fd < 0)
+            {
+                fprintf(stderr, "read: %s: invalid file descriptor\n", scommand_front(args));
+                return false;
+            }
+        }
+        else if (strcmp(option, "-p") == 0 && scommand_length(args) > 1)
+        {
+            scommand_pop_front(args);
+            prompt = scommand_front(args);
+            if (isatty((int)fd))
+            {
+                fputs(prompt, stderr);
+            }
+        }
+        else
+        {
+            fputs(READ_USAGE, stderr);
+            return false;
+        }
+        scommand_pop_front(args);
+    }
+    for (unsigned int i = 0; i < scommand_length(args); i++)
+    {
+        const char *name = scommand_front(args);
+        if (!vars_valid_name(name, strlen(name)))
+        {
+            fprintf(stderr, "read: `%s': not a valid identifier\n", name);
+            return false;
+        }
+        // se revisa cada nombre rotando la lista, así queda en el mismo orden
+        scommand_push_back(args, scommand_steal_front(args));
+    }
+
+    GString *line = g_string_new(NULL), *next = g_string_new(NULL);
+    bool found = read_line((int)fd, line, READ_AUTO);
+    while (!raw && continues(line))
+    {
+        // una '\' al final continúa la línea en la siguiente
+        g_string_truncate(line, line->len - 1);
+        if (!found)
+        {
+            break;
+        }
+        found = read_line((int)fd, next, READ_AUTO);
+        g_string_append_len(line, next->str, next->len);
+    }
+    bool separator[UCHAR_MAX + 1];
+    if (scommand_is_empty(args))
+    {
+        // REPLY recibe la línea completa, sin sacarle separadores
+        scommand_push_back(args, strdup("REPLY"));
+        separator_table("", separator);
+    }
+    else
+    {
+        const char *ifs = vars_get("IFS");
+        separator_table((ifs != NULL) ? ifs : DEFAULT_IFS, separator);
+    }
+    assign_fields(line, args, raw, separator);
+    g_string_free(line, TRUE);
+    g_string_free(next, TRUE);
+    return found;
+}
@@ -0,0 +1,47 @@
+/* Comando interno read.
+ * Si el descriptor se puede posicionar (un archivo común), lee un bloque,
+ * toma una línea y deja el offset justo después de ella. Así un comando que
+ * se ejecute después lee desde ahí, como si read hubiera leído de a un
+ * byte. En un pipe o una terminal no se puede devolver lo leído de más, y
+ * ahí sí se lee de a un byte.
+ */
+
+#ifndef READ_H
+#define READ_H
+
+#include <stdbool.h>
+#include <glib.h>
+
+#include "command.h"
+
+#define READ_AUTO 0  // de a bloques si el descriptor se puede posicionar, si no de a un byte
+#define READ_BYTES 1 // siempre de a un byte (para comparar)
+
+bool read_line(int fd, GString *line, int strategy);
+/*
+ * Lee de `fd' hasta el próximo '\n' (que se consume pero no se guarda) y
+ * deja el texto en `line' (que se vacía antes). El offset de `fd' queda
+ * justo después del '\n'.
+ *   strategy: READ_AUTO o READ_BYTES.
+ *   Returns: true si se encontró el '\n'; false al llegar al final del
+ *     archivo (o ante un error): `line' tiene lo que se haya leído.
+ * Requires: line != NULL
+ */
+
+bool read_run(scommand args);
+/*
+ * Ejecuta read. Los argumentos (sin el "read") se consumen de `args':
+ *   read [-r] [-u fd] [-p prompt] [name...]
+ *   -r  una '\' no es especial (sin -r, \x es x y una '\' al final de la
+ *       línea la continúa en la siguiente)
+ *   -u  leer de `fd' en lugar de la entrada estándar
+ *   -p  mostrar `prompt' en stderr antes de leer, si la entrada es una
+ *       terminal
+ * La línea se separa en campos por los caracteres de $IFS (espacio, tab y
+ * '\n' si no está definida): cada nombre recibe un campo y el último recibe
+ * el resto. Sin nombres, la línea completa va a REPLY.
+ *   Returns: true si se leyó una línea completa; false al final del archivo.
+ * Requires: args != NULL
+ */
+
+#endif /* READ_H */
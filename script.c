@@ -0,0 +1,660 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#include "script.h"
+#include "command.h"
+#include "execute.h"
+#include "parsing.h"
+#include "vars.h"
+#include "brace.h"
+#include "pathname.h"
+
+#define RUN_WAIT (1u << 0)   // OP_RUN: esperar al pipeline
+#define RUN_EXPAND (1u << 1) // OP_RUN: alguna palabra tiene un '$', comillas, unas llaves o un comodín
+#define REDIR_IN (1u << 0)
+#define REDIR_OUT (1u << 1)
+
+/* Instrucciones. Cada una ocupa un entero y sus operandos los siguientes:
+ *   OP_RUN next flags commands, y por comando: words redirs palabra...
+ *   OP_JUMP destino
+ *   OP_JUMP_IF_FAILED destino        (si $? != 0)
+ *   OP_JUMP_IF_SUCCEEDED destino     (si $? == 0)
+ *   OP_SET_STATUS estado
+ *   OP_LOOP_BEGIN ciclo              (el estado del ciclo empieza en 0)
+ *   OP_LOOP_SAVE ciclo               (guarda $? como estado del ciclo)
+ *   OP_LOOP_END ciclo                ($? pasa a ser el estado del ciclo)
+ *   OP_FOR_BEGIN ciclo next count palabra...
+ *   OP_FOR_NEXT ciclo salida nombre  (asigna el próximo valor o salta a la salida)
+ * Una palabra es su largo y después sus bytes con el '\0', completando el último entero.
+ */
+enum opcode
+{
+    OP_END,
+    OP_RUN,
+    OP_JUMP,
+    OP_JUMP_IF_FAILED,
+    OP_JUMP_IF_SUCCEEDED,
+    OP_SET_STATUS,
+    OP_LOOP_BEGIN,
+    OP_LOOP_SAVE,
+    OP_LOOP_END,
+    OP_FOR_BEGIN,
+    OP_FOR_NEXT
+};
+
+enum keyword
+{
+    KW_NONE,
+    KW_IF,
+    KW_THEN,
+    KW_ELIF,
+    KW_ELSE,
+    KW_FI,
+    KW_WHILE,
+    KW_UNTIL,
+    KW_FOR,
+    KW_DO,
+    KW_DONE
+};
+
+static const char *const keywords[] = {"", "if", "then", "elif", "else", "fi", "while", "until", "for", "do", "done"};
+
+// Un if o un ciclo que todavía no se cerró. Los operandos a completar valen 0 si no hay ninguno
+struct frame
+{
+    enum keyword opener; // KW_IF, KW_WHILE, KW_UNTIL o KW_FOR
+    bool body;           // ya pasó el then o el do
+    bool has_else;
+    uint32_t start; // ciclos: dónde empieza cada vuelta (la condición, o el OP_FOR_NEXT)
+    uint32_t loop;  // ciclos: número de ciclo (su estado al ejecutar)
+    uint32_t skip;  // operando del salto por el && o || que tenía delante, hasta el final
+    uint32_t next;  // if: operando del salto al próximo elif/else; ciclo: del salto de salida
+    GArray *ends;   // if: operandos de los saltos al fi
+};
+
+// Estado de un ciclo mientras se ejecuta. Un for recorre sus palabras sin expandirlas todas
+// de antemano: {1..10000000} da un valor por vuelta
+struct loop_state
+{
+    int status;             // estado del último comando del cuerpo (0 si no se ejecutó)
+    const uint32_t *source; // for: próxima palabra del código, sin expandir
+    uint32_t remaining;     // for: palabras del código que faltan
+    brace generator;        // for: expansiones de llaves de la palabra actual
+    GPtrArray *words;       // for: valores de la expansión actual (${a[@]} da varios)
+    guint position;
+};
+
+struct script_s
+{
+    uint32_t *code;
+    size_t length;
+    size_t allocated;
+    GArray *frames;  // struct frame, el último es el más interno
+    uint32_t loops;  // ciclos del código
+    int status;      // estado de la última ejecución
+};
+
+script script_new(void)
+{
+    script result = calloc(1, sizeof(struct script_s));
+    assert(result != NULL);
+    result->frames = g_array_new(FALSE, FALSE, sizeof(struct frame));
+    return result;
+}
+
+void script_discard(script self)
+{
+    assert(self != NULL);
+    for (guint i = 0; i < self->frames->len; i++)
+    {
+        struct frame *frame = &g_array_index(self->frames, struct frame, i);
+        if (frame->ends != NULL)
+        {
+            g_array_free(frame->ends, TRUE);
+        }
+    }
+    g_array_set_size(self->frames, 0);
+    self->length = 0;
+    self->loops = 0;
+}
+
+script script_destroy(script self)
+{
+    assert(self != NULL);
+    script_discard(self);
+    g_array_free(self->frames, TRUE);
+    free(self->code);
+    free(self);
+    return NULL;
+}
+
+bool script_pending(const script self)
+{
+    assert(self != NULL);
+    return self->frames->len > 0;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de agregar un entero al código
+                        -- devuelve su posición --
+------------------------------------------------------------------------------------------------
+*/
+static uint32_t emit(script self, uint32_t value)
+{
+    if (self->length == self->allocated)
+    {
+        self->allocated = (self->allocated > 0) ? 2 * self->allocated : 256;
+        self->code = realloc(self->code, self->allocated * sizeof(uint32_t));
+        assert(self->code != NULL);
+    }
+    self->code[self->length] = value;
+    return self->length++;
+}
+
+// El salto cuyo operando está en `operand' va a la próxima instrucción que se agregue
+static void patch(script self, uint32_t operand)
+{
+    if (operand != 0)
+    {
+        self->code[operand] = self->length;
+    }
+}
+
+static void emit_word(script self, const char *word)
+{
+    size_t length = strlen(word), units = length / sizeof(uint32_t) + 1;
+    emit(self, length);
+    size_t at = self->length;
+    for (size_t i = 0; i < units; i++)
+    {
+        emit(self, 0);
+    }
+    memcpy(self->code + at, word, length);
+}
+
+static char *read_word(const uint32_t **p)
+{
+    uint32_t length = **p;
+    char *word = strdup((const char *)(*p + 1));
+    *p += 1 + length / sizeof(uint32_t) + 1;
+    return word;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de compilar un pipeline
+  -- sus palabras se copian al código, junto con un aviso de si hay que expandir alguna --
+------------------------------------------------------------------------------------------------
+*/
+static void emit_pipeline(script self, pipeline pipe)
+{
+    emit(self, OP_RUN);
+    uint32_t next = emit(self, 0);
+    uint32_t flags = emit(self, pipeline_get_wait(pipe) ? RUN_WAIT : 0);
+    emit(self, pipeline_length(pipe));
+    bool expand = false;
+    for (unsigned int i = 0; i < pipeline_length(pipe); i++)
+    {
+        scommand cmd = pipeline_nth(pipe, i);
+        const char *in = scommand_get_redir_in(cmd), *out = scommand_get_redir_out(cmd);
+        emit(self, scommand_length(cmd));
+        emit(self, ((in != NULL) ? REDIR_IN : 0) | ((out != NULL) ? REDIR_OUT : 0));
+        for (; !scommand_is_empty(cmd); scommand_pop_front(cmd))
+        {
+            const char *word = scommand_front(cmd);
+            expand = expand || strpbrk(word, "$'\"") != NULL || brace_has_expression(word) || pathname_has_pattern(word);
+            emit_word(self, scommand_front(cmd));
+        }
+        for (int redir = 0; redir < 2; redir++)
+        {
+            const char *file = (redir == 0) ? in : out;
+            if (file != NULL)
+            {
+                expand = expand || strpbrk(file, "$'\"") != NULL;
+                emit_word(self, file);
+            }
+        }
+    }
+    self->code[flags] |= expand ? RUN_EXPAND : 0;
+    patch(self, next);
+}
+
+// El salto de un && o || por encima de lo que sigue; devuelve su operando (0 si no hay conector)
+static uint32_t emit_connector(script self, cmdlist_connector connector)
+{
+    if (connector == CMDLIST_ALWAYS)
+    {
+        return 0;
+    }
+    emit(self, (connector == CMDLIST_AND) ? OP_JUMP_IF_FAILED : OP_JUMP_IF_SUCCEEDED);
+    return emit(self, 0);
+}
+
+static enum keyword keyword_of(pipeline pipe)
+{
+    scommand cmd = pipeline_front(pipe);
+    for (unsigned int kw = KW_IF; !scommand_is_empty(cmd) && kw <= KW_DONE; kw++)
+    {
+        if (strcmp(scommand_front(cmd), keywords[kw]) == 0)
+        {
+            return kw;
+        }
+    }
+    return KW_NONE;
+}
+
+static struct frame *top_frame(script self)
+{
+    return (self->frames->len > 0) ? &g_array_index(self->frames, struct frame, self->frames->len - 1) : NULL;
+}
+
+static void push_frame(script self, enum keyword opener, uint32_t skip)
+{
+    struct frame frame = {opener, false, false, 0, 0, skip, 0, NULL};
+    if (opener == KW_IF)
+    {
+        frame.ends = g_array_new(FALSE, FALSE, sizeof(uint32_t));
+    }
+    else
+    {
+        frame.loop = self->loops++;
+    }
+    g_array_append_val(self->frames, frame);
+}
+
+static void pop_frame(script self)
+{
+    struct frame *frame = top_frame(self);
+    patch(self, frame->skip);
+    if (frame->ends != NULL)
+    {
+        g_array_free(frame->ends, TRUE);
+    }
+    g_array_set_size(self->frames, self->frames->len - 1);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de compilar la cabecera de un for: for NOMBRE [in palabra...]
+------------------------------------------------------------------------------------------------
+*/
+static bool compile_for(script self, pipeline pipe, uint32_t skip)
+{
+    scommand cmd = pipeline_front(pipe);
+    if (pipeline_length(pipe) != 1 || scommand_is_empty(cmd) ||
+        !vars_valid_name(scommand_front(cmd), strlen(scommand_front(cmd))))
+    {
+        return false;
+    }
+    char *name = scommand_steal_front(cmd);
+    bool in = !scommand_is_empty(cmd) && strcmp(scommand_front(cmd), "in") == 0;
+    if (in)
+    {
+        scommand_pop_front(cmd);
+    }
+    push_frame(self, KW_FOR, skip);
+    struct frame *frame = top_frame(self);
+    // sin "in" no hay nada que recorrer (este shell no tiene parámetros posicionales)
+    emit(self, OP_FOR_BEGIN);
+    emit(self, frame->loop);
+    uint32_t next = emit(self, 0);
+    emit(self, in ? scommand_length(cmd) : 0);
+    for (; in && !scommand_is_empty(cmd); scommand_pop_front(cmd))
+    {
+        emit_word(self, scommand_front(cmd));
+    }
+    patch(self, next);
+    frame->start = emit(self, OP_FOR_NEXT);
+    emit(self, frame->loop);
+    frame->next = emit(self, 0);
+    emit_word(self, name);
+    free(name);
+    return true;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de compilar un pipeline de una lista
+  -- si empieza con una palabra clave, se abre, sigue o cierra un if o un ciclo, y lo que
+      queda después de la palabra (then echo a) se compila como otro pipeline de la lista --
+------------------------------------------------------------------------------------------------
+*/
+static bool compile_pipeline(script self, pipeline pipe, cmdlist_connector connector)
+{
+    enum keyword kw = keyword_of(pipe);
+    struct frame *frame = top_frame(self);
+    if (kw == KW_NONE)
+    {
+        uint32_t skip = emit_connector(self, connector);
+        emit_pipeline(self, pipe);
+        patch(self, skip);
+        return true;
+    }
+    if (kw == KW_FOR)
+    {
+        scommand_pop_front(pipeline_front(pipe));
+        return compile_for(self, pipe, emit_connector(self, connector));
+    }
+    // then, elif, else, do y done siguen a un ';' o a un fin de línea, nunca a un && o ||
+    bool opener = (kw == KW_IF || kw == KW_WHILE || kw == KW_UNTIL);
+    if (!opener && connector != CMDLIST_ALWAYS)
+    {
+        return false;
+    }
+    bool in_if = (frame != NULL && frame->opener == KW_IF);
+    bool in_loop = (frame != NULL && !in_if);
+    switch (kw)
+    {
+    case KW_IF:
+        push_frame(self, KW_IF, emit_connector(self, connector));
+        break;
+    case KW_WHILE:
+    case KW_UNTIL:
+    {
+        uint32_t skip = emit_connector(self, connector);
+        push_frame(self, kw, skip);
+        frame = top_frame(self);
+        emit(self, OP_LOOP_BEGIN);
+        emit(self, frame->loop);
+        frame->start = self->length;
+        break;
+    }
+    case KW_THEN:
+        if (!in_if || frame->body)
+        {
+            return false;
+        }
+        emit(self, OP_JUMP_IF_FAILED);
+        frame->next = emit(self, 0);
+        frame->body = true;
+        break;
+    case KW_ELIF:
+    case KW_ELSE:
+        if (!in_if || !frame->body || frame->has_else)
+        {
+            return false;
+        }
+        emit(self, OP_JUMP);
+        uint32_t end = emit(self, 0);
+        g_array_append_val(frame->ends, end);
+        patch(self, frame->next);
+        frame->next = 0;
+        frame->body = (kw == KW_ELSE);
+        frame->has_else = (kw == KW_ELSE);
+        break;
+    case KW_DO:
+        if (!in_loop || frame->body)
+        {
+            return false;
+        }
+        if (frame->opener != KW_FOR)
+        {
+            emit(self, (frame->opener == KW_WHILE) ? OP_JUMP_IF_FAILED : OP_JUMP_IF_SUCCEEDED);
+            frame->next = emit(self, 0);
+        }
+        frame->body = true;
+        break;
+    case KW_FI:
+    case KW_DONE:
+        if (!frame || !frame->body || (kw == KW_FI) != in_if)
+        {
+            return false;
+        }
+        break;
+    default:
+        return false;
+    }
+
+    scommand cmd = pipeline_front(pipe);
+    scommand_pop_front(cmd);
+    bool rest = !scommand_is_empty(cmd) || scommand_get_redir_in(cmd) != NULL || scommand_get_redir_out(cmd) != NULL;
+    if (kw == KW_FI || kw == KW_DONE)
+    {
+        // fi y done van solos (tampoco se pueden redirigir ni mandar al fondo)
+        if (rest || pipeline_length(pipe) > 1 || !pipeline_get_wait(pipe))
+        {
+            return false;
+        }
+        if (kw == KW_FI && frame->next != 0)
+        {
+            // sin else: si ninguna condición se cumplió, el if termina bien
+            emit(self, OP_JUMP);
+            uint32_t end = emit(self, 0);
+            g_array_append_val(frame->ends, end);
+            patch(self, frame->next);
+            emit(self, OP_SET_STATUS);
+            emit(self, 0);
+        }
+        for (guint i = 0; kw == KW_FI && i < frame->ends->len; i++)
+        {
+            patch(self, g_array_index(frame->ends, uint32_t, i));
+        }
+        if (kw == KW_DONE)
+        {
+            emit(self, OP_LOOP_SAVE);
+            emit(self, frame->loop);
+            emit(self, OP_JUMP);
+            emit(self, frame->start);
+            patch(self, frame->next);
+            emit(self, OP_LOOP_END);
+            emit(self, frame->loop);
+        }
+        pop_frame(self);
+        return true;
+    }
+    if (!rest)
+    {
+        // "if | a" no tiene sentido
+        return pipeline_length(pipe) == 1;
+    }
+    // lo que sigue puede empezar con otra palabra clave (do for j in ...)
+    return compile_pipeline(self, pipe, CMDLIST_ALWAYS);
+}
+
+bool script_compile(script self, cmdlist list)
+{
+    assert(self != NULL && list != NULL);
+    bool ok = true;
+    for (unsigned int i = 0; ok && i < cmdlist_length(list); i++)
+    {
+        pipeline pipe = cmdlist_nth(list, i);
+        // compilar le saca las palabras: la primera se guarda para el mensaje de error
+        scommand first = pipeline_front(pipe);
+        char *word = strdup(scommand_is_empty(first) ? "" : scommand_front(first));
+        ok = compile_pipeline(self, pipe, cmdlist_connector_nth(list, i));
+        if (!ok)
+        {
+            fprintf(stderr, "mybash: syntax error near `%s'\n", word);
+        }
+        free(word);
+    }
+    if (!ok)
+    {
+        script_discard(self);
+    }
+    cmdlist_destroy(list);
+    return ok;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de armar y ejecutar el pipeline de un OP_RUN
+  -- las palabras se expanden solo si al compilar se vio algún '$', comillas, llaves o comodín --
+------------------------------------------------------------------------------------------------
+*/
+static int run_pipeline(const uint32_t *code)
+{
+    uint32_t flags = code[2], commands = code[3];
+    const uint32_t *p = code + 4;
+    pipeline apipe = pipeline_new();
+    pipeline_set_wait(apipe, (flags & RUN_WAIT) != 0);
+    for (uint32_t i = 0; i < commands; i++)
+    {
+        uint32_t words = p[0], redirs = p[1];
+        p += 2;
+        scommand cmd = scommand_new();
+        for (uint32_t j = 0; j < words; j++)
+        {
+            scommand_push_back(cmd, read_word(&p));
+        }
+        if (redirs & REDIR_IN)
+        {
+            scommand_set_redir_in(cmd, read_word(&p));
+        }
+        if (redirs & REDIR_OUT)
+        {
+            scommand_set_redir_out(cmd, read_word(&p));
+        }
+        pipeline_push_back(apipe, cmd);
+    }
+    // un comando que se expandió a nada no ejecuta nada (y termina bien); una redirección ambigua falla
+    int status = EXIT_SUCCESS;
+    bool runnable = !(flags & RUN_EXPAND) || expand_pipeline(apipe, &status);
+    status = runnable ? execute_pipeline(apipe) : status;
+    pipeline_destroy(apipe);
+    return status;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de dar el próximo valor de un for
+  -- expande la próxima palabra del código (o la próxima expansión de sus llaves) recién cuando
+                      se acabaron los valores de la anterior --
+------------------------------------------------------------------------------------------------
+*/
+static const char *for_next(struct loop_state *loop)
+{
+    while (loop->position == loop->words->len)
+    {
+        char *word = (loop->generator != NULL) ? brace_next(loop->generator) : NULL;
+        if (word == NULL && loop->generator != NULL)
+        {
+            loop->generator = brace_destroy(loop->generator);
+        }
+        else if (word != NULL)
+        {
+            g_ptr_array_set_size(loop->words, 0);
+            loop->position = 0;
+            expand_word(word, loop->words);
+        }
+        else if (loop->remaining > 0)
+        {
+            char *next = read_word(&loop->source);
+            loop->remaining--;
+            loop->generator = brace_new(next);
+            free(next);
+        }
+        else
+        {
+            return NULL;
+        }
+    }
+    return g_ptr_array_index(loop->words, loop->position++);
+}
+
+// Libera lo que le quedaba por recorrer a un for
+static void for_end(struct loop_state *loop)
+{
+    if (loop->generator != NULL)
+    {
+        loop->generator = brace_destroy(loop->generator);
+    }
+    if (loop->words != NULL)
+    {
+        g_ptr_array_free(loop->words, TRUE);
+        loop->words = NULL;
+    }
+}
+
+int script_run(script self)
+{
+    assert(self != NULL && !script_pending(self));
+    if (self->length == 0)
+    {
+        return self->status;
+    }
+    emit(self, OP_END);
+    const uint32_t *code = self->code;
+    struct loop_state *loops = calloc(self->loops + 1, sizeof(struct loop_state));
+    assert(loops != NULL);
+    int status = self->status;
+    size_t pc = 0;
+    const char *value = NULL;
+    bool running = true;
+    while (running)
+    {
+        struct loop_state *loop = &loops[(code[pc] >= OP_LOOP_BEGIN) ? code[pc + 1] : self->loops];
+        switch (code[pc])
+        {
+        case OP_RUN:
+            status = run_pipeline(code + pc);
+            vars_set_status(status);
+            pc = code[pc + 1];
+            break;
+        case OP_JUMP:
+            pc = code[pc + 1];
+            break;
+        case OP_JUMP_IF_FAILED:
+            pc = (status != 0) ? code[pc + 1] : pc + 2;
+            break;
+        case OP_JUMP_IF_SUCCEEDED:
+            pc = (status == 0) ? code[pc + 1] : pc + 2;
+            break;
+        case OP_SET_STATUS:
+            status = code[pc + 1];
+            vars_set_status(status);
+            pc += 2;
+            break;
+        case OP_LOOP_BEGIN:
+            loop->status = 0;
+            pc += 2;
+            break;
+        case OP_LOOP_SAVE:
+            loop->status = status;
+            pc += 2;
+            break;
+        case OP_LOOP_END:
+            status = loop->status;
+            vars_set_status(status);
+            for_end(loop);
+            pc += 2;
+            break;
+        case OP_FOR_BEGIN:
+            // las palabras se expanden a medida que el ciclo las recorre
+            for_end(loop);
+            loop->status = 0;
+            loop->source = code + pc + 4;
+            loop->remaining = code[pc + 3];
+            loop->words = g_ptr_array_new_with_free_func(free);
+            loop->position = 0;
+            pc = code[pc + 2];
+            break;
+        case OP_FOR_NEXT:
+            value = for_next(loop);
+            if (value != NULL)
+            {
+                const uint32_t *name = code + pc + 3;
+                vars_set((const char *)(name + 1), value);
+                pc += 3 + 1 + name[0] / sizeof(uint32_t) + 1;
+            }
+            else
+            {
+                pc = code[pc + 2];
+            }
+            break;
+        default:
+            running = false;
+            break;
+        }
+    }
+    free(loops);
+    self->status = status;
+    self->length = 0;
+    self->loops = 0;
+    return status;
+}
@@ -0,0 +1,70 @@
+/* Compilación y ejecución de scripts.
+ * Las listas de parse_list se compilan a un bytecode que vive en un solo
+ * bloque contiguo de enteros de 32 bits: saltos para &&, ||, if, while,
+ * until y for, y los pipelines mismos (sus palabras van dentro del bloque,
+ * junto a la instrucción que los ejecuta). Un ciclo se parsea y se compila
+ * una sola vez, y en cada vuelta solo se expanden las palabras que tienen un
+ * '$' o unas llaves; un pipeline sin ninguna se arma tal cual. Las palabras
+ * de un for se expanden a medida que se recorren ({1..10000000} no se arma
+ * entero).
+ *
+ * Las palabras clave (if, then, elif, else, fi, while, until, for, in, do,
+ * done) se reconocen al principio de un comando. Un if o un ciclo puede
+ * ocupar varias líneas: se van compilando a medida que llegan, y el código
+ * se ejecuta cuando se cerró todo lo que se abrió.
+ */
+
+#ifndef SCRIPT_H
+#define SCRIPT_H
+
+#include <stdbool.h>
+
+#include "cmdlist.h"
+
+typedef struct script_s *script;
+
+script script_new(void);
+/*
+ * Nuevo script, sin código.
+ * Ensures: result != NULL && !script_pending(result)
+ */
+
+script script_destroy(script self);
+/*
+ * Destruye `self' y su código.
+ * Requires: self != NULL
+ * Ensures: result == NULL
+ */
+
+bool script_compile(script self, cmdlist list);
+/*
+ * Agrega al código de `self' los pipelines de `list' (una línea).
+ *   list: se destruye; los pipelines ya no hacen falta después de compilarlos.
+ *   Returns: false si hay un error de sintaxis (una palabra clave fuera de
+ *     lugar); se avisa por stderr y se descarta todo el código sin ejecutar.
+ * Requires: self != NULL && list != NULL
+ */
+
+bool script_pending(const script self);
+/*
+ * Indica si quedó abierto un if o un ciclo, que sigue en las próximas líneas.
+ * Requires: self != NULL
+ */
+
+void script_discard(script self);
+/*
+ * Descarta el código sin ejecutarlo, con lo que haya quedado abierto.
+ * Requires: self != NULL
+ * Ensures: !script_pending(self)
+ */
+
+int script_run(script self);
+/*
+ * Ejecuta el código compilado y lo descarta. Después de cada pipeline el
+ * estado de salida queda en $?.
+ *   Returns: estado de salida del último pipeline que se ejecutó (o el de la
+ *     ejecución anterior si no había nada).
+ * Requires: self != NULL && !script_pending(self)
+ */
+
+#endif /* SCRIPT_H */
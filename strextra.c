@@ -14,3 +14,16 @@ char * strmerge(char *s1, char *s2) {
     assert(merge != NULL && strlen(merge) == strlen(s1) + strlen(s2));
     return merge;
 }
+
+char *path_join(const char *path, const char *name, bool slash)
+{
+    assert(path != NULL && name != NULL);
+    size_t path_length = strlen(path), name_length = strlen(name);
+    char *result = malloc(path_length + name_length + 2);
+    assert(result != NULL);
+    memcpy(result, path, path_length);
+    memcpy(result + path_length, name, name_length);
+    result[path_length + name_length] = '/';
+    result[path_length + name_length + slash] = '\0';
+    return result;
+}
@@ -1,6 +1,7 @@
 #ifndef _STREXTRA_H_
 #define _STREXTRA_H_
 
+#include <stdbool.h>
 
 char * strmerge(char *s1, char *s2);
 /*
@@ -19,5 +20,14 @@ char * strmerge(char *s1, char *s2);
  *
  */
 
+char *path_join(const char *path, const char *name, bool slash);
+/*
+ * Devuelve en memoria nueva (a liberar con free()) `path' seguido de
+ * `name', sin agregar nada entre los dos; con `slash' termina en '/'.
+ * `path' ya tiene que terminar en '/' (o ser "") si hace falta separarlos.
+ *
+ * REQUIRES:
+ *     path != NULL && name != NULL
+ */
 
 #endif
@@ -1,125 +1,482 @@
-#include <math.h>  // permite usar fmin()
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h> // permite usar printf()
 #include <stdlib.h>
 #include <string.h> // permite usar strlen()
-#include <limits.h> // permite usar INT_MAX
+#include <time.h>
+#include <unistd.h>
+#include <limits.h> // permite usar UCHAR_MAX
+#include <glib.h>
 
 #include "syntax.h"
+#include "bktree.h"
+#include "builtin.h"
+#include "completion.h"
+#include "dircache.h"
+#include "dictionary.h" // generado por tools/gentables a partir de commands.in
 
-#define MAX_COMMAND_LENGTH 100 // Longitud máxima de un comando
-#define INITIAL_CAPACITY 10    // Tamaño inicial del array dinámico de comandos
+#define CLOSE_DISTANCE 2 // Hasta esta distancia se pregunta "Did you mean ...?"
+#define MAX_DISTANCE 3   // Más allá de esta distancia no se sugiere nada
+
+/* Tabla de coincidencias del algoritmo de Myers: para cada carácter, un bit
+ * por cada posición del patrón donde aparece. Se arma con pattern_masks() y se
+ * vuelve a dejar en cero con clear_masks(), tocando solo los caracteres usados:
+ * así no hay que limpiar la tabla entera (2 KiB) en cada comparación.
+ */
+typedef uint64_t char_masks[UCHAR_MAX + 1];
+static _Thread_local char_masks masks;
+
+static void pattern_masks(char_masks peq, const char *pattern, size_t m)
+{
+    for (size_t i = 0; i < m; i++)
+    {
+        peq[(unsigned char)pattern[i]] |= 1ull << i;
+    }
+}
+
+static void clear_masks(char_masks peq, const char *pattern, size_t m)
+{
+    for (size_t i = 0; i < m; i++)
+    {
+        peq[(unsigned char)pattern[i]] = 0;
+    }
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de calcular la distancia de edición con un patrón de hasta 64 letras
+  -- algoritmo de Myers/Hyyrö: una columna entera de la matriz de programación dinámica
+     se guarda como diferencias verticales (+1 en Pv, -1 en Mv), un bit por fila, y se
+     avanza una columna por carácter del texto con unas pocas operaciones de 64 bits --
+------------------------------------------------------------------------------------------------
+*/
+static unsigned int myers_distance(const char_masks peq, size_t m, const char *text, size_t n)
+{
+    const uint64_t last = 1ull << (m - 1); // fila de abajo, donde se lee la distancia
+    uint64_t pv = ~0ull, mv = 0;
+    unsigned int score = m;
+    for (size_t j = 0; j < n; j++)
+    {
+        uint64_t eq = peq[(unsigned char)text[j]];
+        uint64_t xv = eq | mv;
+        uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+        score += ((ph & last) != 0) - ((mh & last) != 0);
+        ph = (ph << 1) | 1; // la primera fila de la matriz crece de a uno
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+    }
+    return score;
+}
+
+/* Bloque de 64 filas de la variante para patrones largos */
+struct myers_block
+{
+    uint64_t pv, mv;
+};
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de avanzar un bloque de 64 filas una columna
+    -- recibe la diferencia horizontal de la fila de arriba del bloque (hin) y devuelve
+                     la de la fila `high' (la de abajo en los bloques llenos) --
+------------------------------------------------------------------------------------------------
+*/
+static int advance_block(struct myers_block *block, uint64_t eq, int hin, uint64_t high)
+{
+    uint64_t pv = block->pv, mv = block->mv;
+    uint64_t xv = eq | mv;
+    if (hin < 0)
+    {
+        eq |= 1;
+    }
+    uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+    uint64_t ph = mv | ~(xh | pv);
+    uint64_t mh = pv & xh;
+    int hout = ((ph & high) != 0) - ((mh & high) != 0);
+    ph <<= 1;
+    mh <<= 1;
+    if (hin < 0)
+    {
+        mh |= 1;
+    }
+    else if (hin > 0)
+    {
+        ph |= 1;
+    }
+    block->pv = mh | ~(xv | ph);
+    block->mv = ph & xv;
+    return hout;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de calcular la distancia de edición con un patrón de más de 64 letras
+    -- el patrón se parte en bloques de 64 filas; cada columna pasa de un bloque al
+                   siguiente la diferencia horizontal de la fila que los separa --
+------------------------------------------------------------------------------------------------
+*/
+static unsigned int myers_blocked_distance(const char *pattern, size_t m, const char *text, size_t n)
+{
+    size_t count = (m + 63) / 64;
+    uint64_t *peq = calloc(count * (UCHAR_MAX + 1), sizeof(uint64_t));
+    struct myers_block *blocks = malloc(count * sizeof(struct myers_block));
+    for (size_t i = 0; i < m; i++)
+    {
+        peq[(unsigned char)pattern[i] * count + i / 64] |= 1ull << (i % 64);
+    }
+    for (size_t b = 0; b < count; b++)
+    {
+        blocks[b].pv = ~0ull;
+        blocks[b].mv = 0;
+    }
+    // en el último bloque la distancia se lee en la fila m-1; las filas de más no afectan a las de abajo
+    const uint64_t last_high = 1ull << ((m - 1) % 64);
+    unsigned int score = m;
+    for (size_t j = 0; j < n; j++)
+    {
+        const uint64_t *eq = peq + (unsigned char)text[j] * count;
+        int h = 1;
+        for (size_t b = 0; b < count; b++)
+        {
+            h = advance_block(&blocks[b], eq[b], h, (b + 1 < count) ? 1ull << 63 : last_high);
+        }
+        score += h;
+    }
+    free(blocks);
+    free(peq);
+    return score;
+}
 
 /*
 ------------------------------------------------------------------------------------------------
   *    Función encargada de buscar la distancia mínima de edición entre dos cadenas
-  -- toma como parámetros dos cadenas de texto y devuelve un entero con la distancia mínima --
-             -- es estática ya que no se necesita fuera de este archivo --
+  -- la distancia es simétrica, así que la cadena más corta hace de patrón (las filas) --
            LA EXPLICACIÓN DETALLADA DE ESTA IMPLEMENTACIÓN ESTÁ EN EL README
 ------------------------------------------------------------------------------------------------
 */
-static int distance_of_edition(const char *s1, const char *s2)
+unsigned int distance_of_edition(const char *s1, const char *s2)
+{
+    size_t len_s1 = strlen(s1);
+    size_t len_s2 = strlen(s2);
+    if (len_s1 > len_s2)
+    {
+        const char *swap = s1;
+        s1 = s2;
+        s2 = swap;
+        len_s1 = len_s2;
+        len_s2 = strlen(s2);
+    }
+    if (len_s1 == 0)
+    {
+        return len_s2;
+    }
+    if (len_s1 > 64)
+    {
+        return myers_blocked_distance(s1, len_s1, s2, len_s2);
+    }
+    pattern_masks(masks, s1, len_s1);
+    unsigned int distance = myers_distance(masks, len_s1, s2, len_s2);
+    clear_masks(masks, s1, len_s1);
+    return distance;
+}
+
+/* Vectores de DISTANCE_LANES enteros de 64 bits (extensión de GCC): cada
+ * operación se aplica a todos los carriles a la vez, con las instrucciones
+ * SIMD que tenga el procesador para el que se compila.
+ */
+typedef uint64_t lanes __attribute__((vector_size(DISTANCE_LANES * sizeof(uint64_t))));
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de calcular DISTANCE_LANES distancias a la vez
+  -- el patrón es el mismo en todos los carriles y cada carril recorre su propio texto;
+     un carril cuyo texto ya terminó sigue calculando, pero su distancia queda fija --
+------------------------------------------------------------------------------------------------
+*/
+static void myers_distance_lanes(const char_masks peq, size_t m, const char *const *texts,
+                                 unsigned int *distances)
+{
+    size_t lengths[DISTANCE_LANES], longest = 0;
+    for (unsigned int l = 0; l < DISTANCE_LANES; l++)
+    {
+        lengths[l] = strlen(texts[l]);
+        longest = MAX(longest, lengths[l]);
+    }
+    const int shift = m - 1; // fila de abajo, donde se lee la distancia
+    lanes pv = ~(lanes){0}, mv = {0}, score = {0};
+    score += m;
+    for (size_t j = 0; j < longest; j++)
+    {
+        lanes eq, active;
+        for (unsigned int l = 0; l < DISTANCE_LANES; l++)
+        {
+            eq[l] = (j < lengths[l]) ? peq[(unsigned char)texts[l][j]] : 0;
+            active[l] = (j < lengths[l]) ? 1 : 0;
+        }
+        lanes xv = eq | mv;
+        lanes xh = (((eq & pv) + pv) ^ pv) | eq;
+        lanes ph = mv | ~(xh | pv);
+        lanes mh = pv & xh;
+        // sin comparaciones vectoriales, que no todos los procesadores tienen para 64 bits
+        score += (ph >> shift) & active;
+        score -= (mh >> shift) & active;
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+    }
+    for (unsigned int l = 0; l < DISTANCE_LANES; l++)
+    {
+        distances[l] = score[l];
+    }
+}
+
+void distance_of_edition_batch(const char *word, const char *const *candidates, unsigned int count,
+                               unsigned int *distances)
+{
+    size_t m = strlen(word);
+    unsigned int i = 0;
+    if (m > 0 && m <= 64)
+    {
+        pattern_masks(masks, word, m);
+        for (; i + DISTANCE_LANES <= count; i += DISTANCE_LANES)
+        {
+            myers_distance_lanes(masks, m, candidates + i, distances + i);
+        }
+        for (; i < count; i++)
+        {
+            distances[i] = myers_distance(masks, m, candidates[i], strlen(candidates[i]));
+        }
+        clear_masks(masks, word, m);
+    }
+    for (; i < count; i++)
+    {
+        distances[i] = distance_of_edition(word, candidates[i]);
+    }
+}
+
+/* Cada fuente de palabras tiene su propio BK-tree: un arreglo de nodos donde
+ * el 0 es la raíz y el orden es el de inserción. Así, cuando cambia un
+ * directorio de $PATH solo se rearma el árbol de ese directorio.
+ */
+static GArray *builtin_tree = NULL;    // comandos internos
+static GArray *dictionary_tree = NULL; // palabras de commands.in, compiladas en dictionary.h
+
+/* Árbol de los ejecutables de un directorio de $PATH. Las palabras son los
+ * nombres del listado, que se mantiene vivo mientras se use el árbol.
+ */
+struct dir_tree
+{
+    dir_listing listing;  // listado del que salieron las palabras (NULL si el directorio no existe)
+    GArray *nodes;        // BK-tree sobre los nombres del listado
+    unsigned long serial; // número de armado, para saber si es posterior a un pedido
+};
+
+static pthread_mutex_t trees_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t trees_ready = PTHREAD_COND_INITIALIZER; // se instaló algún árbol
+static GHashTable *dir_trees = NULL;                          // directorio -> struct dir_tree *
+static unsigned long trees_serial = 0;                        // último número de armado
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de armar los árboles de los comandos internos y del diccionario
+       -- las palabras del diccionario ya vienen en el ejecutable: no se lee ningún archivo --
+------------------------------------------------------------------------------------------------
+*/
+static void dictionary_load(void)
 {
-    // OBTENCIÓN DE LA LONGITUD DE LAS CADENAS
-    int len_s1 = strlen(s1);
-    int len_s2 = strlen(s2);
-    // CREACIÓN DE LA MATRIZ DE DISTANCIAS (DP)
-    int dp[len_s1 + 1][len_s2 + 1];
-    // CASOS BASE: LLENADO DE LA PRIMERA FILA Y COLUMNA
-    for (int y = 0; y <= len_s1; y++)
+    builtin_tree = bktree_new();
+    for (unsigned int i = 0; builtin_name(i) != NULL; i++)
     {
-        dp[y][0] = y;
+        bktree_insert(builtin_tree, builtin_name(i));
     }
-    for (int x = 0; x <= len_s2; x++)
+    dictionary_tree = bktree_new();
+    const char *word = dictionary_words;
+    for (unsigned int i = 0; i < DICTIONARY_COUNT; i++)
     {
-        dp[0][x] = x;
+        bktree_insert(dictionary_tree, word);
+        word += strlen(word) + 1;
     }
-    // PASO RECURSIVO: LLENADO DE LA MATRIZ
-    for (int y = 1; y <= len_s1; y++)
+}
+
+static void dir_tree_free(gpointer data)
+{
+    struct dir_tree *tree = data;
+    if (tree->listing != NULL)
     {
-        for (int x = 1; x <= len_s2; x++)
+        dircache_release(tree->listing);
+    }
+    g_array_free(tree->nodes, TRUE);
+    free(tree);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de armar el árbol de un directorio de $PATH (corre en el hilo de fondo)
+       -- el árbol se arma sin tomar el lock; solo el reemplazo del anterior lo necesita --
+------------------------------------------------------------------------------------------------
+*/
+static void index_directory(const char *path, dir_listing listing)
+{
+    struct dir_tree *tree = malloc(sizeof(struct dir_tree));
+    assert(tree != NULL);
+    tree->listing = listing;
+    tree->nodes = bktree_new();
+    for (unsigned int i = 0; listing != NULL && i < dir_listing_length(listing); i++)
+    {
+        bktree_insert(tree->nodes, dir_listing_name(listing, i));
+    }
+    pthread_mutex_lock(&trees_lock);
+    tree->serial = ++trees_serial;
+    g_hash_table_replace(dir_trees, g_strdup(path), tree);
+    pthread_cond_broadcast(&trees_ready);
+    pthread_mutex_unlock(&trees_lock);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de pedir que se rearmen los árboles de $PATH que quedaron viejos
+  -- un árbol sirve mientras dircache devuelva el mismo listado con el que se armó;
+     devuelve los directorios pedidos y en `serial' el número de armado de ese momento --
+------------------------------------------------------------------------------------------------
+*/
+static GPtrArray *refresh_dir_trees(char **dirs, unsigned long *serial)
+{
+    GPtrArray *requested = g_ptr_array_new();
+    pthread_mutex_lock(&trees_lock);
+    if (dir_trees == NULL)
+    {
+        dir_trees = g_hash_table_new_full(g_str_hash, g_str_equal, free, dir_tree_free);
+    }
+    *serial = trees_serial;
+    pthread_mutex_unlock(&trees_lock);
+    for (unsigned int i = 0; dirs[i] != NULL; i++)
+    {
+        dir_listing listing = dircache_get(dirs[i], true, false);
+        pthread_mutex_lock(&trees_lock);
+        struct dir_tree *tree = g_hash_table_lookup(dir_trees, dirs[i]);
+        bool fresh = tree != NULL && tree->listing == listing &&
+                     (listing != NULL || access(dirs[i], F_OK) != 0);
+        pthread_mutex_unlock(&trees_lock);
+        if (listing != NULL)
+        {
+            dircache_release(listing);
+        }
+        if (!fresh)
         {
-            /* Si los caracteres coinciden, no hay penalización */
-            if (s1[y - 1] == s2[x - 1])
-            {
-                dp[y][x] = dp[y - 1][x - 1];
-            }
-            /* Si no coinciden, aplicar penalización y tomar el mínimo entre las tres operaciones posibles */
-            else
-            {
-                dp[y][x] = 1 + fmin(fmin(dp[y - 1][x],  // Eliminación
-                                         dp[y][x - 1]), // Inserción
-                                    dp[y - 1][x - 1]);  // Sustitución
-            }
+            completion_index_path(dirs[i], index_directory);
+            g_ptr_array_add(requested, dirs[i]);
         }
     }
-    /* --- El resultado final es el valor de la esquina inferior derecha de la matriz --- */
-    return dp[len_s1][len_s2];
+    return requested;
 }
 
 /*
 ------------------------------------------------------------------------------------------------
-*              Función encargada de sugerir un comando similar al ingresado
-  -- toma simplemente un string como parámetro y no devuelve nada, solo imprime en consola --
+  *    Función encargada de esperar, como mucho INDEX_TIMEOUT_MS, los árboles pedidos
+                -- se llama con el lock tomado y vuelve con el lock tomado --
 ------------------------------------------------------------------------------------------------
 */
-void suggest_command(const char *command)
+static void wait_dir_trees(GPtrArray *requested, unsigned long serial)
 {
-    /* ------------------------------------------ */
-    /* --- CARGA DE COMANDOS DESDE UN ARCHIVO --- */
-    /* ------------------------------------------ */
-    const char *filename = "commands.in"; // Nombre del archivo
-    FILE *file = fopen(filename, "r");    // Abrir el archivo
-    if (file == NULL)
-    {
-        perror("Could not open the file");
-        exit(EXIT_FAILURE);
-    }
-    // Inicializar el array dinámico para los comandos
-    int capacity = INITIAL_CAPACITY;
-    char **valid_commands = malloc(capacity * sizeof(char *));
-    int commands_count = 0;
-    char buffer[MAX_COMMAND_LENGTH]; // Buffer para almacenar cada comando leído
-    // Leer comandos separados por espacios
-    while (fscanf(file, "%s", buffer) != EOF)
-    {
-        // Redimensionar para evitar desbordamiento
-        if (commands_count >= capacity)
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += INDEX_TIMEOUT_MS * 1000000L;
+    deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+    deadline.tv_nsec %= 1000000000L;
+    unsigned int done = 0;
+    while (done < requested->len)
+    {
+        struct dir_tree *tree = g_hash_table_lookup(dir_trees, g_ptr_array_index(requested, done));
+        if (tree != NULL && tree->serial > serial)
+        {
+            done++;
+        }
+        else if (pthread_cond_timedwait(&trees_ready, &trees_lock, &deadline) == ETIMEDOUT)
         {
-            capacity *= 2;
-            valid_commands = realloc(valid_commands, capacity * sizeof(char *));
+            return; // se usan los árboles viejos, o ninguno, para lo que falte
         }
-        // Copiar el comando leído al array
-        valid_commands[commands_count] = strdup(buffer);
-        commands_count++;
-    }
-    fclose(file);
-    /* ------------------------------------------ */
-    /* ---- BÚSQUEDA DEL COMANDO MÁS CERCANO ---- */
-    /* ------------------------------------------ */
-    int min_distance = INT_MAX;
-    char *suggestion = NULL;
-    for (int i = 0; i < commands_count; i++)
-    {
-        int dist = distance_of_edition(command, valid_commands[i]);
-        if (dist < min_distance)
+    }
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de quedarse con la palabra de `nodes' si mejora la mejor hasta ahora
+         -- a igual distancia se queda la anterior: las fuentes se recorren por prioridad --
+------------------------------------------------------------------------------------------------
+*/
+static void nearest_in(GArray *nodes, const char *command, const char **best, unsigned int *best_distance)
+{
+    unsigned int distance;
+    if (*best_distance == 0)
+    {
+        return;
+    }
+    const char *word = bktree_nearest(nodes, command, *best_distance - 1, &distance);
+    if (word != NULL && distance < *best_distance)
+    {
+        *best = word;
+        *best_distance = distance;
+    }
+}
+
+void suggest_prefetch(void)
+{
+    char **dirs = dircache_path();
+    unsigned long serial;
+    g_ptr_array_free(refresh_dir_trees(dirs, &serial), TRUE);
+    g_strfreev(dirs);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+*              Función encargada de sugerir un comando similar al ingresado
+  -- toma simplemente un string como parámetro y no devuelve nada, solo imprime en consola.
+     Se busca en los comandos internos, en cada directorio de $PATH en orden y por último
+                                en el diccionario de commands.in --
+------------------------------------------------------------------------------------------------
+*/
+void suggest_command(const char *command)
+{
+    if (builtin_tree == NULL)
+    {
+        dictionary_load();
+    }
+    char **dirs = dircache_path();
+    unsigned long serial;
+    GPtrArray *requested = refresh_dir_trees(dirs, &serial);
+
+    const char *suggestion = NULL;
+    unsigned int distance = MAX_DISTANCE + 1;
+    nearest_in(builtin_tree, command, &suggestion, &distance);
+    pthread_mutex_lock(&trees_lock);
+    wait_dir_trees(requested, serial);
+    for (unsigned int i = 0; dirs[i] != NULL; i++)
+    {
+        struct dir_tree *tree = g_hash_table_lookup(dir_trees, dirs[i]);
+        if (tree != NULL)
         {
-            min_distance = dist;
-            suggestion = valid_commands[i];
+            nearest_in(tree->nodes, command, &suggestion, &distance);
         }
     }
+    nearest_in(dictionary_tree, command, &suggestion, &distance);
+    // la palabra se imprime antes de soltar el lock: su árbol puede reemplazarse
     // Decidir si sugerir el comando encontrado
-    if (min_distance <= 2)
+    if (suggestion != NULL && distance <= CLOSE_DISTANCE)
     {
         printf("Did you mean %s?\n", suggestion);
     }
-    else
+    else if (suggestion != NULL)
     {
         printf("Suggested command: %s\n", suggestion);
     }
-    // Limpiar la memoria utilizada por los comandos
-    for (int i = 0; i < commands_count; i++)
-    {
-        free(valid_commands[i]);
-    }
-    free(valid_commands);
+    pthread_mutex_unlock(&trees_lock);
+    g_ptr_array_free(requested, TRUE);
+    g_strfreev(dirs);
 }
@@ -1,7 +1,6 @@
 /*
 ------------------------------------------------------------------------------------------------
   *    Módulo encargado de detectar que comando se quiso ejecutar y sugerir uno similar
-  -- se agrega un parámetro de compilación en el makefile para poder usar la libreria math --
      -- la implementación se encuentra completamente encapsulada en el archivo syntax.c --
 ------------------------------------------------------------------------------------------------
 */
@@ -9,6 +8,40 @@
 #ifndef SYNTAX_H
 #define SYNTAX_H
 
+#define DISTANCE_LANES 4     // Distancias que distance_of_edition_batch() calcula a la vez
+#define INDEX_TIMEOUT_MS 100 // Espera máxima por los directorios de $PATH sin indexar
+
 void suggest_command(const char* command);
+/*
+ * Imprime el comando más parecido a `command' entre los comandos internos,
+ * los ejecutables de $PATH y las palabras de commands.in (que se compilan
+ * dentro del ejecutable). Los
+ * directorios de $PATH que no estén indexados se esperan como mucho
+ * INDEX_TIMEOUT_MS; los que no lleguen se buscan en su índice anterior.
+ * Requires: command != NULL
+ */
+
+void suggest_prefetch(void);
+/*
+ * Pide al hilo de fondo que indexe los ejecutables de $PATH para las
+ * sugerencias, y que vuelva a indexar los directorios que cambiaron desde la
+ * última vez. No bloquea.
+ */
+
+unsigned int distance_of_edition(const char *s1, const char *s2);
+/*
+ * Distancia de edición (Levenshtein) entre dos cadenas: cantidad mínima de
+ * inserciones, borrados y sustituciones para pasar de una a la otra.
+ * Requires: s1 != NULL && s2 != NULL
+ */
+
+void distance_of_edition_batch(const char *word, const char *const *candidates, unsigned int count,
+                               unsigned int *distances);
+/*
+ * Calcula distances[i] = distance_of_edition(word, candidates[i]) para
+ * i < count. Si `word' tiene hasta 64 caracteres, los candidatos se procesan
+ * de a DISTANCE_LANES en paralelo.
+ * Requires: word != NULL && candidates != NULL && distances != NULL
+ */
 
 #endif
@@ -14,6 +14,18 @@
 #include "test_execute.h"
 #endif /* TEST_EXECUTE */
 
+#ifdef TEST_SCRIPT
+#include "test_script.h"
+#endif /* TEST_SCRIPT */
+
+#ifdef TEST_HISTORY
+#include "test_history.h"
+#endif /* TEST_HISTORY */
+
+#ifdef TEST_SUGGEST
+#include "test_suggest.h"
+#endif /* TEST_SUGGEST */
+
 int main (void)
 {
     int number_failed;
@@ -32,6 +44,18 @@ int main (void)
     srunner_add_suite(sr, execute_suite());
 #endif /* TEST_EXECUTE */
 
+#ifdef TEST_SCRIPT
+    srunner_add_suite(sr, script_suite());
+#endif /* TEST_SCRIPT */
+
+#ifdef TEST_HISTORY
+    srunner_add_suite(sr, history_suite());
+#endif /* TEST_HISTORY */
+
+#ifdef TEST_SUGGEST
+    srunner_add_suite(sr, suggest_suite());
+#endif /* TEST_SUGGEST */
+
     srunner_set_log(sr, "test.log");
     srunner_run_all(sr, CK_NORMAL);
     number_failed = srunner_ntests_failed(sr);
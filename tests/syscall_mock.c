@@ -13,7 +13,7 @@
 int mock_counter_open, mock_counter_close, mock_counter_dup,
     mock_counter_dup2, mock_counter_pipe, mock_counter_fork,
     mock_counter_execvp, mock_counter_exit, mock_counter_wait,
-    mock_counter_waitpid, mock_counter_chdir;
+    mock_counter_waitpid, mock_counter_chdir, mock_counter_access;
 
 /* Componentes para hacer mocks del sistema de file descriptor 
  * Esto es un poco más que un mock simple, sin conectarse a archivos externos
@@ -68,11 +68,12 @@ void mock_reset_all (void) {
     mock_counter_open = mock_counter_close = mock_counter_dup =
     mock_counter_dup2 = mock_counter_pipe = mock_counter_fork =
     mock_counter_execvp = mock_counter_exit = mock_counter_wait =
-    mock_counter_waitpid = mock_counter_chdir = 0;
+    mock_counter_waitpid = mock_counter_chdir = mock_counter_access = 0;
     if (mock_chdir_last!=NULL) {
         free (mock_chdir_last);
         mock_chdir_last = NULL;
     }
+    mock_access_setup (NULL);
     mock_finished_processes_count = 0;
     /* Inicializar tabla de descriptores con un estado sensato:
      *  0 es el dispositivo "ttyin"
@@ -385,3 +386,21 @@ int mock_chdir (const char *path) {
     return -1;
 }
 
+
+static char *mock_access_missing = NULL;
+void mock_access_setup (const char *missing) {
+    free (mock_access_missing);
+    mock_access_missing = (missing != NULL) ? strdup (missing) : NULL;
+}
+
+int mock_access (const char *pathname, int mode) {
+    assert (pathname != NULL);
+    mock_counter_access++;
+    const char *name = strrchr (pathname, '/');
+    name = (name != NULL) ? name + 1 : pathname;
+    if (mock_access_missing != NULL && strcmp (name, mock_access_missing) == 0) {
+        errno = ENOENT;
+        return -1;
+    }
+    return 0;
+}
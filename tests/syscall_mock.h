@@ -138,6 +138,14 @@ extern int mock_finished_processes_count;
 int mock_chdir (const char *path);
 extern char* mock_chdir_last;
 
+/*
+ * Mock para access. Siempre tiene éxito, salvo para las rutas cuyo último
+ * componente sea el nombre programado con mock_access_setup, donde falla con
+ * errno=ENOENT. Así los tests pueden usar comandos que no existen de verdad.
+ */
+int mock_access (const char *pathname, int mode);
+void mock_access_setup (const char *missing);
+
 /*
  * Para cada syscall hay un contador mock_counter_xxx indicando cuantas veces
  * fue invocada. Este contador se resetea a 0 con mock_reset_all()
@@ -145,7 +153,7 @@ extern char* mock_chdir_last;
 extern int mock_counter_open, mock_counter_close, mock_counter_dup,
 	mock_counter_dup2, mock_counter_pipe, mock_counter_fork,
 	mock_counter_execvp, mock_counter_exit, mock_counter_wait,
-	mock_counter_waitpid, mock_counter_chdir;
+	mock_counter_waitpid, mock_counter_chdir, mock_counter_access;
 
 #ifdef REPLACE_SYSCALLS
 
@@ -160,6 +168,7 @@ extern int mock_counter_open, mock_counter_close, mock_counter_dup,
 #define wait mock_wait
 #define waitpid mock_waitpid
 #define chdir mock_chdir
+#define access mock_access
 
 #endif
 
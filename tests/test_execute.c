@@ -1,7 +1,12 @@
 #include <check.h>
+#include <fcntl.h>
 #include <signal.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
 #include "test_execute.h"
 
 #include "syscall_mock.h"
@@ -91,6 +96,115 @@ START_TEST (test_builtin_chdir)
 }
 END_TEST
 
+/* Ejecuta un comando interno con las palabras de `line' (separadas por
+ * espacios) y devuelve su estado de salida
+ */
+static int run_builtin (const char *line)
+{
+    pipeline apipe = pipeline_new ();
+    scommand cmd = scommand_new ();
+    char **words = g_strsplit (line, " ", -1);
+    for (unsigned int i = 0; words[i] != NULL; i++) {
+        scommand_push_back (cmd, strdup (words[i]));
+    }
+    g_strfreev (words);
+    pipeline_push_back (apipe, cmd);
+    int status = execute_pipeline (apipe);
+    pipeline_destroy (apipe);
+    return status;
+}
+
+/* Escribe `content' en el archivo `path' */
+static void write_file (const char *path, const char *content)
+{
+    FILE *file = fopen (path, "w");
+    ck_assert (file != NULL);
+    fputs (content, file);
+    fclose (file);
+}
+
+START_TEST (test_script_redirection)
+{
+    /* De punta a punta, con el shell compilado: "mapfile x < archivo" carga
+     * las líneas del archivo y "echo ... > archivo" escribe lo que cargó
+     */
+    char dir[] = "/tmp/test_redirection_XXXXXX";
+    ck_assert (mkdtemp (dir) != NULL);
+    char *input = g_strdup_printf ("%s/entrada", dir);
+    char *output = g_strdup_printf ("%s/salida", dir);
+    char *path = g_strdup_printf ("%s/script", dir);
+    char *script = g_strdup_printf ("mapfile -t x < %s\necho ${#x[@]} ${x[2]} > %s\n", input, output);
+    write_file (input, "uno\ndos\ntres\n");
+    write_file (path, script);
+    char *command = g_strdup_printf ("../mybash %s", path);
+    ck_assert_int_eq (system (command), 0);
+
+    char line[64] = "";
+    FILE *result = fopen (output, "r");
+    ck_assert (result != NULL);
+    ck_assert (fgets (line, sizeof (line), result) != NULL);
+    fclose (result);
+    ck_assert_str_eq (line, "3 tres\n");
+
+    unlink (input);
+    unlink (output);
+    unlink (path);
+    rmdir (dir);
+    g_free (command);
+    g_free (script);
+    g_free (path);
+    g_free (output);
+    g_free (input);
+}
+END_TEST
+
+START_TEST (test_builtin_status_kill)
+{
+    /* Una señal que no se pudo mandar es un error: el pid no existe, la
+     * señal no es válida o pkill no encontró a nadie
+     */
+    ck_assert_int_eq (run_builtin ("kill 999999999"), EXIT_FAILURE);
+    ck_assert_int_eq (run_builtin ("kill -s NOSUCH 1"), EXIT_FAILURE);
+    ck_assert_int_eq (run_builtin ("kill %99"), EXIT_FAILURE);
+    ck_assert_int_eq (run_builtin ("kill"), EXIT_FAILURE);
+    ck_assert_int_eq (run_builtin ("kill -l"), EXIT_SUCCESS);
+    /* sin permiso para señalar a init (EPERM), salvo como root */
+    ck_assert_int_eq (run_builtin ("kill -0 1"), (getuid () == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+    ck_assert_int_eq (run_builtin ("pkill zzzznomatchzzzz"), 1);
+    ck_assert_int_eq (run_builtin ("pkill ("), 2);
+    ck_assert_int_eq (run_builtin ("pkill"), 2);
+}
+END_TEST
+
+START_TEST (test_builtin_status_output)
+{
+    /* La salida va a /dev/null; cuando se cierra, escribir falla */
+    fflush (stdout);
+    int saved = dup (STDOUT_FILENO);
+    int null = open ("/dev/null", O_WRONLY);
+    ck_assert (saved >= 0 && null >= 0);
+    dup2 (null, STDOUT_FILENO);
+    close (null);
+    ck_assert_int_eq (run_builtin ("echo hola"), EXIT_SUCCESS);
+    ck_assert_int_eq (run_builtin ("printf %d 42"), EXIT_SUCCESS);
+    ck_assert_int_eq (run_builtin ("printf"), EXIT_FAILURE);
+    ck_assert_int_eq (run_builtin ("printf %d abc"), EXIT_FAILURE);
+    ck_assert_int_eq (run_builtin ("ps --nosuch"), EXIT_FAILURE);
+    ck_assert_int_eq (run_builtin ("ps -o nosuch"), EXIT_FAILURE);
+    ck_assert_int_eq (run_builtin ("ps -o pid"), EXIT_SUCCESS);
+    ck_assert_int_eq (run_builtin ("mapfile -x"), EXIT_FAILURE);
+    ck_assert_int_eq (run_builtin ("mapfile a b"), EXIT_FAILURE);
+    ck_assert_int_eq (run_builtin ("mapfile -n abc"), EXIT_FAILURE);
+    ck_assert_int_eq (run_builtin ("mapfile -u 99"), EXIT_FAILURE);
+    ck_assert_int_eq (run_builtin ("mapfile -u 99 1x"), EXIT_FAILURE);
+    close (STDOUT_FILENO);
+    ck_assert_int_eq (run_builtin ("echo hola"), EXIT_FAILURE);
+    ck_assert_int_eq (run_builtin ("printf hola"), EXIT_FAILURE);
+    dup2 (saved, STDOUT_FILENO);
+    close (saved);
+}
+END_TEST
+
 START_TEST (test_external_1_simple_parent)
 {
     /* Ejecuta un comando simple, sin argumentos. Verifica que el padre haga
@@ -295,6 +409,29 @@ START_TEST (test_pipe2_parent)
 }
 END_TEST
 
+START_TEST (test_pipe2_not_found)
+{
+    /* Ejecuta un pipe de 2 elementos cuyo segundo comando no existe.
+     * El padre debe darse cuenta antes de crear procesos o pipes.
+     */
+    pid_t pids[] = {101, 102, -1};
+    setup_test_pipe ();
+    mock_fork_setup (pids);
+    mock_access_setup ("command2");
+
+    execute_pipeline (test_pipe);
+
+    /* Buscó los comandos */
+    ck_assert_msg (mock_counter_access > 0, NULL);
+    /* Pero no creó nada */
+    ck_assert_msg (mock_counter_pipe==0, NULL);
+    ck_assert_msg (mock_counter_fork==0, NULL);
+    ck_assert_msg (mock_counter_execvp==0, NULL);
+    ck_assert_msg (mock_counter_exit==0, NULL);
+    ck_assert_msg (mock_counter_wait+mock_counter_waitpid == 0, NULL);
+}
+END_TEST
+
 START_TEST (test_pipe2_child1) {
     /* Ejecuta un pipe de 2 elementos. Verifica que el primer hijo corra el
      * primer comando y esté bien conectado.
@@ -574,11 +711,15 @@ Suite *execute_suite (void)
     tcase_add_test (tc_functionality, test_null);
     tcase_add_test (tc_functionality, test_builtin_exit);
     tcase_add_test (tc_functionality, test_builtin_chdir);
+    tcase_add_test (tc_functionality, test_script_redirection);
+    tcase_add_test (tc_functionality, test_builtin_status_kill);
+    tcase_add_test (tc_functionality, test_builtin_status_output);
     tcase_add_test (tc_functionality, test_external_1_simple_parent);
     tcase_add_test (tc_functionality, test_external_1_simple_child);
     tcase_add_test (tc_functionality, test_external_1_simple_background);
     tcase_add_test (tc_functionality, test_external_arguments);
     tcase_add_test (tc_functionality, test_pipe2_parent);
+    tcase_add_test (tc_functionality, test_pipe2_not_found);
     tcase_add_test (tc_functionality, test_pipe2_child1);
     tcase_add_test (tc_functionality, test_pipe2_child2);
     tcase_add_test (tc_functionality, test_redir_inout_parent);
@@ -0,0 +1,146 @@
+#include <check.h>
+#include "test_history.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../history.h"
+#include "test_random.h"
+
+/* Cada búsqueda del índice de trigramas se compara con un recorrido de todo
+ * el historial con strstr(), desde la entrada más reciente hacia atrás.
+ */
+
+static const char *const entries[] = {
+    "ls -la",
+    "git commit -m 'fix'",
+    "gigigit status",
+    "aaaa",
+    "echo $HOME\n",
+    "   ",
+    "",
+    "\t",
+    "ñandú y más",
+    "ls",
+    "git commit -m 'fix' --amend",
+    "cat /proc/cpuinfo | grep model",
+    "make test && make clean",
+    "aaaa",
+};
+
+static const char *const patterns[] = {
+    "", "l", "ls", "ls ", "-la", "git", "gig", "igi", "gigit", "commit -m",
+    "'fix'", "aaa", "aaaa", "aaaaa", "zzz", "ñan", "ndú", "$HOME", "\t", "HOME\n",
+    "git commit -m 'fix'", "t c", "make", "ke c", "model", "| grep", "s", "status",
+};
+
+static void teardown(void)
+{
+    history_destroy();
+}
+
+static bool brute_search(const char *pattern, unsigned int before, unsigned int *index)
+{
+    for (unsigned int id = (before < history_length()) ? before : history_length(); id-- > 0;)
+    {
+        if (strstr(history_get(id), pattern) != NULL)
+        {
+            *index = id;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Compara history_search_before con brute_search para `pattern' y cada
+ * límite posible (y uno más allá del final)
+ */
+static void check_pattern(const char *pattern)
+{
+    for (unsigned int before = 0; before <= history_length() + 1; before++)
+    {
+        unsigned int expected = 0, found = 0;
+        bool hit = brute_search(pattern, before, &expected);
+        ck_assert_msg(history_search_before(pattern, before, &found) == hit,
+                      "\"%s\" antes de %u: %s", pattern, before, hit ? "no encontró" : "encontró de más");
+        ck_assert_msg(!hit || found == expected, "\"%s\" antes de %u: %u en lugar de %u", pattern, before,
+                      found, expected);
+    }
+    unsigned int expected = 0, found = 0;
+    bool hit = brute_search(pattern, history_length(), &expected);
+    ck_assert(history_search(pattern, &found) == hit);
+    ck_assert(!hit || found == expected);
+}
+
+START_TEST(test_history_empty)
+{
+    unsigned int index = 0;
+    ck_assert_int_eq(history_length(), 0);
+    ck_assert(!history_search("", &index));
+    ck_assert(!history_search("abc", &index));
+}
+END_TEST
+
+START_TEST(test_history_add)
+{
+    /* las líneas en blanco no se guardan y el '\n' final se saca */
+    for (unsigned int i = 0; i < sizeof(entries) / sizeof(entries[0]); i++)
+    {
+        history_add(entries[i]);
+    }
+    ck_assert_int_eq(history_length(), sizeof(entries) / sizeof(entries[0]) - 3);
+    ck_assert_str_eq(history_get(4), "echo $HOME");
+    ck_assert_str_eq(history_get(5), "ñandú y más");
+}
+END_TEST
+
+START_TEST(test_history_search_table)
+{
+    for (unsigned int i = 0; i < sizeof(entries) / sizeof(entries[0]); i++)
+    {
+        history_add(entries[i]);
+    }
+    for (unsigned int i = 0; i < sizeof(patterns) / sizeof(patterns[0]); i++)
+    {
+        check_pattern(patterns[i]);
+    }
+}
+END_TEST
+
+START_TEST(test_history_search_random)
+{
+    /* con un alfabeto chico los trigramas se repiten mucho: casi todos los
+     * candidatos de las listas tienen que descartarse con strstr()
+     */
+    unsigned int seed = 12345;
+    char text[16];
+    for (unsigned int i = 0; i < 400; i++)
+    {
+        random_text(&seed, "abc ", 15, text);
+        history_add(text);
+    }
+    for (unsigned int i = 0; i < 200; i++)
+    {
+        random_text(&seed, "abc ", 7, text);
+        check_pattern(text);
+    }
+}
+END_TEST
+
+/* Armado de la test suite */
+
+Suite *history_suite(void)
+{
+    Suite *s = suite_create("history");
+    TCase *tc_search = tcase_create("Search");
+
+    tcase_add_checked_fixture(tc_search, NULL, teardown);
+    tcase_add_test(tc_search, test_history_empty);
+    tcase_add_test(tc_search, test_history_add);
+    tcase_add_test(tc_search, test_history_search_table);
+    tcase_add_test(tc_search, test_history_search_random);
+    suite_add_tcase(s, tc_search);
+
+    return s;
+}
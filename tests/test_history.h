@@ -0,0 +1,8 @@
+#ifndef TEST_HISTORY_H
+#define TEST_HISTORY_H
+
+#include <check.h>
+
+Suite *history_suite (void);
+
+#endif
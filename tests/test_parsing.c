@@ -7,9 +7,13 @@
 #include <signal.h>
 #include <assert.h>
 #include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
 
 #include "../parser.h"
 #include "../parsing.h"
+#include "../vars.h"
 
 /* Algunas variables/funciones auxiliares para ser usadas por el resto de los
  * tests
@@ -410,6 +414,336 @@ START_TEST(test_many_args)
 }
 END_TEST
 
+START_TEST(test_variables)
+{
+    scommand s = NULL;
+    /* $NOMBRE y ${NOMBRE} se reemplazan por el valor, pegados a lo que haya
+     * alrededor; un '$' que no empieza un nombre queda como está
+     */
+    ck_assert_msg(vars_set("TEST_VAR", "valor"), NULL);
+    init_parser("comando $TEST_VAR x${TEST_VAR}y a$ $1\n");
+    output = parse_pipeline(parser);
+    ck_assert_msg(pipeline_length(output) == 1, NULL);
+    s = pipeline_front(output);
+    ck_assert_msg(scommand_length(s) == 5, NULL);
+    check_argument(s, "comando");
+    check_argument(s, "valor");
+    check_argument(s, "xvalory");
+    check_argument(s, "a$");
+    check_argument(s, "$1");
+    vars_unset("TEST_VAR");
+}
+END_TEST
+
+START_TEST(test_variables_unset)
+{
+    scommand s = NULL;
+    /* Una palabra que queda vacía no es un argumento (como en bash) */
+    vars_unset("TEST_UNSET");
+    init_parser("comando $TEST_UNSET a${TEST_UNSET}b\n");
+    output = parse_pipeline(parser);
+    ck_assert_msg(pipeline_length(output) == 1, NULL);
+    s = pipeline_front(output);
+    ck_assert_msg(scommand_length(s) == 2, NULL);
+    check_argument(s, "comando");
+    check_argument(s, "ab");
+}
+END_TEST
+
+START_TEST(test_variables_quoted)
+{
+    scommand s = NULL;
+    /* entre comillas simples no se expande nada; las comillas se sacan
+     * donde estén, y una palabra con comillas no desaparece aunque quede
+     * vacía
+     */
+    ck_assert_msg(vars_set("TEST_QUOTED", "v"), NULL);
+    vars_unset("TEST_QUOTED_UNSET");
+    init_parser("comando '$TEST_QUOTED' a\"$TEST_QUOTED\"b \"$TEST_QUOTED\"'$TEST_QUOTED' a'b'c \"a\\\"b\" "
+                "\\$TEST_QUOTED \"$TEST_QUOTED_UNSET\" '' $TEST_QUOTED_UNSET\n");
+    output = parse_pipeline(parser);
+    ck_assert_msg(pipeline_length(output) == 1, NULL);
+    s = pipeline_front(output);
+    ck_assert_msg(scommand_length(s) == 9, NULL);
+    check_argument(s, "comando");
+    check_argument(s, "$TEST_QUOTED");
+    check_argument(s, "avb");
+    check_argument(s, "v$TEST_QUOTED");
+    check_argument(s, "abc");
+    check_argument(s, "a\"b");
+    check_argument(s, "\\$TEST_QUOTED");
+    check_argument(s, "");
+    check_argument(s, "");
+    vars_unset("TEST_QUOTED");
+}
+END_TEST
+
+START_TEST(test_array_variables)
+{
+    scommand s = NULL;
+    /* ${a[@]} da una palabra por elemento, pegando lo de antes al primero y
+     * lo de después al último; ${#a[@]} es la cantidad de elementos
+     */
+    ck_assert_msg(vars_set_element("TEST_ARRAY", "0", "uno"), NULL);
+    ck_assert_msg(vars_set_element("TEST_ARRAY", "2", "tres"), NULL);
+    init_parser("comando x${TEST_ARRAY[@]}y ${#TEST_ARRAY[@]} ${TEST_ARRAY[-1]} ${TEST_ARRAY[1]}\n");
+    output = parse_pipeline(parser);
+    ck_assert_msg(pipeline_length(output) == 1, NULL);
+    s = pipeline_front(output);
+    ck_assert_msg(scommand_length(s) == 5, NULL);
+    check_argument(s, "comando");
+    check_argument(s, "xuno");
+    check_argument(s, "tresy");
+    check_argument(s, "2");
+    check_argument(s, "tres");
+    vars_unset("TEST_ARRAY");
+}
+END_TEST
+
+START_TEST(test_array_huge_index)
+{
+    scommand s = NULL;
+    /* un índice nuevo muy grande no se acepta (reservaría lugar para todos
+     * los anteriores), ni aunque desborde el tamaño de la reserva; leerlo no
+     * da nada
+     */
+    ck_assert_msg(!vars_set_element("TEST_HUGE", "10000000000", "x"), NULL);
+    ck_assert_msg(!vars_set_element("TEST_HUGE", "1152921504606846976", "x"), NULL);
+    ck_assert_msg(!vars_set_element("TEST_HUGE", "99999999999999999999", "x"), NULL);
+    ck_assert_msg(!vars_set_element("TEST_HUGE", "16777216", "x"), NULL);
+    ck_assert_msg(vars_set_element("TEST_HUGE", "1000", "mil"), NULL);
+    init_parser("comando ${TEST_HUGE[10000000000]}x ${#TEST_HUGE[@]} ${TEST_HUGE[-1]}\n");
+    output = parse_pipeline(parser);
+    ck_assert_msg(pipeline_length(output) == 1, NULL);
+    s = pipeline_front(output);
+    ck_assert_msg(scommand_length(s) == 4, NULL);
+    check_argument(s, "comando");
+    check_argument(s, "x");
+    check_argument(s, "1");
+    check_argument(s, "mil");
+    vars_unset("TEST_HUGE");
+}
+END_TEST
+
+START_TEST(test_braces)
+{
+    scommand s = NULL;
+    /* Las llaves se expanden antes que las variables: listas (anidadas y
+     * combinadas), rangos con paso y ceros; {a} y ${...} quedan como están
+     */
+    ck_assert_msg(vars_set("TEST_BRACE", "v"), NULL);
+    init_parser("c a{b,{c,d}}e {1..3}{x,y} {08..12..2} {c..a} {a} ${TEST_BRACE}{$TEST_BRACE,w}\n");
+    output = parse_pipeline(parser);
+    ck_assert_msg(pipeline_length(output) == 1, NULL);
+    s = pipeline_front(output);
+    char *text = scommand_to_string(s);
+    ck_assert_msg(strcmp(text, "c abe ace ade 1x 1y 2x 2y 3x 3y 08 10 12 c b a {a} vv vw") == 0, NULL);
+    free(text);
+    vars_unset("TEST_BRACE");
+}
+END_TEST
+
+START_TEST(test_word_stream)
+{
+    /* los argumentos de batch no se expanden con el pipeline: word_stream
+     * los da de a uno, con las llaves, las variables y las comillas
+     */
+    ck_assert_msg(vars_set("TEST_STREAM", "v"), NULL);
+    init_parser("batch echo x{1..3} $TEST_STREAM '$TEST_STREAM' {a,b}{1,2}\n");
+    cmdlist list = parse_list(parser);
+    ck_assert_msg(list != NULL && cmdlist_length(list) == 1, NULL);
+    int status = EXIT_FAILURE;
+    ck_assert_msg(expand_pipeline(cmdlist_nth(list, 0), &status) && status == EXIT_SUCCESS, NULL);
+    scommand s = pipeline_front(cmdlist_nth(list, 0));
+    char *text = scommand_to_string(s);
+    ck_assert_msg(strcmp(text, "batch echo x{1..3} $TEST_STREAM '$TEST_STREAM' {a,b}{1,2}") == 0, NULL);
+    free(text);
+    scommand_pop_front(s);
+    const char *expected[] = {"echo", "x1", "x2", "x3", "v", "$TEST_STREAM", "a1", "a2", "b1", "b2"};
+    word_stream words = word_stream_new(s);
+    for (unsigned int i = 0; i < G_N_ELEMENTS(expected); i++)
+    {
+        char *word = word_stream_next(words);
+        ck_assert_msg(word != NULL && strcmp(word, expected[i]) == 0, NULL);
+        free(word);
+    }
+    ck_assert_msg(word_stream_next(words) == NULL, NULL);
+    ck_assert_msg(scommand_is_empty(s), NULL);
+    word_stream_destroy(words);
+
+    /* a la mitad de unas llaves enormes: destruirlo no expande el resto */
+    scommand_push_back(s, strdup("f{1..100000000}"));
+    words = word_stream_new(s);
+    char *word = word_stream_next(words);
+    ck_assert_msg(word != NULL && strcmp(word, "f1") == 0, NULL);
+    free(word);
+    word_stream_destroy(words);
+    cmdlist_destroy(list);
+    vars_unset("TEST_STREAM");
+}
+END_TEST
+
+START_TEST(test_pathnames)
+{
+    scommand s = NULL;
+    /* Los comodines se comparan con los nombres de un directorio temporal:
+     * salen ordenados, los ocultos solo con un '.' explícito, entre comillas
+     * no cuentan y un patrón sin coincidencias queda como está; ** recorre
+     * todo el árbol
+     */
+    char dir[] = "/tmp/test_pathnames_XXXXXX";
+    ck_assert_msg(mkdtemp(dir) != NULL, NULL);
+    const char *files[] = {"b.c", "a.c", "c.h", ".h.c", "d/e.c"};
+    char *path = g_strdup_printf("%s/d", dir);
+    ck_assert_msg(mkdir(path, 0700) == 0, NULL);
+    g_free(path);
+    for (unsigned int i = 0; i < G_N_ELEMENTS(files); i++)
+    {
+        path = g_strdup_printf("%s/%s", dir, files[i]);
+        close(open(path, O_CREAT | O_WRONLY, 0600));
+        g_free(path);
+    }
+    char *cwd = getcwd(NULL, 0);
+    ck_assert_msg(chdir(dir) == 0, NULL);
+    ck_assert_msg(vars_set("TEST_EXTENSION", "c"), NULL);
+    init_parser("ls *.c [!a].? .*.c */*.c **/*.c \\*.c *.x *.$TEST_EXTENSION '*'.$TEST_EXTENSION \"*\".c\n");
+    output = parse_pipeline(parser);
+    ck_assert_msg(chdir(cwd) == 0, NULL);
+    ck_assert_msg(pipeline_length(output) == 1, NULL);
+    s = pipeline_front(output);
+    char *text = scommand_to_string(s);
+    ck_assert_msg(strcmp(text, "ls a.c b.c b.c c.h .h.c d/e.c a.c b.c d/e.c \\*.c *.x a.c b.c *.c *.c") == 0, NULL);
+    free(text);
+    vars_unset("TEST_EXTENSION");
+    free(cwd);
+    for (unsigned int i = G_N_ELEMENTS(files); i > 0; i--)
+    {
+        path = g_strdup_printf("%s/%s", dir, files[i - 1]);
+        unlink(path);
+        g_free(path);
+    }
+    path = g_strdup_printf("%s/d", dir);
+    rmdir(path);
+    g_free(path);
+    rmdir(dir);
+}
+END_TEST
+
+START_TEST(test_command_list)
+{
+    /* a && b || c ; d & e: cinco pipelines, cada uno con cómo se une con el
+     * anterior; "d;e" se corta en el ';' y las variables quedan sin expandir
+     * hasta expand_pipeline
+     */
+    init_parser("a && b x | c || c;d $TEST_LIST & e\n");
+    cmdlist list = parse_list(parser);
+    ck_assert_msg(list != NULL && cmdlist_length(list) == 5, NULL);
+    ck_assert_msg(cmdlist_connector_nth(list, 0) == CMDLIST_ALWAYS, NULL);
+    ck_assert_msg(cmdlist_connector_nth(list, 1) == CMDLIST_AND, NULL);
+    ck_assert_msg(cmdlist_connector_nth(list, 2) == CMDLIST_OR, NULL);
+    ck_assert_msg(cmdlist_connector_nth(list, 3) == CMDLIST_ALWAYS, NULL);
+    ck_assert_msg(cmdlist_connector_nth(list, 4) == CMDLIST_ALWAYS, NULL);
+    ck_assert_msg(pipeline_length(cmdlist_nth(list, 1)) == 2, NULL);
+    ck_assert_msg(pipeline_get_wait(cmdlist_nth(list, 2)), NULL);
+    ck_assert_msg(!pipeline_get_wait(cmdlist_nth(list, 3)), NULL);
+    scommand s = pipeline_front(cmdlist_nth(list, 3));
+    char *text = scommand_to_string(s);
+    ck_assert_msg(strcmp(text, "d $TEST_LIST") == 0, NULL);
+    free(text);
+    vars_set("TEST_LIST", "valor");
+    int status = EXIT_FAILURE;
+    ck_assert_msg(expand_pipeline(cmdlist_nth(list, 3), &status) && status == EXIT_SUCCESS, NULL);
+    check_argument(s, "d");
+    check_argument(s, "valor");
+    vars_unset("TEST_LIST");
+    cmdlist_destroy(list);
+}
+END_TEST
+
+START_TEST(test_command_list_quoted_separator)
+{
+    /* un ';' entre comillas o después de una '\' no separa comandos */
+    init_parser("echo 'a;b' \"c;d\" e\\;f \"g\\\";\"h;i\n");
+    cmdlist list = parse_list(parser);
+    ck_assert_msg(list != NULL && cmdlist_length(list) == 2, NULL);
+    char *text = scommand_to_string(pipeline_front(cmdlist_nth(list, 0)));
+    ck_assert_msg(strcmp(text, "echo 'a;b' \"c;d\" e\\;f \"g\\\";\"h") == 0, NULL);
+    free(text);
+    text = scommand_to_string(pipeline_front(cmdlist_nth(list, 1)));
+    ck_assert_msg(strcmp(text, "i") == 0, NULL);
+    free(text);
+    cmdlist_destroy(list);
+}
+END_TEST
+
+START_TEST(test_redirection_per_command)
+{
+    /* cada comando simple tiene sus propias redirecciones: el resto del
+     * pipeline no necesita ninguna
+     */
+    init_parser("cat < entrada | wc -l > salida | sort\n");
+    cmdlist list = parse_list(parser);
+    ck_assert_msg(list != NULL && cmdlist_length(list) == 1, NULL);
+    pipeline pipe = cmdlist_nth(list, 0);
+    ck_assert_msg(pipeline_length(pipe) == 3, NULL);
+    scommand s = pipeline_nth(pipe, 0);
+    ck_assert_msg(strcmp(scommand_get_redir_in(s), "entrada") == 0, NULL);
+    ck_assert_msg(scommand_get_redir_out(s) == NULL, NULL);
+    s = pipeline_nth(pipe, 1);
+    ck_assert_msg(scommand_get_redir_in(s) == NULL, NULL);
+    ck_assert_msg(strcmp(scommand_get_redir_out(s), "salida") == 0, NULL);
+    s = pipeline_nth(pipe, 2);
+    ck_assert_msg(scommand_get_redir_in(s) == NULL && scommand_get_redir_out(s) == NULL, NULL);
+    cmdlist_destroy(list);
+}
+END_TEST
+
+START_TEST(test_command_list_invalid)
+{
+    /* un && sin nada después es un error */
+    init_parser("a &&\n");
+    ck_assert_msg(parse_list(parser) == NULL, NULL);
+}
+END_TEST
+
+START_TEST(test_redirection_missing)
+{
+    /* un '<' o '>' sin archivo invalida la línea entera, aunque otro comando
+     * del pipeline tenga su redirección
+     */
+    init_parser("echo a >\n");
+    ck_assert_msg(parse_list(parser) == NULL, NULL);
+    teardown();
+    init_parser("cat < entrada | wc <\n");
+    ck_assert_msg(parse_list(parser) == NULL, NULL);
+}
+END_TEST
+
+START_TEST(test_redirection_ambiguous)
+{
+    /* una redirección que se expande a varios archivos, o a ninguno, hace
+     * fallar al pipeline en lugar de quedar sin redirección
+     */
+    vars_declare("TEST_AMBIGUOUS", VAR_INDEXED);
+    vars_set_element("TEST_AMBIGUOUS", "0", "uno");
+    vars_set_element("TEST_AMBIGUOUS", "1", "dos");
+    init_parser("cat < ${TEST_AMBIGUOUS[@]}\n");
+    ck_assert_msg(parse_pipeline(parser) == NULL, NULL);
+    teardown();
+    init_parser("cat > ${TEST_AMBIGUOUS[@]} | wc\necho > $TEST_UNSET_AMBIGUOUS\n");
+    for (unsigned int i = 0; i < 2; i++)
+    {
+        cmdlist list = parse_list(parser);
+        ck_assert_msg(list != NULL && cmdlist_length(list) == 1, NULL);
+        int status = EXIT_SUCCESS;
+        ck_assert_msg(!expand_pipeline(cmdlist_nth(list, 0), &status), NULL);
+        ck_assert_msg(status == EXIT_FAILURE, NULL);
+        cmdlist_destroy(list);
+    }
+    vars_unset("TEST_AMBIGUOUS");
+}
+END_TEST
+
 /* Armado de la test suite */
 
 Suite *parser_suite(void)
@@ -448,10 +782,24 @@ Suite *parser_suite(void)
     tcase_add_test(tc_valid, test_pipe_background);
     tcase_add_test(tc_valid, test_non_alphabetic_args);
     tcase_add_test(tc_valid, test_many_args);
+    tcase_add_test(tc_valid, test_variables);
+    tcase_add_test(tc_valid, test_variables_unset);
+    tcase_add_test(tc_valid, test_variables_quoted);
+    tcase_add_test(tc_valid, test_array_variables);
+    tcase_add_test(tc_valid, test_array_huge_index);
+    tcase_add_test(tc_valid, test_braces);
+    tcase_add_test(tc_valid, test_pathnames);
+    tcase_add_test(tc_valid, test_word_stream);
+    tcase_add_test(tc_valid, test_command_list);
+    tcase_add_test(tc_valid, test_command_list_quoted_separator);
+    tcase_add_test(tc_valid, test_redirection_per_command);
     suite_add_tcase(s, tc_valid);
 
     /* Chequeos de error básicos */
     tcase_add_checked_fixture(tc_invalid, setup, teardown);
+    tcase_add_test(tc_invalid, test_command_list_invalid);
+    tcase_add_test(tc_invalid, test_redirection_missing);
+    tcase_add_test(tc_invalid, test_redirection_ambiguous);
     suite_add_tcase(s, tc_invalid);
 
     /* Entradas válidas, complejas */
@@ -0,0 +1,21 @@
+#include <string.h>
+
+#include "test_random.h"
+
+// Próximo número del generador (los bits altos, que son los que mejor se reparten)
+static unsigned int next_random(unsigned int *seed)
+{
+    *seed = *seed * 1103515245u + 12345u;
+    return *seed >> 16;
+}
+
+void random_text(unsigned int *seed, const char *alphabet, unsigned int max, char *text)
+{
+    unsigned int len = next_random(seed) % (max + 1);
+    size_t letters = strlen(alphabet);
+    for (unsigned int k = 0; k < len; k++)
+    {
+        text[k] = alphabet[next_random(seed) % letters];
+    }
+    text[len] = '\0';
+}
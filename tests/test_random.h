@@ -0,0 +1,16 @@
+#ifndef TEST_RANDOM_H
+#define TEST_RANDOM_H
+
+/* Textos al azar para los tests que comparan contra una versión de fuerza
+ * bruta. El generador es congruencial y arranca de la semilla que se le da:
+ * cada corrida prueba siempre los mismos casos.
+ */
+
+void random_text(unsigned int *seed, const char *alphabet, unsigned int max, char *text);
+/*
+ * Arma en `text' una cadena de 0 a `max' letras de `alphabet', y avanza
+ * `seed'. `text' tiene que tener lugar para max + 1 bytes.
+ * Requires: seed != NULL && alphabet != NULL && alphabet[0] != '\0' && text != NULL
+ */
+
+#endif
@@ -102,6 +102,14 @@ START_TEST (test_get_redir_out_null)
 }
 END_TEST
 
+START_TEST (test_steal_front_empty)
+{
+    scmd = scommand_new ();
+    scommand_steal_front (scmd);
+    scommand_destroy (scmd); scmd = NULL;
+}
+END_TEST
+
 START_TEST (test_to_string_null)
 {
     scommand_to_string (NULL);
@@ -212,6 +220,50 @@ START_TEST (test_fifo)
 }
 END_TEST
 
+/* steal_front devuelve las mismas cadenas que front, en orden, y las entrega */
+START_TEST (test_steal_front)
+{
+    unsigned int i = 0;
+    char **strings = numbers_as_str(MAX_LENGTH);
+    for (i=0; i<MAX_LENGTH; i++) {
+        scommand_push_back (scmd, strdup(strings[i]));
+    }
+    for (i=0; i<MAX_LENGTH; i++) {
+        ck_assert_msg (scommand_length (scmd) == MAX_LENGTH - i, NULL);
+        char *front = scommand_steal_front (scmd);
+        ck_assert_msg (strcmp (front, strings[i]) == 0, NULL);
+        free (front);
+        free (strings[i]);
+    }
+    ck_assert_msg (scommand_is_empty (scmd), NULL);
+    free (strings);
+}
+END_TEST
+
+/* argv tiene las cadenas en orden, terminadas en NULL; vaciar y volver a
+ * llenar no deja restos de antes
+ */
+START_TEST (test_argv)
+{
+    unsigned int i = 0;
+    char **strings = numbers_as_str(MAX_LENGTH);
+    scommand_push_back (scmd, strdup("x"));
+    scommand_pop_front (scmd);
+    for (i=0; i<MAX_LENGTH; i++) {
+        scommand_push_back (scmd, strdup(strings[i]));
+    }
+    char **argv = scommand_argv (scmd);
+    for (i=0; i<MAX_LENGTH; i++) {
+        ck_assert_msg (strcmp (argv[i], strings[i]) == 0, NULL);
+        free (strings[i]);
+    }
+    ck_assert_msg (argv[MAX_LENGTH] == NULL, NULL);
+    ck_assert_msg (scommand_length (scmd) == MAX_LENGTH, NULL);
+    free (argv);
+    free (strings);
+}
+END_TEST
+
 /* hacer muchísimas veces front es lo mismo */
 START_TEST (test_front_idempotent)
 {
@@ -356,6 +408,7 @@ Suite *scommand_suite (void)
     tcase_add_test_raise_signal (tc_preconditions, test_front_empty, SIGABRT);
     tcase_add_test_raise_signal (tc_preconditions, test_get_redir_in_null, SIGABRT);
     tcase_add_test_raise_signal (tc_preconditions, test_get_redir_out_null, SIGABRT);
+    tcase_add_test_raise_signal (tc_preconditions, test_steal_front_empty, SIGABRT);
     tcase_add_test_raise_signal (tc_preconditions, test_to_string_null, SIGABRT);
     suite_add_tcase (s, tc_preconditions);
 
@@ -369,6 +422,8 @@ Suite *scommand_suite (void)
     tcase_add_test (tc_functionality, test_adding_emptying);
     tcase_add_test (tc_functionality, test_adding_emptying_length);
     tcase_add_test (tc_functionality, test_fifo);
+    tcase_add_test (tc_functionality, test_steal_front);
+    tcase_add_test (tc_functionality, test_argv);
     tcase_add_test (tc_functionality, test_front_idempotent);
     tcase_add_test (tc_functionality, test_front_is_back);
     tcase_add_test (tc_functionality, test_front_is_not_back);
@@ -0,0 +1,229 @@
+#include <check.h>
+#include "test_script.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "../parser.h"
+#include "../parsing.h"
+#include "../script.h"
+#include "../vars.h"
+
+/* Los scripts usan solo comandos internos (set, declare), que corren dentro
+ * del proceso: lo que hicieron se ve en las variables. Como no hay test ni
+ * [, una condición es un set que falla si la palabra que arma no es un
+ * nombre válido ("set ${a}x=1" anda mientras a está vacía).
+ */
+
+static script code = NULL;
+static int saved_stdout = -1, saved_stderr = -1;
+
+static void setup(void)
+{
+    code = script_new();
+    /* los avisos de los set que fallan no ensucian la salida de los tests */
+    fflush(stdout);
+    fflush(stderr);
+    saved_stdout = dup(STDOUT_FILENO);
+    saved_stderr = dup(STDERR_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDOUT_FILENO);
+    dup2(null, STDERR_FILENO);
+    close(null);
+}
+
+static void teardown(void)
+{
+    fflush(stdout);
+    fflush(stderr);
+    dup2(saved_stdout, STDOUT_FILENO);
+    dup2(saved_stderr, STDERR_FILENO);
+    close(saved_stdout);
+    close(saved_stderr);
+    code = script_destroy(code);
+}
+
+/* Compila `text' de a una línea, como mybash, y ejecuta el código cada vez
+ * que no quedó nada abierto; deja en `status' el último estado. Devuelve
+ * false si alguna línea no compiló.
+ */
+static bool run_lines(const char *text, int *status)
+{
+    FILE *input = fmemopen((char *)text, strlen(text), "r");
+    Parser parser = parser_new(input);
+    bool compiled = true;
+    while (!parser_at_eof(parser))
+    {
+        cmdlist list = parse_list(parser);
+        if (list == NULL)
+        {
+            compiled = false;
+            script_discard(code);
+            continue;
+        }
+        compiled = script_compile(code, list) && compiled;
+        if (!script_pending(code))
+        {
+            *status = script_run(code);
+        }
+    }
+    parser_destroy(parser);
+    fclose(input);
+    return compiled;
+}
+
+static void check_variable(const char *name, const char *expected)
+{
+    const char *value = vars_get(name);
+    ck_assert_msg(value != NULL, "%s no está definida", name);
+    ck_assert_str_eq(value, expected);
+}
+
+START_TEST(test_if_elif_else)
+{
+    /* cada valor toma una rama distinta */
+    int status = EXIT_FAILURE;
+    ck_assert(run_lines("declare -A first second\n"
+                        "set first[1]=p second[2]=q r=\n"
+                        "for v in 1 2 3\n"
+                        "do\n"
+                        "  if set ${first[$v]}=1\n"
+                        "  then set r=${r}one\n"
+                        "  elif set ${second[$v]}=1; then set r=${r}two\n"
+                        "  else set r=${r}other\n"
+                        "  fi\n"
+                        "done\n",
+                        &status));
+    check_variable("r", "onetwoother");
+    ck_assert_int_eq(status, EXIT_SUCCESS);
+
+    /* sin else, si ninguna condición se cumple el if termina bien */
+    ck_assert(run_lines("if set =1; then set never=1; fi\n", &status));
+    ck_assert(vars_get("never") == NULL);
+    ck_assert_int_eq(status, EXIT_SUCCESS);
+
+    /* un if abierto no se ejecuta hasta que llega su fi */
+    ck_assert(run_lines("if set a=1\nthen set late=1\n", &status));
+    ck_assert(script_pending(code));
+    ck_assert(vars_get("late") == NULL);
+    ck_assert(run_lines("fi\n", &status));
+    ck_assert(!script_pending(code));
+    check_variable("late", "1");
+}
+END_TEST
+
+START_TEST(test_while_until)
+{
+    /* while sigue mientras la condición anda; until, mientras falla. Cada
+     * vuelta agrega una letra hasta llegar a la que corta el ciclo
+     */
+    int status = EXIT_FAILURE;
+    ck_assert(run_lines("declare -A limit reached\n"
+                        "set limit[iii]=1 reached[jj]=z n= m= stop= flag=\n"
+                        "while set ${stop}x=1\n"
+                        "do\n"
+                        "  set n=${n}i\n"
+                        "  set stop=${limit[$n]}\n"
+                        "done\n"
+                        "until set ${flag}=1\n"
+                        "do\n"
+                        "  set m=${m}j\n"
+                        "  set flag=${reached[$m]}\n"
+                        "done\n",
+                        &status));
+    check_variable("n", "iii");
+    check_variable("m", "jj");
+
+    /* una condición que falla de entrada no ejecuta el cuerpo */
+    ck_assert(run_lines("while set =1; do set never=1; done\n"
+                        "until set ok=1; do set never=1; done\n",
+                        &status));
+    ck_assert(vars_get("never") == NULL);
+}
+END_TEST
+
+START_TEST(test_for_nested)
+{
+    int status = EXIT_FAILURE;
+    ck_assert(run_lines("set r=\n"
+                        "for i in 1 2\n"
+                        "do for j in a b; do set r=${r}$i$j; done\n"
+                        "done\n",
+                        &status));
+    check_variable("r", "1a1b2a2b");
+    ck_assert_int_eq(status, EXIT_SUCCESS);
+}
+END_TEST
+
+START_TEST(test_for_braces)
+{
+    /* las llaves de un for se recorren con el generador, en orden */
+    int status = EXIT_FAILURE;
+    ck_assert(run_lines("set r=\nfor x in {a..c}{1,2}; do set r=${r}$x; done\n", &status));
+    check_variable("r", "a1a2b1b2c1c2");
+
+    /* cada palabra se expande recién cuando se acabaron las anteriores: la
+     * variable que asignó el cuerpo ya está definida al llegar a $later
+     */
+    ck_assert(run_lines("set s=\nfor x in {1,2} $later; do set later=seen s=${s}$x; done\n", &status));
+    check_variable("s", "12seen");
+
+    /* un rango grande no se arma entero antes de empezar */
+    ck_assert(run_lines("for x in {1..20000}; do set last=$x; done\n", &status));
+    check_variable("last", "20000");
+}
+END_TEST
+
+START_TEST(test_misplaced_keywords)
+{
+    /* una palabra clave fuera de lugar descarta todo lo compilado, sin
+     * ejecutar nada
+     */
+    const char *lines[] = {
+        "then set b=1\n",
+        "fi\n",
+        "done\n",
+        "else set b=1\n",
+        "if set a=1; do set b=1; fi\n",
+        "while set a=1; then set b=1; done\n",
+        "if set a=1 && then set b=1; fi\n",
+        "if set a=1; then set b=1; fi extra\n",
+        "for 1x in a; do set b=1; done\n",
+        "for x in a; do set b=1; fi\n",
+        "if set a=1\nthen set b=1\nelse set b=2\nelse set b=3\nfi\n",
+        "while set a=1\ndo set b=1\ndone &\n",
+    };
+    for (unsigned int i = 0; i < sizeof(lines) / sizeof(lines[0]); i++)
+    {
+        int status = EXIT_SUCCESS;
+        ck_assert_msg(!run_lines(lines[i], &status), "compiló: %s", lines[i]);
+        ck_assert_msg(!script_pending(code), "quedó abierto: %s", lines[i]);
+        ck_assert_msg(vars_get("b") == NULL, "se ejecutó: %s", lines[i]);
+    }
+}
+END_TEST
+
+/* Armado de la test suite */
+
+Suite *script_suite(void)
+{
+    Suite *s = suite_create("script");
+    TCase *tc_control = tcase_create("Control");
+    TCase *tc_invalid = tcase_create("Invalid");
+
+    tcase_add_checked_fixture(tc_control, setup, teardown);
+    tcase_add_test(tc_control, test_if_elif_else);
+    tcase_add_test(tc_control, test_while_until);
+    tcase_add_test(tc_control, test_for_nested);
+    tcase_add_test(tc_control, test_for_braces);
+    suite_add_tcase(s, tc_control);
+
+    tcase_add_checked_fixture(tc_invalid, setup, teardown);
+    tcase_add_test(tc_invalid, test_misplaced_keywords);
+    suite_add_tcase(s, tc_invalid);
+
+    return s;
+}
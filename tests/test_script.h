@@ -0,0 +1,8 @@
+#ifndef TEST_SCRIPT_H
+#define TEST_SCRIPT_H
+
+#include <check.h>
+
+Suite *script_suite (void);
+
+#endif
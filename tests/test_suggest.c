@@ -0,0 +1,322 @@
+#include <check.h>
+#include "test_suggest.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#include "../bktree.h"
+#include "../syntax.h"
+#include "test_random.h"
+
+/* Las distancias de Myers (de a una, por bloques para más de 64 caracteres y
+ * de a DISTANCE_LANES) se comparan con la tabla de programación dinámica de
+ * siempre (Levenshtein). Cada búsqueda del BK-tree se compara con un
+ * recorrido de todas las palabras en el orden en que se insertaron.
+ */
+
+#define WORD_MAX 8      // largo máximo de las palabras al azar
+#define RANDOM_WORDS 300 // palabras al azar en el árbol
+#define LONG_MAX_TEXT 200 // largo máximo de los textos largos al azar
+
+static const char *const words[] = {
+    "ls", "cd", "cat", "cut", "cp", "mv", "rm", "rmdir", "mkdir", "make",
+    "grep", "egrep", "fgrep", "git", "gitk", "sed", "sort", "ssh", "scp", "set",
+    "ls", "", "echo", "exit", "export", "ps", "pkill", "kill", "killall", "ñandú",
+    "añadir", "cat", "python3", "python", "pytest", "a", "aa", "aaa", "ab", "ba",
+};
+
+static const char *const queries[] = {
+    "", "l", "ls", "sl", "lss", "c", "ct", "cta", "grp", "gerp", "maek", "mkae",
+    "rmdr", "gti", "ehco", "exot", "pyhton", "ñandu", "nandú", "aaaa", "b", "zzzzzzzz",
+    "kil", "killal", "expor", "sett", "ssh", "xyz", "makefile",
+};
+
+static GArray *tree = NULL;
+
+static void setup(void)
+{
+    tree = bktree_new();
+}
+
+static void teardown(void)
+{
+    g_array_free(tree, TRUE);
+    tree = NULL;
+}
+
+/* Distancia de edición con la tabla entera: dp[i][j] es la distancia entre
+ * los primeros i bytes de a y los primeros j de b
+ */
+static unsigned int levenshtein(const char *a, const char *b)
+{
+    size_t n = strlen(a), m = strlen(b);
+    unsigned int *dp = malloc((n + 1) * (m + 1) * sizeof(unsigned int));
+    for (size_t i = 0; i <= n; i++)
+    {
+        for (size_t j = 0; j <= m; j++)
+        {
+            if (i == 0 || j == 0)
+            {
+                dp[i * (m + 1) + j] = (unsigned int)(i + j);
+                continue;
+            }
+            unsigned int replace = dp[(i - 1) * (m + 1) + j - 1] + (a[i - 1] != b[j - 1]);
+            unsigned int erase = dp[(i - 1) * (m + 1) + j] + 1;
+            unsigned int insert = dp[i * (m + 1) + j - 1] + 1;
+            unsigned int best = (replace < erase) ? replace : erase;
+            dp[i * (m + 1) + j] = (insert < best) ? insert : best;
+        }
+    }
+    unsigned int distance = dp[n * (m + 1) + m];
+    free(dp);
+    return distance;
+}
+
+/* La palabra más cercana a `query' entre las `count' primeras de `list', a
+ * distancia <= bound; a igual distancia, la primera
+ */
+static const char *brute_nearest(const char *const *list, unsigned int count, const char *query,
+                                 unsigned int bound, unsigned int *distance)
+{
+    const char *best = NULL;
+    *distance = bound + 1;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        unsigned int dist = levenshtein(query, list[i]);
+        if (dist < *distance)
+        {
+            *distance = dist;
+            best = list[i];
+        }
+    }
+    return best;
+}
+
+/* Arma en `text' `len' copias de `fill', con `change' en la posición `at'
+ * (si at < len)
+ */
+static void repeated_text(char fill, unsigned int len, char change, unsigned int at, char *text)
+{
+    memset(text, fill, len);
+    if (at < len)
+    {
+        text[at] = change;
+    }
+    text[len] = '\0';
+}
+
+static void check_distance(const char *a, const char *b)
+{
+    unsigned int expected = levenshtein(a, b);
+    ck_assert_msg(distance_of_edition(a, b) == expected, "\"%s\" y \"%s\": %u en lugar de %u", a, b,
+                  distance_of_edition(a, b), expected);
+    ck_assert_msg(distance_of_edition(b, a) == expected, "\"%s\" y \"%s\": %u en lugar de %u", b, a,
+                  distance_of_edition(b, a), expected);
+}
+
+/* Compara distance_of_edition_batch con levenshtein para las `count'
+ * primeras palabras de `list'
+ */
+static void check_batch(const char *word, const char *const *list, unsigned int count)
+{
+    unsigned int distances[count + 1];
+    distances[count] = UINT_MAX; // no se tiene que escribir más allá de count
+    distance_of_edition_batch(word, list, count, distances);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        unsigned int expected = levenshtein(word, list[i]);
+        ck_assert_msg(distances[i] == expected, "\"%s\" y \"%s\" (%u de %u): %u en lugar de %u", word, list[i], i,
+                      count, distances[i], expected);
+    }
+    ck_assert(distances[count] == UINT_MAX);
+}
+
+START_TEST(test_distance_table)
+{
+    static const char *const pairs[][2] = {
+        {"", ""}, {"", "a"}, {"", "abcdef"}, {"a", "a"}, {"a", "b"}, {"ab", "ba"},
+        {"kitten", "sitting"}, {"flaw", "lawn"}, {"gerp", "grep"}, {"ls", "sl"},
+        {"intention", "execution"}, {"abc", "abcabc"}, {"aaaa", "aa"}, {"mkdir", "rmdir"},
+        {"ñandú", "nandu"}, {"ñ", "n"}, {"año", "ano"}, {"\xff\x80", "\x80\xff"}, {"\xff", ""},
+        {"\t \n", " "}, {"python3", "pyhton"},
+    };
+    for (unsigned int i = 0; i < sizeof(pairs) / sizeof(pairs[0]); i++)
+    {
+        check_distance(pairs[i][0], pairs[i][1]);
+    }
+}
+END_TEST
+
+START_TEST(test_distance_long)
+{
+    /* alrededor de los 64 caracteres (un bloque) y de 128 (dos bloques),
+     * con el cambio al principio, en el borde del bloque o al final
+     */
+    static const unsigned int lengths[] = {1, 63, 64, 65, 100, 127, 128, 129, 150, 200};
+    static const unsigned int positions[] = {0, 1, 62, 63, 64, 65, 127, 128, 199, UINT_MAX};
+    char a[LONG_MAX_TEXT + 1], b[LONG_MAX_TEXT + 1];
+    for (unsigned int i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++)
+    {
+        repeated_text('a', lengths[i], 'b', UINT_MAX, a);
+        check_distance(a, "");
+        check_distance(a, "a");
+        check_distance(a, "b");
+        for (unsigned int j = 0; j < sizeof(lengths) / sizeof(lengths[0]); j++)
+        {
+            for (unsigned int k = 0; k < sizeof(positions) / sizeof(positions[0]); k++)
+            {
+                repeated_text('a', lengths[j], 'b', positions[k], b);
+                check_distance(a, b);
+            }
+        }
+    }
+}
+END_TEST
+
+START_TEST(test_distance_random)
+{
+    /* con dos letras hay muchas coincidencias, y los acarreos de la suma de
+     * Myers cruzan bloques enteros
+     */
+    static const char *const alphabets[] = {"ab", "abcdefgh", "a\xc3\xb1\xff"};
+    unsigned int seed = 777;
+    char a[LONG_MAX_TEXT + 1], b[LONG_MAX_TEXT + 1];
+    for (unsigned int i = 0; i < 300; i++)
+    {
+        const char *alphabet = alphabets[i % (sizeof(alphabets) / sizeof(alphabets[0]))];
+        random_text(&seed, alphabet, (i % 2 == 0) ? 20 : LONG_MAX_TEXT, a);
+        random_text(&seed, alphabet, (i % 3 == 0) ? 20 : LONG_MAX_TEXT, b);
+        check_distance(a, b);
+    }
+}
+END_TEST
+
+START_TEST(test_distance_batch)
+{
+    /* palabras de hasta 64 caracteres (en carriles) y más largas (de a una),
+     * con cantidades que no son múltiplo de DISTANCE_LANES
+     */
+    static char texts[4 * DISTANCE_LANES + 3][LONG_MAX_TEXT + 1];
+    const char *list[4 * DISTANCE_LANES + 3];
+    unsigned int seed = 99;
+    for (unsigned int i = 0; i < sizeof(list) / sizeof(list[0]); i++)
+    {
+        random_text(&seed, "abc", (i % 2 == 0) ? 10 : LONG_MAX_TEXT, texts[i]);
+        list[i] = texts[i];
+    }
+    texts[1][0] = '\0'; // un candidato vacío en medio de un grupo
+    static const unsigned int lengths[] = {0, 1, 5, 63, 64, 65, 130};
+    char word[LONG_MAX_TEXT + 1];
+    for (unsigned int i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++)
+    {
+        repeated_text('a', lengths[i], 'c', lengths[i] / 2, word);
+        for (unsigned int count = 0; count <= sizeof(list) / sizeof(list[0]); count++)
+        {
+            check_batch(word, list, count);
+        }
+    }
+    for (unsigned int i = 0; i < 50; i++)
+    {
+        random_text(&seed, "abc", (i % 2 == 0) ? 64 : LONG_MAX_TEXT, word);
+        check_batch(word, list, sizeof(list) / sizeof(list[0]));
+    }
+}
+END_TEST
+
+/* Compara bktree_nearest con brute_nearest para `query' y varios límites */
+static void check_query(const char *const *list, unsigned int count, const char *query)
+{
+    static const unsigned int bounds[] = {0, 1, 2, 3, 4, 6, 100};
+    for (unsigned int b = 0; b < sizeof(bounds) / sizeof(bounds[0]); b++)
+    {
+        unsigned int expected = 0, found = 0;
+        const char *hit = brute_nearest(list, count, query, bounds[b], &expected);
+        const char *word = bktree_nearest(tree, query, bounds[b], &found);
+        ck_assert_msg(found == expected, "\"%s\" hasta %u: distancia %u en lugar de %u", query, bounds[b], found,
+                      expected);
+        ck_assert_msg((word == NULL) == (hit == NULL), "\"%s\" hasta %u: %s", query, bounds[b],
+                      (hit == NULL) ? "encontró de más" : "no encontró");
+        ck_assert_msg(hit == NULL || strcmp(word, hit) == 0, "\"%s\" hasta %u: \"%s\" en lugar de \"%s\"", query,
+                      bounds[b], word, hit);
+    }
+}
+
+START_TEST(test_bktree_empty)
+{
+    unsigned int distance = 0;
+    ck_assert(bktree_nearest(tree, "ls", 3, &distance) == NULL);
+    ck_assert_int_eq(distance, 4);
+    ck_assert(bktree_nearest(tree, "", 0, &distance) == NULL);
+    ck_assert_int_eq(distance, 1);
+}
+END_TEST
+
+START_TEST(test_bktree_table)
+{
+    /* las palabras repetidas no se vuelven a insertar: la de brute_nearest
+     * también es la primera
+     */
+    unsigned int count = sizeof(words) / sizeof(words[0]);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        bktree_insert(tree, words[i]);
+    }
+    ck_assert(tree->len < count);
+    for (unsigned int i = 0; i < sizeof(queries) / sizeof(queries[0]); i++)
+    {
+        check_query(words, count, queries[i]);
+    }
+    for (unsigned int i = 0; i < count; i++)
+    {
+        check_query(words, count, words[i]);
+    }
+}
+END_TEST
+
+START_TEST(test_bktree_random)
+{
+    /* con un alfabeto chico hay muchas palabras a la misma distancia: se
+     * prueba que gane siempre la que se insertó antes
+     */
+    static char texts[RANDOM_WORDS][WORD_MAX + 1];
+    const char *list[RANDOM_WORDS];
+    unsigned int seed = 4321;
+    for (unsigned int i = 0; i < RANDOM_WORDS; i++)
+    {
+        random_text(&seed, "abc", WORD_MAX, texts[i]);
+        list[i] = texts[i];
+        bktree_insert(tree, list[i]);
+    }
+    char query[WORD_MAX + 3];
+    for (unsigned int i = 0; i < 200; i++)
+    {
+        random_text(&seed, "abcd", WORD_MAX + 2, query);
+        check_query(list, RANDOM_WORDS, query);
+    }
+}
+END_TEST
+
+/* Armado de la test suite */
+
+Suite *suggest_suite(void)
+{
+    Suite *s = suite_create("suggest");
+    TCase *tc_distance = tcase_create("Distance");
+    TCase *tc_bktree = tcase_create("BK-tree");
+
+    tcase_add_test(tc_distance, test_distance_table);
+    tcase_add_test(tc_distance, test_distance_long);
+    tcase_add_test(tc_distance, test_distance_random);
+    tcase_add_test(tc_distance, test_distance_batch);
+    suite_add_tcase(s, tc_distance);
+
+    tcase_add_checked_fixture(tc_bktree, setup, teardown);
+    tcase_add_test(tc_bktree, test_bktree_empty);
+    tcase_add_test(tc_bktree, test_bktree_table);
+    tcase_add_test(tc_bktree, test_bktree_random);
+    suite_add_tcase(s, tc_bktree);
+
+    return s;
+}
@@ -0,0 +1,8 @@
+#ifndef TEST_SUGGEST_H
+#define TEST_SUGGEST_H
+
+#include <check.h>
+
+Suite *suggest_suite (void);
+
+#endif
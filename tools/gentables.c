@@ -0,0 +1,181 @@
+/* Generador de las tablas que se compilan dentro de mybash.
+ *
+ *   gentables builtins < nombres > builtin_hash.h
+ *     Lee los nombres de los comandos internos, en el orden de
+ *     internal_commands, y genera un hash perfecto: una semilla para phash()
+ *     y una tabla que lleva cada posición al índice del comando.
+ *
+ *   gentables dictionary < commands.in > dictionary.h
+ *     Lee las palabras del diccionario de sugerencias y las deja ordenadas y
+ *     sin repetir en un único bloque de memoria.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../phash.h"
+
+#define MAX_WORD_LENGTH 100 // Longitud máxima de una palabra de la entrada
+#define MAX_SEEDS 1000000   // Semillas a probar antes de agrandar la tabla
+
+static char **read_words(unsigned int *count)
+{
+    char buffer[MAX_WORD_LENGTH];
+    unsigned int capacity = 64;
+    char **words = malloc(capacity * sizeof(char *));
+    *count = 0;
+    while (scanf("%99s", buffer) == 1)
+    {
+        if (*count == capacity)
+        {
+            capacity *= 2;
+            words = realloc(words, capacity * sizeof(char *));
+        }
+        words[(*count)++] = strdup(buffer);
+    }
+    return words;
+}
+
+/* Imprime `word' como parte de un literal de C */
+static void print_escaped(const char *word)
+{
+    for (const unsigned char *c = (const unsigned char *)word; *c != '\0'; c++)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            printf("\\%c", *c);
+        }
+        else if (*c < ' ' || *c > '~')
+        {
+            printf("\\%03o", *c);
+        }
+        else
+        {
+            putchar(*c);
+        }
+    }
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de buscar una semilla sin colisiones para los nombres
+  -- se prueba con la tabla más chica que tenga al menos el doble de lugares que nombres,
+                      y se la agranda si ninguna semilla sirve --
+------------------------------------------------------------------------------------------------
+*/
+static int generate_builtins(void)
+{
+    unsigned int count;
+    char **names = read_words(&count);
+    unsigned int bits = 1;
+    while ((1u << bits) < 2 * count)
+    {
+        bits++;
+    }
+    unsigned char *slots = NULL;
+    uint32_t seed = 0;
+    bool found = false;
+    while (!found && bits < 16)
+    {
+        slots = realloc(slots, 1u << bits);
+        for (seed = 0; !found && seed < MAX_SEEDS; seed++)
+        {
+            memset(slots, 0, 1u << bits);
+            found = true;
+            for (unsigned int i = 0; found && i < count; i++)
+            {
+                uint32_t slot = phash_slot(names[i], seed, bits);
+                found = slots[slot] == 0;
+                slots[slot] = i + 1;
+            }
+        }
+        if (!found)
+        {
+            bits++;
+        }
+    }
+    if (!found || count > 254)
+    {
+        fprintf(stderr, "gentables: no se encontró un hash perfecto para %u nombres\n", count);
+        return EXIT_FAILURE;
+    }
+    seed--; // el for la incrementó al salir
+
+    printf("/* Generado por tools/gentables a partir de internal_commands: no editar */\n\n");
+    printf("#define BUILTIN_COUNT %u\n", count);
+    printf("#define BUILTIN_HASH_SEED %uu\n", seed);
+    printf("#define BUILTIN_HASH_BITS %u\n\n", bits);
+    printf("// Posición -> índice en internal_commands más uno (0 = vacía)\n");
+    printf("static const unsigned char builtin_slots[1u << BUILTIN_HASH_BITS] = {");
+    for (unsigned int i = 0; i < (1u << bits); i++)
+    {
+        printf("%s%u", (i % 16 == 0) ? "\n    " : " ", slots[i]);
+        if (i + 1 < (1u << bits))
+        {
+            putchar(',');
+        }
+    }
+    printf("};\n");
+    for (unsigned int i = 0; i < count; i++)
+    {
+        free(names[i]);
+    }
+    free(names);
+    free(slots);
+    return EXIT_SUCCESS;
+}
+
+static int compare_words(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static int generate_dictionary(void)
+{
+    unsigned int count;
+    char **words = read_words(&count);
+    qsort(words, count, sizeof(char *), compare_words);
+    unsigned int unique = 0;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (unique == 0 || strcmp(words[unique - 1], words[i]) != 0)
+        {
+            words[unique++] = words[i];
+        }
+        else
+        {
+            free(words[i]);
+        }
+    }
+
+    printf("/* Generado por tools/gentables a partir de commands.in: no editar */\n\n");
+    printf("#define DICTIONARY_COUNT %u\n\n", unique);
+    printf("// Palabras ordenadas, cada una terminada en '\\0'\n");
+    printf("static const char dictionary_words[] =");
+    for (unsigned int i = 0; i < unique; i++)
+    {
+        printf("\n    \"");
+        print_escaped(words[i]);
+        printf("\\0\"");
+        free(words[i]);
+    }
+    printf("%s;\n", unique == 0 ? " \"\"" : "");
+    free(words);
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc == 2 && strcmp(argv[1], "builtins") == 0)
+    {
+        return generate_builtins();
+    }
+    if (argc == 2 && strcmp(argv[1], "dictionary") == 0)
+    {
+        return generate_dictionary();
+    }
+    fprintf(stderr, "uso: %s builtins|dictionary < entrada > salida.h\n", argv[0]);
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,401 @@
+#include <assert.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <glib.h>
+
+#include "treewalk.h"
+#include "getdents.h"
+#include "strextra.h"
+
+#define IDLE_WAIT_NSEC 1000000L // Cuánto duerme un hilo sin trabajo antes de volver a buscar
+#define FD_RESERVE 16           // Descriptores que se dejan para el resto del shell
+
+// Directorio leído: queda abierto mientras falte abrir alguno de sus subdirectorios
+struct dir_node
+{
+    int fd;          // -1 si no se guardó (no quedaban descriptores): los hijos se abren con la ruta
+    atomic_int refs; // el hilo que lo lee, y una por cada subdirectorio pendiente
+    char *path;      // ruta para los resultados, terminada en '/' (o "")
+};
+
+// Un directorio por leer: `name' dentro de `parent'
+struct walk_task
+{
+    struct dir_node *parent; // NULL: la raíz
+    char *name;
+};
+
+struct walk_pool;
+
+struct walker
+{
+    struct walk_pool *pool;
+    pthread_mutex_t lock; // cuida la cola: el dueño saca del final y los demás roban del principio
+    GArray *tasks;        // struct walk_task; las vivas están en [head, len)
+    guint head;
+    GPtrArray *results;   // rutas que encontró este hilo
+    char *buffer;         // buffer de getdents64
+};
+
+struct walk_pool
+{
+    const char *root;
+    treewalk_filter filter;
+    void *data;
+    unsigned int count;
+    struct walker *walkers;
+    atomic_long pending;  // directorios en alguna cola o leyéndose
+    atomic_int held;      // descriptores que guardan los dir_node
+    int budget;           // cuántos pueden guardar como mucho
+    atomic_uint idle;     // hilos dormidos esperando trabajo
+    pthread_mutex_t lock;
+    pthread_cond_t wake;  // hay trabajo nuevo, o ya no queda nada
+};
+
+static void node_unref(struct walk_pool *pool, struct dir_node *node)
+{
+    if (node != NULL && atomic_fetch_sub(&node->refs, 1) == 1)
+    {
+        if (node->fd >= 0)
+        {
+            close(node->fd);
+            atomic_fetch_sub(&pool->held, 1);
+        }
+        free(node->path);
+        free(node);
+    }
+}
+
+static void wake(struct walk_pool *pool, bool all)
+{
+    pthread_mutex_lock(&pool->lock);
+    if (all)
+    {
+        pthread_cond_broadcast(&pool->wake);
+    }
+    else
+    {
+        pthread_cond_signal(&pool->wake);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static void push_task(struct walker *self, struct dir_node *parent, const char *name)
+{
+    struct walk_task task = {parent, strdup(name)};
+    atomic_fetch_add(&parent->refs, 1);
+    atomic_fetch_add(&self->pool->pending, 1);
+    pthread_mutex_lock(&self->lock);
+    g_array_append_val(self->tasks, task);
+    pthread_mutex_unlock(&self->lock);
+    if (atomic_load(&self->pool->idle) > 0)
+    {
+        wake(self->pool, false);
+    }
+}
+
+// Saca una tarea de la cola de `victim': el dueño la toma del final, los demás del principio
+static bool take_task(struct walker *victim, bool own, struct walk_task *task)
+{
+    bool found = false;
+    pthread_mutex_lock(&victim->lock);
+    if (victim->head < victim->tasks->len)
+    {
+        found = true;
+        if (own)
+        {
+            *task = g_array_index(victim->tasks, struct walk_task, victim->tasks->len - 1);
+            g_array_set_size(victim->tasks, victim->tasks->len - 1);
+        }
+        else
+        {
+            *task = g_array_index(victim->tasks, struct walk_task, victim->head++);
+        }
+        if (victim->head == victim->tasks->len)
+        {
+            g_array_set_size(victim->tasks, 0);
+            victim->head = 0;
+        }
+    }
+    pthread_mutex_unlock(&victim->lock);
+    return found;
+}
+
+static bool steal_task(struct walker *self, struct walk_task *task)
+{
+    struct walk_pool *pool = self->pool;
+    unsigned int index = (unsigned int)(self - pool->walkers);
+    for (unsigned int i = 1; i < pool->count; i++)
+    {
+        if (take_task(&pool->walkers[(index + i) % pool->count], false, task))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de abrir el directorio de una tarea
+  -- relativo al descriptor del padre (o con la ruta, si el padre no lo guardó). El nodo se
+     queda con el descriptor solo si hay lugar en el presupuesto; en `fd' queda para leer --
+------------------------------------------------------------------------------------------------
+*/
+static struct dir_node *open_task(struct walk_pool *pool, struct walk_task *task, int *fd)
+{
+    int flags = O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC;
+    char *path = NULL;
+    if (task->parent == NULL)
+    {
+        size_t length = strlen(pool->root);
+        path = path_join(pool->root, "", length > 0 && pool->root[length - 1] != '/');
+        *fd = open((length > 0) ? pool->root : ".", flags & ~O_NOFOLLOW);
+    }
+    else
+    {
+        path = path_join(task->parent->path, task->name, true);
+        *fd = (task->parent->fd >= 0) ? openat(task->parent->fd, task->name, flags) : open(path, flags);
+    }
+    free(task->name);
+    node_unref(pool, task->parent);
+    if (*fd < 0)
+    {
+        free(path);
+        return NULL;
+    }
+    struct dir_node *node = malloc(sizeof(struct dir_node));
+    assert(node != NULL);
+    node->fd = -1;
+    if (atomic_fetch_add(&pool->held, 1) < pool->budget)
+    {
+        node->fd = *fd;
+    }
+    else
+    {
+        atomic_fetch_sub(&pool->held, 1);
+    }
+    atomic_init(&node->refs, 1);
+    node->path = path;
+    return node;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de leer un directorio
+  -- anota los nombres que acepta el filtro y encola los subdirectorios que no están ocultos --
+------------------------------------------------------------------------------------------------
+*/
+static void walk_dir(struct walker *self, struct walk_task *task)
+{
+    struct walk_pool *pool = self->pool;
+    int fd = -1;
+    struct dir_node *node = open_task(pool, task, &fd);
+    if (node == NULL)
+    {
+        return;
+    }
+    long nread;
+    while ((nread = syscall(SYS_getdents64, fd, self->buffer, GETDENTS_BUFFER)) > 0)
+    {
+        for (long pos = 0; pos < nread;)
+        {
+            struct linux_dirent64 *d = (struct linux_dirent64 *)(self->buffer + pos);
+            pos += d->d_reclen;
+            if (strcmp(d->d_name, ".") == 0 || strcmp(d->d_name, "..") == 0)
+            {
+                continue;
+            }
+            struct stat st;
+            bool is_dir = (d->d_type == DT_DIR);
+            if (d->d_type == DT_UNKNOWN)
+            {
+                is_dir = fstatat(fd, d->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0 && S_ISDIR(st.st_mode);
+            }
+            if (pool->filter(d->d_name, is_dir, pool->data))
+            {
+                g_ptr_array_add(self->results, path_join(node->path, d->d_name, false));
+            }
+            if (is_dir && d->d_name[0] != '.')
+            {
+                push_task(self, node, d->d_name);
+            }
+        }
+    }
+    if (node->fd < 0)
+    {
+        close(fd);
+    }
+    node_unref(pool, node);
+}
+
+static int path_compare(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static void *walk_worker(void *data)
+{
+    struct walker *self = data;
+    struct walk_pool *pool = self->pool;
+    struct walk_task task;
+    for (;;)
+    {
+        if (take_task(self, true, &task) || steal_task(self, &task))
+        {
+            walk_dir(self, &task);
+            if (atomic_fetch_sub(&pool->pending, 1) == 1)
+            {
+                wake(pool, true); // era el último: los que duermen pueden terminar
+            }
+            continue;
+        }
+        pthread_mutex_lock(&pool->lock);
+        if (atomic_load(&pool->pending) == 0)
+        {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        // alguien todavía lee un directorio que puede traer más: se espera un rato y se vuelve a buscar
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += IDLE_WAIT_NSEC;
+        deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+        deadline.tv_nsec %= 1000000000L;
+        atomic_fetch_add(&pool->idle, 1);
+        pthread_cond_timedwait(&pool->wake, &pool->lock, &deadline);
+        atomic_fetch_sub(&pool->idle, 1);
+        pthread_mutex_unlock(&pool->lock);
+    }
+    qsort(self->results->pdata, self->results->len, sizeof(gpointer), path_compare);
+    return NULL;
+}
+
+// Mezcla dos arreglos ordenados en uno nuevo; las cadenas pasan al resultado
+static GPtrArray *merge_sorted(GPtrArray *a, GPtrArray *b)
+{
+    GPtrArray *result = g_ptr_array_sized_new(a->len + b->len);
+    guint i = 0, j = 0;
+    while (i < a->len || j < b->len)
+    {
+        bool first = (j == b->len) || (i < a->len && strcmp(g_ptr_array_index(a, i), g_ptr_array_index(b, j)) <= 0);
+        g_ptr_array_add(result, first ? g_ptr_array_index(a, i++) : g_ptr_array_index(b, j++));
+    }
+    g_ptr_array_free(a, TRUE);
+    g_ptr_array_free(b, TRUE);
+    return result;
+}
+
+static unsigned int default_threads(void)
+{
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    return (processors > 0) ? (unsigned int)processors : 1;
+}
+
+// Cuántos descriptores se pueden usar: el límite del proceso menos los que se dejan libres
+static int available_fds(void)
+{
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur == RLIM_INFINITY || limit.rlim_cur > INT_MAX)
+    {
+        return 1024;
+    }
+    return MAX(0, (int)limit.rlim_cur - FD_RESERVE);
+}
+
+GPtrArray *treewalk_find(const char *root, treewalk_filter filter, void *data, unsigned int threads)
+{
+    assert(root != NULL && filter != NULL);
+    threads = (threads == 0) ? default_threads() : threads;
+    threads = MAX(1u, MIN(threads, TREEWALK_MAX_THREADS));
+    // cada hilo necesita un descriptor para el directorio que lee; el resto, a medias, para los padres
+    int fds = available_fds();
+    threads = MAX(1u, MIN(threads, (unsigned int)fds / 2));
+
+    struct walk_pool pool;
+    pool.root = root;
+    pool.filter = filter;
+    pool.data = data;
+    pool.count = threads;
+    pool.walkers = calloc(threads, sizeof(struct walker));
+    assert(pool.walkers != NULL);
+    atomic_init(&pool.pending, 1);
+    atomic_init(&pool.held, 0);
+    pool.budget = (fds - (int)threads) / 2;
+    atomic_init(&pool.idle, 0);
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.wake, NULL);
+    for (unsigned int w = 0; w < threads; w++)
+    {
+        struct walker *walker = &pool.walkers[w];
+        walker->pool = &pool;
+        pthread_mutex_init(&walker->lock, NULL);
+        walker->tasks = g_array_new(FALSE, FALSE, sizeof(struct walk_task));
+        walker->results = g_ptr_array_new();
+        walker->buffer = malloc(GETDENTS_BUFFER);
+        assert(walker->buffer != NULL);
+    }
+    // la raíz va a la cola del primer hilo, que es este mismo
+    struct walk_task first = {NULL, NULL};
+    g_array_append_val(pool.walkers[0].tasks, first);
+
+    pthread_t workers[TREEWALK_MAX_THREADS];
+    bool started[TREEWALK_MAX_THREADS];
+    for (unsigned int w = 1; w < threads; w++)
+    {
+        started[w] = pthread_create(&workers[w], NULL, walk_worker, &pool.walkers[w]) == 0;
+    }
+    walk_worker(&pool.walkers[0]);
+    for (unsigned int w = 1; w < threads; w++)
+    {
+        if (started[w])
+        {
+            pthread_join(workers[w], NULL);
+        }
+        else
+        {
+            // su hilo no se pudo crear: la cola quedó vacía, pero sus resultados también se ordenan
+            walk_worker(&pool.walkers[w]);
+        }
+    }
+
+    // cada hilo dejó sus resultados ordenados: se mezclan de a pares hasta que queda uno
+    GPtrArray **results = malloc(threads * sizeof(GPtrArray *));
+    assert(results != NULL);
+    for (unsigned int w = 0; w < threads; w++)
+    {
+        results[w] = pool.walkers[w].results;
+        g_array_free(pool.walkers[w].tasks, TRUE);
+        free(pool.walkers[w].buffer);
+        pthread_mutex_destroy(&pool.walkers[w].lock);
+    }
+    for (unsigned int count = threads; count > 1; count = (count + 1) / 2)
+    {
+        for (unsigned int i = 0; i < count / 2; i++)
+        {
+            results[i] = merge_sorted(results[2 * i], results[2 * i + 1]);
+        }
+        if (count % 2 == 1)
+        {
+            results[count / 2] = results[count - 1];
+        }
+    }
+    GPtrArray *found = results[0];
+    g_ptr_array_set_free_func(found, free);
+    free(results);
+    free(pool.walkers);
+    pthread_mutex_destroy(&pool.lock);
+    pthread_cond_destroy(&pool.wake);
+    return found;
+}
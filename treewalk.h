@@ -0,0 +1,39 @@
+/* Recorrido en paralelo de un árbol de directorios (para los patrones con **).
+ * Un grupo de hilos se reparte los directorios con robo de trabajo: cada hilo
+ * tiene su propia cola, agrega al final los subdirectorios que encuentra y
+ * sigue por el último (en profundidad); cuando se queda sin nada le saca a
+ * otro hilo el más viejo de su cola, que suele ser la raíz de un subárbol
+ * grande. Cada directorio se abre con openat() relativo al descriptor de su
+ * padre, sin volver a resolver la ruta entera, y se lee con getdents64.
+ * Cada hilo junta sus resultados aparte y los ordena; al final se mezclan.
+ *
+ * Como en el globstar de bash, no se entra a directorios ocultos ni se siguen
+ * los enlaces simbólicos a directorios.
+ */
+
+#ifndef TREEWALK_H
+#define TREEWALK_H
+
+#include <stdbool.h>
+#include <glib.h>
+
+#define TREEWALK_MAX_THREADS 16 // Máxima cantidad de hilos que recorren un árbol a la vez
+
+typedef bool (*treewalk_filter)(const char *name, bool is_dir, void *data);
+
+GPtrArray *treewalk_find(const char *root, treewalk_filter filter, void *data, unsigned int threads);
+/*
+ * Busca en todo el árbol que empieza en `root' (sin contarlo a él) los
+ * nombres que acepta `filter'.
+ *   root: directorio donde empezar; "" es el actual. Las rutas del resultado
+ *     empiezan con `root', al que se le agrega una '/' si no la tenía.
+ *   filter: recibe cada nombre sin su directorio, y si es un directorio (sin
+ *     seguir enlaces). Se llama desde varios hilos a la vez.
+ *   threads: cantidad de hilos (0: uno por procesador), hasta
+ *     TREEWALK_MAX_THREADS.
+ *   Returns: las rutas, ordenadas con strcmp(), en un arreglo que libera sus
+ *     cadenas con free(). Está vacío si `root' no se puede abrir.
+ * Requires: root != NULL && filter != NULL
+ */
+
+#endif /* TREEWALK_H */
@@ -0,0 +1,950 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#include "vars.h"
+#include "array.h"
+
+#define VARS_MIN_CAPACITY 64       // lugares de la tabla al empezar (siempre una potencia de 2)
+#define NAMES_BLOCK 4096           // tamaño de cada bloque del GStringChunk de nombres
+#define PATTERN_QUOTED "*?[\\'\"" // se escapan en un patrón si estaban entre comillas
+#define PATTERN_VALUE "\\'\""     // se escapan en un patrón si vienen del valor de una variable
+
+extern char **environ;
+
+struct var_slot
+{
+    const char *name;      // NULL: lugar libre (ahí termina la búsqueda)
+    char *value;           // valor escalar; NULL: declarada sin valor, o es un arreglo
+    indexed_array indexed; // con VAR_INDEXED
+    assoc_array assoc;     // con VAR_ASSOC
+    uint32_t hash;
+    unsigned int flags;    // VAR_EXPORTED, VAR_INDEXED, VAR_ASSOC
+    bool declared;         // false: se borró, pero el nombre queda para volver a usar el lugar
+};
+
+static struct var_slot *slots = NULL;
+static size_t capacity = 0;  // potencia de 2
+static size_t used = 0;      // lugares con nombre (declarados o borrados)
+static GStringChunk *names = NULL;
+
+// el entorno de los hijos se arma de nuevo solo si cambió algo exportado desde la última vez
+static unsigned long exported_generation = 1; // aumenta con cada cambio de una variable exportada
+static unsigned long envp_generation = 0;     // generación con la que se armó envp
+static char **envp = NULL;
+
+static char status_text[16] = "0"; // $?, ya como texto: se expande más veces de las que cambia
+
+static struct var_slot *lookup(const char *name, size_t length, bool create);
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de calcular el hash de un nombre
+  -- es el mismo FNV-1a de phash.h, pero con largo: así sirve para un nombre que está en el
+                         medio de una palabra, sin copiarlo --
+------------------------------------------------------------------------------------------------
+*/
+static uint32_t hash_name(const char *name, size_t length)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < length; i++)
+    {
+        h = (h ^ (unsigned char)name[i]) * 16777619u;
+    }
+    h ^= h >> 15;
+    h *= 0x2c1b3c6du;
+    h ^= h >> 12;
+    return h;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de buscar el lugar de un nombre (sondeo lineal)
+  -- devuelve el lugar que tiene ese nombre, o el lugar libre donde iría --
+------------------------------------------------------------------------------------------------
+*/
+static struct var_slot *find_slot(const char *name, size_t length, uint32_t hash)
+{
+    size_t mask = capacity - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask)
+    {
+        struct var_slot *slot = &slots[i];
+        if (slot->name == NULL ||
+            (slot->hash == hash && strncmp(slot->name, name, length) == 0 && slot->name[length] == '\0'))
+        {
+            return slot;
+        }
+    }
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de rearmar la tabla con `new_capacity' lugares
+  -- los nombres borrados no se copian: su lugar se libera (el nombre queda en el bloque) --
+------------------------------------------------------------------------------------------------
+*/
+static void rehash(size_t new_capacity)
+{
+    struct var_slot *old = slots;
+    size_t old_capacity = capacity;
+    slots = g_new0(struct var_slot, new_capacity);
+    capacity = new_capacity;
+    used = 0;
+    for (size_t i = 0; i < old_capacity; i++)
+    {
+        if (old[i].name != NULL && old[i].declared)
+        {
+            size_t mask = capacity - 1, j = old[i].hash & mask;
+            while (slots[j].name != NULL)
+            {
+                j = (j + 1) & mask;
+            }
+            slots[j] = old[i];
+            used++;
+        }
+    }
+    g_free(old);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de crear la tabla la primera vez que se usa
+  -- arranca con las variables del entorno, todas exportadas --
+------------------------------------------------------------------------------------------------
+*/
+static void ensure_table(void)
+{
+    if (slots != NULL)
+    {
+        return;
+    }
+    slots = g_new0(struct var_slot, VARS_MIN_CAPACITY);
+    capacity = VARS_MIN_CAPACITY;
+    names = g_string_chunk_new(NAMES_BLOCK);
+    for (char **entry = environ; *entry != NULL; entry++)
+    {
+        const char *equals = strchr(*entry, '=');
+        if (equals != NULL && vars_valid_name(*entry, equals - *entry))
+        {
+            struct var_slot *slot = lookup(*entry, equals - *entry, true);
+            g_free(slot->value);
+            slot->value = g_strdup(equals + 1);
+            slot->flags = VAR_EXPORTED;
+        }
+    }
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de buscar un nombre, y de agregarlo si `create' y no estaba
+  -- un nombre agregado se copia una sola vez al bloque de nombres --
+------------------------------------------------------------------------------------------------
+*/
+static struct var_slot *lookup(const char *name, size_t length, bool create)
+{
+    ensure_table();
+    uint32_t hash = hash_name(name, length);
+    struct var_slot *slot = find_slot(name, length, hash);
+    if (slot->name == NULL)
+    {
+        if (!create)
+        {
+            return NULL;
+        }
+        // se mantiene al menos un cuarto de la tabla libre, así los sondeos son cortos
+        if (4 * (used + 1) > 3 * capacity)
+        {
+            size_t live = 0;
+            for (size_t i = 0; i < capacity; i++)
+            {
+                live += (slots[i].name != NULL && slots[i].declared);
+            }
+            // si sobran borrados alcanza con limpiar, sin agrandar
+            rehash(4 * (live + 1) > capacity ? 2 * capacity : capacity);
+            slot = find_slot(name, length, hash);
+        }
+        slot->name = g_string_chunk_insert_len(names, name, length);
+        slot->hash = hash;
+        used++;
+    }
+    if (!slot->declared && create)
+    {
+        slot->declared = true;
+        slot->value = NULL;
+        slot->flags = VAR_LOCAL;
+    }
+    return slot->declared ? slot : NULL;
+}
+
+bool vars_valid_name(const char *name, size_t length)
+{
+    assert(name != NULL);
+    if (length == 0 || !(g_ascii_isalpha(name[0]) || name[0] == '_'))
+    {
+        return false;
+    }
+    for (size_t i = 1; i < length; i++)
+    {
+        if (!(g_ascii_isalnum(name[i]) || name[i] == '_'))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de avisar que cambió el valor de una variable
+  -- si está exportada se actualiza el entorno del shell y cambia la generación, así el envp
+                             de los hijos se vuelve a armar --
+------------------------------------------------------------------------------------------------
+*/
+static void value_changed(struct var_slot *slot)
+{
+    if (slot->flags & VAR_EXPORTED)
+    {
+        // los arreglos no se exportan (como en bash)
+        if (slot->value != NULL)
+        {
+            setenv(slot->name, slot->value, 1);
+        }
+        else
+        {
+            unsetenv(slot->name);
+        }
+        exported_generation++;
+    }
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de liberar el valor de una variable (escalar o arreglo)
+------------------------------------------------------------------------------------------------
+*/
+static void clear_value(struct var_slot *slot)
+{
+    g_free(slot->value);
+    slot->value = NULL;
+    if (slot->indexed != NULL)
+    {
+        indexed_destroy(slot->indexed);
+        slot->indexed = NULL;
+    }
+    if (slot->assoc != NULL)
+    {
+        assoc_destroy(slot->assoc);
+        slot->assoc = NULL;
+    }
+    slot->flags &= ~(VAR_INDEXED | VAR_ASSOC);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de leer un índice de un arreglo indexado
+  -- un índice negativo cuenta desde el final; devuelve false si no es un número, queda
+     antes del principio o es un índice nuevo de INDEXED_MAX_INDEX en adelante (el arreglo
+                         es denso: reservaría lugar para todos los anteriores) --
+------------------------------------------------------------------------------------------------
+*/
+static bool parse_index(indexed_array array, const char *subscript, size_t *index)
+{
+    char *end = NULL;
+    long value = strtol(subscript, &end, 10);
+    if (subscript[0] == '\0' || *end != '\0')
+    {
+        return false;
+    }
+    if (value < 0)
+    {
+        value += (long)indexed_end(array);
+        if (value < 0)
+        {
+            return false;
+        }
+    }
+    if ((unsigned long)value >= INDEXED_MAX_INDEX && (unsigned long)value >= indexed_end(array))
+    {
+        return false;
+    }
+    *index = (size_t)value;
+    return true;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de devolver un elemento de una variable
+  -- a una variable escalar se la trata como un arreglo de un elemento, el 0 --
+------------------------------------------------------------------------------------------------
+*/
+static const char *element(struct var_slot *slot, const char *subscript)
+{
+    size_t index = 0;
+    if (slot->flags & VAR_ASSOC)
+    {
+        return assoc_get(slot->assoc, subscript);
+    }
+    if (slot->flags & VAR_INDEXED)
+    {
+        return parse_index(slot->indexed, subscript, &index) ? indexed_get(slot->indexed, index) : NULL;
+    }
+    return (strcmp(subscript, "0") == 0) ? slot->value : NULL;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de devolver el valor de $NOMBRE
+  -- en un arreglo es el elemento 0, como en bash --
+------------------------------------------------------------------------------------------------
+*/
+static const char *scalar_value(struct var_slot *slot)
+{
+    return (slot->flags & (VAR_INDEXED | VAR_ASSOC)) ? element(slot, "0") : slot->value;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de recorrer los valores de una variable
+  -- los arreglos indexados por índice, los asociativos en orden de inserción y una escalar
+                                     es un solo valor --
+------------------------------------------------------------------------------------------------
+*/
+static bool next_value(struct var_slot *slot, size_t *position, const char **key, const char **value)
+{
+    if (slot->flags & VAR_ASSOC)
+    {
+        return assoc_next(slot->assoc, position, key, value);
+    }
+    if (slot->flags & VAR_INDEXED)
+    {
+        while (*position < indexed_end(slot->indexed) && indexed_get(slot->indexed, *position) == NULL)
+        {
+            (*position)++;
+        }
+        if (*position >= indexed_end(slot->indexed))
+        {
+            return false;
+        }
+        *key = NULL;
+        *value = indexed_get(slot->indexed, (*position)++);
+        return true;
+    }
+    *key = NULL;
+    *value = slot->value;
+    return (*position)++ == 0 && slot->value != NULL;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de convertir una variable en arreglo (`kind': VAR_INDEXED o VAR_ASSOC)
+  -- un valor escalar pasa a ser el elemento 0; un arreglo no cambia de tipo --
+------------------------------------------------------------------------------------------------
+*/
+static bool make_array(struct var_slot *slot, unsigned int kind)
+{
+    if (slot->flags & kind)
+    {
+        return true;
+    }
+    if (slot->flags & (VAR_INDEXED | VAR_ASSOC))
+    {
+        return false;
+    }
+    char *value = slot->value;
+    slot->value = NULL;
+    if (kind == VAR_INDEXED)
+    {
+        slot->indexed = indexed_new();
+        if (value != NULL)
+        {
+            indexed_set(slot->indexed, 0, value);
+        }
+    }
+    else
+    {
+        slot->assoc = assoc_new();
+        if (value != NULL)
+        {
+            assoc_set(slot->assoc, "0", value);
+        }
+    }
+    g_free(value);
+    slot->flags |= kind;
+    value_changed(slot);
+    return true;
+}
+
+const char *vars_get(const char *name)
+{
+    assert(name != NULL);
+    struct var_slot *slot = lookup(name, strlen(name), false);
+    return (slot != NULL) ? scalar_value(slot) : NULL;
+}
+
+bool vars_set(const char *name, const char *value)
+{
+    assert(name != NULL && value != NULL);
+    return vars_set_element(name, NULL, value);
+}
+
+bool vars_set_element(const char *name, const char *subscript, const char *value)
+{
+    assert(name != NULL && value != NULL);
+    size_t length = strlen(name);
+    if (!vars_valid_name(name, length))
+    {
+        return false;
+    }
+    struct var_slot *slot = lookup(name, length, true);
+    if (subscript != NULL)
+    {
+        make_array(slot, VAR_INDEXED); // no hace nada si ya era un arreglo
+    }
+    else if (slot->flags & (VAR_INDEXED | VAR_ASSOC))
+    {
+        subscript = "0";
+    }
+    size_t index = 0;
+    if (slot->flags & VAR_ASSOC)
+    {
+        assoc_set(slot->assoc, subscript, value);
+    }
+    else if (slot->flags & VAR_INDEXED)
+    {
+        if (!parse_index(slot->indexed, subscript, &index))
+        {
+            return false;
+        }
+        indexed_set(slot->indexed, index, value);
+    }
+    else
+    {
+        g_free(slot->value);
+        slot->value = g_strdup(value);
+        value_changed(slot);
+    }
+    return true;
+}
+
+bool vars_declare(const char *name, unsigned int kind)
+{
+    assert(name != NULL && (kind == VAR_INDEXED || kind == VAR_ASSOC));
+    size_t length = strlen(name);
+    return vars_valid_name(name, length) && make_array(lookup(name, length, true), kind);
+}
+
+void vars_adopt(const char *name, char *block, char *const *lines, size_t count)
+{
+    assert(name != NULL && block != NULL && lines != NULL);
+    struct var_slot *slot = lookup(name, strlen(name), true);
+    if (!make_array(slot, VAR_INDEXED))
+    {
+        // era asociativo: se reemplaza por uno indexado
+        clear_value(slot);
+        make_array(slot, VAR_INDEXED);
+    }
+    indexed_adopt(slot->indexed, block, lines, count);
+}
+
+bool vars_export(const char *name, bool exported)
+{
+    assert(name != NULL);
+    size_t length = strlen(name);
+    if (!vars_valid_name(name, length))
+    {
+        return false;
+    }
+    struct var_slot *slot = lookup(name, length, exported);
+    if (slot == NULL)
+    {
+        return true; // no estaba declarada: no hay nada que desmarcar
+    }
+    if (exported)
+    {
+        slot->flags |= VAR_EXPORTED;
+        value_changed(slot);
+    }
+    else if (slot->flags & VAR_EXPORTED)
+    {
+        slot->flags &= ~VAR_EXPORTED;
+        unsetenv(slot->name);
+        exported_generation++;
+    }
+    return true;
+}
+
+unsigned int vars_flags(const char *name)
+{
+    assert(name != NULL);
+    struct var_slot *slot = lookup(name, strlen(name), false);
+    return (slot != NULL) ? slot->flags : VAR_LOCAL;
+}
+
+void vars_unset(const char *name)
+{
+    assert(name != NULL);
+    struct var_slot *slot = lookup(name, strlen(name), false);
+    if (slot != NULL)
+    {
+        clear_value(slot);
+        value_changed(slot);
+        slot->flags = VAR_LOCAL;
+        slot->declared = false;
+    }
+}
+
+void vars_unset_element(const char *name, const char *subscript)
+{
+    assert(name != NULL && subscript != NULL);
+    struct var_slot *slot = lookup(name, strlen(name), false);
+    size_t index = 0;
+    if (slot == NULL)
+    {
+        return;
+    }
+    if (slot->flags & VAR_ASSOC)
+    {
+        assoc_unset(slot->assoc, subscript);
+    }
+    else if (slot->flags & VAR_INDEXED)
+    {
+        if (parse_index(slot->indexed, subscript, &index))
+        {
+            indexed_unset(slot->indexed, index);
+        }
+    }
+    else if (strcmp(subscript, "0") == 0)
+    {
+        vars_unset(name);
+    }
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de agregar un valor entre comillas simples si hace falta
+  -- solo quedan sin comillas los valores hechos de letras, dígitos y ./:,+@%=_- --
+------------------------------------------------------------------------------------------------
+*/
+static void append_quoted(GString *out, const char *value)
+{
+    if (value[0] != '\0' &&
+        value[strspn(value, "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789./:,+@%=_-")] == '\0')
+    {
+        g_string_append(out, value);
+        return;
+    }
+    g_string_append_c(out, '\'');
+    for (const char *c = value; *c != '\0'; c++)
+    {
+        if (*c == '\'')
+        {
+            g_string_append(out, "'\\''");
+        }
+        else
+        {
+            g_string_append_c(out, *c);
+        }
+    }
+    g_string_append_c(out, '\'');
+}
+
+char *vars_format(const char *name)
+{
+    assert(name != NULL);
+    struct var_slot *slot = lookup(name, strlen(name), false);
+    if (slot == NULL || !(slot->value != NULL || (slot->flags & (VAR_INDEXED | VAR_ASSOC))))
+    {
+        return NULL;
+    }
+    GString *out = g_string_new(NULL);
+    if (slot->value != NULL)
+    {
+        append_quoted(out, slot->value);
+        return g_string_free(out, FALSE);
+    }
+    g_string_append_c(out, '(');
+    size_t position = 0;
+    const char *key, *value;
+    while (next_value(slot, &position, &key, &value))
+    {
+        if (out->len > 1)
+        {
+            g_string_append_c(out, ' ');
+        }
+        if (key != NULL)
+        {
+            g_string_append_c(out, '[');
+            append_quoted(out, key);
+            g_string_append(out, "]=");
+        }
+        else
+        {
+            g_string_append_printf(out, "[%zu]=", position - 1);
+        }
+        append_quoted(out, value);
+    }
+    g_string_append_c(out, ')');
+    return g_string_free(out, FALSE);
+}
+
+static int compare_names(const void *a, const void *b)
+{
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+const char **vars_names(unsigned int flags)
+{
+    ensure_table();
+    const char **result = g_new0(const char *, capacity + 1);
+    size_t count = 0;
+    for (size_t i = 0; i < capacity; i++)
+    {
+        if (slots[i].name != NULL && slots[i].declared && (slots[i].flags & flags) == flags)
+        {
+            result[count++] = slots[i].name;
+        }
+    }
+    qsort(result, count, sizeof(const char *), compare_names);
+    return result;
+}
+
+char **vars_environment(void)
+{
+    ensure_table();
+    if (envp != NULL && envp_generation == exported_generation)
+    {
+        return envp;
+    }
+    // un solo bloque: primero el arreglo de punteros y después las cadenas "NOMBRE=valor"
+    size_t count = 0, bytes = 0;
+    for (size_t i = 0; i < capacity; i++)
+    {
+        if (slots[i].declared && (slots[i].flags & VAR_EXPORTED) && slots[i].value != NULL)
+        {
+            count++;
+            bytes += strlen(slots[i].name) + strlen(slots[i].value) + 2;
+        }
+    }
+    free(envp);
+    envp = malloc((count + 1) * sizeof(char *) + bytes);
+    assert(envp != NULL);
+    char *text = (char *)(envp + count + 1);
+    count = 0;
+    for (size_t i = 0; i < capacity; i++)
+    {
+        if (slots[i].declared && (slots[i].flags & VAR_EXPORTED) && slots[i].value != NULL)
+        {
+            envp[count++] = text;
+            text = stpcpy(stpcpy(stpcpy(text, slots[i].name), "="), slots[i].value) + 1;
+        }
+    }
+    envp[count] = NULL;
+    envp_generation = exported_generation;
+    return envp;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de medir el nombre de variable que empieza en `text'
+------------------------------------------------------------------------------------------------
+*/
+static size_t name_length(const char *text)
+{
+    size_t length = 0;
+    if (g_ascii_isalpha(text[0]) || text[0] == '_')
+    {
+        for (length = 1; g_ascii_isalnum(text[length]) || text[length] == '_'; length++)
+            ;
+    }
+    return length;
+}
+
+// Una referencia a una variable dentro de una palabra: $NOMBRE, ${NOMBRE}, ${NOMBRE[i]} o ${#...}
+struct reference
+{
+    const char *name;
+    size_t length;
+    char *subscript;         // NULL si no tiene; apunta dentro de la palabra
+    size_t subscript_length;
+    bool count;              // ${#...}: largo del valor, o cantidad de elementos con [@]
+};
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de reconocer la referencia que empieza en el '$' de `p'
+  -- devuelve dónde termina, o NULL si el '$' no empieza una referencia --
+------------------------------------------------------------------------------------------------
+*/
+static char *parse_reference(char *p, struct reference *ref)
+{
+    ref->subscript = NULL;
+    ref->subscript_length = 0;
+    ref->count = false;
+    if (p[1] != '{')
+    {
+        ref->name = p + 1;
+        ref->length = name_length(ref->name);
+        return (ref->length > 0) ? p + 1 + ref->length : NULL;
+    }
+    char *q = p + 2;
+    if (*q == '#' && name_length(q + 1) > 0)
+    {
+        ref->count = true;
+        q++;
+    }
+    ref->name = q;
+    ref->length = name_length(q);
+    if (ref->length == 0)
+    {
+        return NULL;
+    }
+    q += ref->length;
+    if (*q == '[')
+    {
+        char *close = strchr(q + 1, ']');
+        if (close == NULL)
+        {
+            return NULL;
+        }
+        ref->subscript = q + 1;
+        ref->subscript_length = close - ref->subscript;
+        q = close + 1;
+    }
+    return (*q == '}') ? q + 1 : NULL;
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de agregar texto a la salida de una expansión
+  -- escapa con '\' los caracteres de `escaped'; con NULL se agrega tal cual --
+------------------------------------------------------------------------------------------------
+*/
+static void append_escaped(GString *out, const char *text, size_t length, const char *escaped)
+{
+    if (escaped == NULL)
+    {
+        g_string_append_len(out, text, length);
+        return;
+    }
+    for (size_t i = 0; i < length; i++)
+    {
+        if (strchr(escaped, text[i]) != NULL)
+        {
+            g_string_append_c(out, '\\');
+        }
+        g_string_append_c(out, text[i]);
+    }
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de terminar una palabra de la expansión
+  -- una palabra vacía se descarta, salvo que `keep_empty' (estaba entre comillas) --
+------------------------------------------------------------------------------------------------
+*/
+static void push_word(GString *out, GPtrArray *words, bool keep_empty)
+{
+    if (out->len > 0 || keep_empty)
+    {
+        g_ptr_array_add(words, g_string_free(out, FALSE));
+    }
+    else
+    {
+        g_string_free(out, TRUE);
+    }
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de agregar a la salida el valor de una referencia
+  -- con [@] cada elemento termina una palabra y empieza otra, así que la salida puede
+      cambiar; devuelve false si fue un [@] sin elementos (la palabra puede desaparecer) --
+------------------------------------------------------------------------------------------------
+*/
+static bool expand_reference(struct reference *ref, GString **out, GPtrArray *words, const char *escaped)
+{
+    struct var_slot *slot = lookup(ref->name, ref->length, false);
+    // el subíndice se termina en su lugar (sobre el ']') para no copiarlo
+    char saved = '\0';
+    const char *subscript = ref->subscript;
+    if (ref->subscript != NULL)
+    {
+        saved = ref->subscript[ref->subscript_length];
+        ref->subscript[ref->subscript_length] = '\0';
+        // ${a[$i]}: el subíndice es el valor de otra variable
+        size_t length = name_length(subscript + 1);
+        if (subscript[0] == '$' && length > 0 && length == ref->subscript_length - 1)
+        {
+            struct var_slot *index = lookup(subscript + 1, length, false);
+            subscript = (index != NULL && scalar_value(index) != NULL) ? scalar_value(index) : "";
+        }
+    }
+    bool all = (subscript != NULL && (strcmp(subscript, "@") == 0 || strcmp(subscript, "*") == 0));
+    bool found = true;
+    if (slot == NULL)
+    {
+        if (ref->count)
+        {
+            g_string_append_c(*out, '0');
+        }
+        found = !all;
+    }
+    else if (ref->count && all)
+    {
+        size_t count = (slot->flags & VAR_ASSOC)     ? assoc_count(slot->assoc)
+                       : (slot->flags & VAR_INDEXED) ? indexed_count(slot->indexed)
+                                                     : (slot->value != NULL);
+        g_string_append_printf(*out, "%zu", count);
+    }
+    else if (all)
+    {
+        size_t position = 0;
+        const char *key, *value;
+        found = false;
+        while (next_value(slot, &position, &key, &value))
+        {
+            if (found && subscript[0] == '@')
+            {
+                push_word(*out, words, true);
+                *out = g_string_new(NULL);
+            }
+            else if (found)
+            {
+                g_string_append_c(*out, ' ');
+            }
+            append_escaped(*out, value, strlen(value), escaped);
+            found = true;
+        }
+    }
+    else
+    {
+        const char *value = (subscript != NULL) ? element(slot, subscript) : scalar_value(slot);
+        if (ref->count)
+        {
+            g_string_append_printf(*out, "%zu", (value != NULL) ? strlen(value) : 0);
+        }
+        else if (value != NULL)
+        {
+            append_escaped(*out, value, strlen(value), escaped);
+        }
+    }
+    if (ref->subscript != NULL)
+    {
+        ref->subscript[ref->subscript_length] = saved;
+    }
+    return found;
+}
+
+void vars_set_status(int status)
+{
+    snprintf(status_text, sizeof(status_text), "%d", status);
+}
+
+/*
+------------------------------------------------------------------------------------------------
+  *    Función encargada de expandir una palabra en una sola pasada
+  -- sigue las comillas: entre '...' no se expande nada, y las comillas se sacan donde
+     estén. Con `pattern' la salida es un patrón para pathname_expand(): lo que estaba entre
+     comillas y las comillas y '\' de los valores se escapan con '\' --
+------------------------------------------------------------------------------------------------
+*/
+static void expand(char *word, GPtrArray *words, bool pattern)
+{
+    GString *out = g_string_new(NULL);
+    char quote = '\0';    // comilla abierta ('\0': ninguna)
+    bool quoted = false;   // hubo comillas: la palabra no se descarta aunque quede vacía
+    bool vanished = false; // hubo un [@] sin elementos
+    char *copied = word;   // hasta dónde ya se pasó la palabra a la salida
+    const char *literal = (pattern) ? PATTERN_QUOTED : NULL; // qué escapar del texto entre comillas
+    for (char *p = word; *p != '\0';)
+    {
+        const char *escaped = (quote != '\0') ? literal : NULL;
+        if ((quote == '\0' && (*p == '\'' || *p == '"')) || (quote != '\0' && *p == quote))
+        {
+            append_escaped(out, copied, p - copied, escaped);
+            quote = (quote == '\0') ? *p : '\0';
+            quoted = true;
+            copied = ++p;
+            continue;
+        }
+        if (*p == '\\' && p[1] != '\0' && quote == '\0')
+        {
+            p += 2; // fuera de comillas la '\' queda, y lo que sigue no es especial
+            continue;
+        }
+        if (*p == '\\' && p[1] != '\0' && quote == '"' && strchr("$`\"\\", p[1]) != NULL)
+        {
+            append_escaped(out, copied, p - copied, escaped); // entre comillas dobles la '\' se saca
+            copied = p + 1;
+            p += 2;
+            continue;
+        }
+        if (*p != '$' || quote == '\'')
+        {
+            p++;
+            continue;
+        }
+        // los valores entre comillas son literales; fuera de ellas sus comodines cuentan
+        const char *value_escaped = (!pattern) ? NULL : (quote != '\0') ? PATTERN_QUOTED : PATTERN_VALUE;
+        if (p[1] == '?')
+        {
+            append_escaped(out, copied, p - copied, escaped);
+            g_string_append(out, status_text);
+            p += 2;
+            copied = p;
+            continue;
+        }
+        struct reference ref;
+        char *end = parse_reference(p, &ref);
+        if (end == NULL)
+        {
+            p++; // no empieza una referencia: el '$' queda como está
+            continue;
+        }
+        append_escaped(out, copied, p - copied, escaped);
+        vanished |= !expand_reference(&ref, &out, words, value_escaped);
+        p = end;
+        copied = end;
+    }
+    append_escaped(out, copied, strlen(copied), (quote != '\0') ? literal : NULL);
+    push_word(out, words, quoted && !vanished);
+    free(word);
+}
+
+void vars_expand(char *word, GPtrArray *words)
+{
+    assert(word != NULL && words != NULL);
+    if (strpbrk(word, "$'\"") == NULL)
+    {
+        g_ptr_array_add(words, word); // caso común: nada que expandir, ni una copia
+        return;
+    }
+    expand(word, words, false);
+}
+
+void vars_expand_pattern(char *word, GPtrArray *words)
+{
+    assert(word != NULL && words != NULL);
+    expand(word, words, true);
+}
+
+void vars_destroy(void)
+{
+    for (size_t i = 0; i < capacity; i++)
+    {
+        clear_value(&slots[i]);
+    }
+    g_free(slots);
+    slots = NULL;
+    free(envp);
+    envp = NULL;
+    capacity = used = 0;
+    if (names != NULL)
+    {
+        g_string_chunk_free(names);
+        names = NULL;
+    }
+}
@@ -0,0 +1,164 @@
+/* Variables del shell.
+ * Se guardan en una tabla hash de direccionamiento abierto. Cada nombre se
+ * copia una sola vez a un bloque de nombres y la tabla guarda ese puntero.
+ * Al empezar se cargan las variables del entorno, marcadas como exportadas.
+ * Las demás son locales: no llegan a los comandos que se ejecutan.
+ * Una variable puede ser un arreglo indexado o asociativo (array.h).
+ */
+
+#ifndef VARS_H
+#define VARS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <glib.h>
+
+#define VAR_LOCAL 0u           // solo la ve el shell
+#define VAR_EXPORTED (1u << 0) // también la ven los procesos hijos
+#define VAR_INDEXED (1u << 1)  // arreglo indexado
+#define VAR_ASSOC (1u << 2)    // arreglo asociativo
+
+bool vars_valid_name(const char *name, size_t length);
+/*
+ * Indica si los primeros `length' caracteres de `name' forman un nombre de
+ * variable: una letra o '_' seguida de letras, dígitos o '_'.
+ * Requires: name != NULL
+ */
+
+const char *vars_get(const char *name);
+/*
+ * Devuelve el valor de la variable `name' (de un arreglo, el elemento 0).
+ *   Returns: cadena propiedad del módulo (vale hasta el próximo cambio de la
+ *     variable), o NULL si no está definida.
+ * Requires: name != NULL
+ */
+
+bool vars_set(const char *name, const char *value);
+/*
+ * Le da el valor `value' (se copia) a la variable `name' (a un arreglo, en
+ * el elemento 0). Si no existía se crea como local; si existía conserva sus
+ * banderas.
+ *   Returns: false si `name' no es un nombre válido.
+ * Requires: name != NULL && value != NULL
+ */
+
+bool vars_set_element(const char *name, const char *subscript, const char *value);
+/*
+ * Le da el valor `value' (se copia) al elemento `subscript' del arreglo
+ * `name'. Si `name' no era un arreglo pasa a ser uno indexado (su valor
+ * queda como elemento 0). En uno indexado, `subscript' es un número; si es
+ * negativo cuenta desde el final. Con subscript == NULL es vars_set().
+ *   Returns: false si `name' no es un nombre válido o el índice no sirve.
+ * Requires: name != NULL && value != NULL
+ */
+
+bool vars_declare(const char *name, unsigned int kind);
+/*
+ * Convierte a `name' en un arreglo de tipo `kind' (VAR_INDEXED o
+ * VAR_ASSOC), vacío si no existía. Un arreglo no cambia de tipo.
+ *   Returns: false si `name' no es un nombre válido o ya era un arreglo del
+ *     otro tipo.
+ * Requires: name != NULL
+ */
+
+void vars_adopt(const char *name, char *block, char *const *lines, size_t count);
+/*
+ * Agrega al final del arreglo indexado `name' (se crea si hace falta) las
+ * `count' cadenas de `lines', que apuntan dentro de `block'. El arreglo se
+ * queda con `block' (memoria de malloc): no se copia ninguna cadena.
+ * Requires: name es un nombre válido && block != NULL && lines != NULL
+ */
+
+bool vars_export(const char *name, bool exported);
+/*
+ * Marca (o desmarca) a `name' como exportada. Si no existía, queda
+ * declarada sin valor, y se exporta cuando se le asigne uno.
+ *   Returns: false si `name' no es un nombre válido.
+ * Requires: name != NULL
+ */
+
+unsigned int vars_flags(const char *name);
+/*
+ * Devuelve las banderas (VAR_LOCAL, VAR_EXPORTED) de `name', que valen
+ * VAR_LOCAL si no está declarada.
+ * Requires: name != NULL
+ */
+
+void vars_unset(const char *name);
+/*
+ * Borra la variable `name' (y la saca del entorno si estaba exportada).
+ * Requires: name != NULL
+ */
+
+void vars_unset_element(const char *name, const char *subscript);
+/*
+ * Borra el elemento `subscript' del arreglo `name'.
+ * Requires: name != NULL && subscript != NULL
+ */
+
+char *vars_format(const char *name);
+/*
+ * Devuelve el valor de `name' como se puede volver a ingresar: entre
+ * comillas simples si hace falta, y un arreglo como ([0]='a' [1]='b').
+ *   Returns: cadena a liberar con g_free(), o NULL si no tiene valor.
+ * Requires: name != NULL
+ */
+
+const char **vars_names(unsigned int flags);
+/*
+ * Devuelve los nombres declarados que tienen todas las banderas `flags',
+ * ordenados, en un arreglo terminado en NULL.
+ *   Returns: arreglo a liberar con g_free(); los nombres son del módulo.
+ */
+
+char **vars_environment(void);
+/*
+ * Devuelve el entorno de los comandos: "NOMBRE=valor" por cada variable
+ * exportada que tiene valor, terminado en NULL (para asignarlo a environ en
+ * el hijo, antes de exec). El arreglo se guarda y solo se arma de nuevo
+ * cuando cambió alguna variable exportada, así todas las etapas de un
+ * pipeline, y los pipelines siguientes, usan el mismo.
+ *   Returns: arreglo propiedad del módulo; vale hasta el próximo cambio de
+ *     una variable exportada.
+ */
+
+void vars_set_status(int status);
+/*
+ * Guarda el estado de salida del último pipeline, para $?.
+ */
+
+void vars_expand(char *word, GPtrArray *words);
+/*
+ * Reemplaza en `word' cada $NOMBRE, ${NOMBRE} y ${NOMBRE[i]} por su valor
+ * (las que no están definidas se reemplazan por nada) y agrega a `words'
+ * las palabras que resultan. ${#NOMBRE} es el largo del valor y
+ * ${#NOMBRE[@]} la cantidad de elementos. ${NOMBRE[@]} da una palabra por
+ * elemento, y ${NOMBRE[*]} los junta separados por espacios. $? es el
+ * estado de salida del último pipeline (vars_set_status). Un '$' que no
+ * empieza una referencia queda como está.
+ * Entre comillas simples no se expande nada; entre comillas dobles sí, y la
+ * '\' escapa $ ` " y '\'. Las comillas se sacan donde estén ("a"$X'b'); fuera
+ * de ellas la '\' queda, y el carácter que la sigue no es especial.
+ * Una palabra que queda vacía se descarta (como en bash), salvo que tuviera
+ * comillas.
+ *   word: palabra en memoria dinámica; pasa a ser del módulo. Si no había
+ *     nada que expandir ni comillas, se agrega tal cual a `words'.
+ *   words: las palabras agregadas quedan a cargo del llamador (free()).
+ * Requires: word != NULL && words != NULL
+ */
+
+void vars_expand_pattern(char *word, GPtrArray *words);
+/*
+ * Como vars_expand(), pero cada palabra que agrega es un patrón para
+ * pathname_expand(): los comodines que estaban entre comillas, o en un valor
+ * entre comillas, quedan escapados con '\', igual que las comillas y las '\'
+ * de los valores. Los comodines de un valor sin comillas cuentan.
+ * Requires: word != NULL && words != NULL
+ */
+
+void vars_destroy(void);
+/*
+ * Libera la tabla de variables (el entorno del proceso no cambia).
+ */
+
+#endif /* VARS_H */